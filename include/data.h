@@ -1,6 +1,7 @@
 #ifndef DATA_H_
 #define DATA_H_
 
+#include <cstddef>
 #include <cstdint>
 
 /*
@@ -199,6 +200,7 @@ enum class StatisticFeature : uint8_t {
     SBYTES,             ///< Total bytes from source
     DBYTES              ///< Total bytes from destination
 };
+const std::size_t STATISTIC_FEATURE_COUNT = 8; ///< Number of StatisticFeature values
 /*
 *
 * Criado por IA, junção de chatgpt com gemini 2.5
@@ -0,0 +1,179 @@
+#ifndef DATA_FIELDS_H_
+#define DATA_FIELDS_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include "data.h"
+
+// Storage type of a numeric Data field
+enum class FieldType : uint8_t {
+    FLOAT = 0,
+    UINT8,
+    UINT16,
+    UINT32
+};
+
+// Describes one numeric member of the packed Data struct, so that queries can address fields by name.
+struct NumericField {
+    const char* name;
+    size_t offset;
+    FieldType type;
+};
+
+#define DATA_NUMERIC_FIELD(member, type) NumericField{#member, offsetof(Data, member), FieldType::type}
+
+inline constexpr NumericField NUMERIC_FIELDS[] = {
+    DATA_NUMERIC_FIELD(id, UINT32),
+    DATA_NUMERIC_FIELD(dur, FLOAT),
+    DATA_NUMERIC_FIELD(rate, FLOAT),
+    DATA_NUMERIC_FIELD(sload, FLOAT),
+    DATA_NUMERIC_FIELD(dload, FLOAT),
+    DATA_NUMERIC_FIELD(sinpkt, FLOAT),
+    DATA_NUMERIC_FIELD(dinpkt, FLOAT),
+    DATA_NUMERIC_FIELD(sjit, FLOAT),
+    DATA_NUMERIC_FIELD(djit, FLOAT),
+    DATA_NUMERIC_FIELD(tcprtt, FLOAT),
+    DATA_NUMERIC_FIELD(synack, FLOAT),
+    DATA_NUMERIC_FIELD(ackdat, FLOAT),
+    DATA_NUMERIC_FIELD(spkts, UINT16),
+    DATA_NUMERIC_FIELD(dpkts, UINT16),
+    DATA_NUMERIC_FIELD(sbytes, UINT32),
+    DATA_NUMERIC_FIELD(dbytes, UINT32),
+    DATA_NUMERIC_FIELD(sttl, UINT8),
+    DATA_NUMERIC_FIELD(dttl, UINT8),
+    DATA_NUMERIC_FIELD(sloss, UINT16),
+    DATA_NUMERIC_FIELD(dloss, UINT16),
+    DATA_NUMERIC_FIELD(swin, UINT16),
+    DATA_NUMERIC_FIELD(stcpb, UINT32),
+    DATA_NUMERIC_FIELD(dtcpb, UINT32),
+    DATA_NUMERIC_FIELD(dwin, UINT16),
+    DATA_NUMERIC_FIELD(smean, UINT16),
+    DATA_NUMERIC_FIELD(dmean, UINT16),
+    DATA_NUMERIC_FIELD(trans_depth, UINT16),
+    DATA_NUMERIC_FIELD(response_body_len, UINT32),
+    DATA_NUMERIC_FIELD(ct_srv_src, UINT16),
+    DATA_NUMERIC_FIELD(ct_dst_ltm, UINT16),
+    DATA_NUMERIC_FIELD(ct_src_dport_ltm, UINT16),
+    DATA_NUMERIC_FIELD(ct_dst_sport_ltm, UINT16),
+    DATA_NUMERIC_FIELD(ct_dst_src_ltm, UINT16),
+    DATA_NUMERIC_FIELD(ct_ftp_cmd, UINT16),
+    DATA_NUMERIC_FIELD(ct_flw_http_mthd, UINT16),
+    DATA_NUMERIC_FIELD(ct_src_ltm, UINT16),
+    DATA_NUMERIC_FIELD(ct_srv_dst, UINT16),
+};
+
+#undef DATA_NUMERIC_FIELD
+
+inline constexpr size_t NUMERIC_FIELD_COUNT = sizeof(NUMERIC_FIELDS) / sizeof(NUMERIC_FIELDS[0]);
+
+// Returns the descriptor of the numeric field called 'name', or nullptr.
+inline const NumericField* find_numeric_field(const std::string& name) {
+    for (const NumericField& field : NUMERIC_FIELDS)
+        if (name == field.name) return &field;
+    return nullptr;
+}
+
+// Reads a field of a packed record. memcpy keeps the unaligned access well defined.
+template <typename T>
+inline T read_field(const Data* d, size_t offset) {
+    T value;
+    std::memcpy(&value, reinterpret_cast<const unsigned char*>(d) + offset, sizeof(T));
+    return value;
+}
+
+// Calls visit(T{}) with T the storage type of 'type', so that a generic lambda is instantiated
+// once per type and the caller's loop runs with the field type resolved.
+template <typename Visitor>
+inline decltype(auto) visit_field_type(FieldType type, Visitor&& visit) {
+    switch (type) {
+        case FieldType::FLOAT: return visit(float{});
+        case FieldType::UINT8: return visit(uint8_t{});
+        case FieldType::UINT16: return visit(uint16_t{});
+        default: return visit(uint32_t{});
+    }
+}
+
+inline double read_numeric_field(const Data* d, const NumericField& field) {
+    return visit_field_type(field.type, [&](auto tag) -> double {
+        return read_field<decltype(tag)>(d, field.offset);
+    });
+}
+
+// out[i] = the field of rows[i], as a float. The type is resolved once for the whole column.
+inline void gather_field(const Data* const* rows, size_t n, const NumericField& field, float* out) {
+    visit_field_type(field.type, [&](auto tag) {
+        using T = decltype(tag);
+        const size_t offset = field.offset;
+        for (size_t i = 0; i < n; ++i) out[i] = static_cast<float>(read_field<T>(rows[i], offset));
+    });
+}
+
+constexpr bool field_name_equals(const char* a, const char* b) {
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+// Position of the field called 'name' in NUMERIC_FIELDS, or NUMERIC_FIELD_COUNT. Usable at compile time.
+constexpr size_t numeric_field_index(const char* name) {
+    for (size_t i = 0; i < NUMERIC_FIELD_COUNT; ++i)
+        if (field_name_equals(NUMERIC_FIELDS[i].name, name)) return i;
+    return NUMERIC_FIELD_COUNT;
+}
+
+// NUMERIC_FIELDS entry of every StatisticFeature, in enum order
+inline constexpr size_t STATISTIC_FEATURE_FIELDS[STATISTIC_FEATURE_COUNT] = {
+    numeric_field_index("dur"), numeric_field_index("rate"), numeric_field_index("sload"), numeric_field_index("dload"),
+    numeric_field_index("spkts"), numeric_field_index("dpkts"), numeric_field_index("sbytes"), numeric_field_index("dbytes"),
+};
+
+static_assert(NUMERIC_FIELDS[STATISTIC_FEATURE_FIELDS[0]].offset == offsetof(Data, dur), "StatisticFeature::DUR");
+static_assert(NUMERIC_FIELDS[STATISTIC_FEATURE_FIELDS[7]].offset == offsetof(Data, dbytes), "StatisticFeature::DBYTES");
+static_assert(STATISTIC_FEATURE_FIELDS[4] < NUMERIC_FIELD_COUNT && STATISTIC_FEATURE_FIELDS[6] < NUMERIC_FIELD_COUNT,
+              "every StatisticFeature names a numeric field");
+
+constexpr const NumericField& statistic_feature_field(StatisticFeature feature) {
+    return NUMERIC_FIELDS[STATISTIC_FEATURE_FIELDS[static_cast<size_t>(feature)]];
+}
+
+// Storage type of a FieldType known at compile time, as visit_field_type() resolves it at run time
+template <FieldType> struct field_storage { using type = uint32_t; };
+template <> struct field_storage<FieldType::FLOAT> { using type = float; };
+template <> struct field_storage<FieldType::UINT8> { using type = uint8_t; };
+template <> struct field_storage<FieldType::UINT16> { using type = uint16_t; };
+
+// Every StatisticFeature of one record, indexed by StatisticFeature
+using StatisticFeatureValues = std::array<float, STATISTIC_FEATURE_COUNT>;
+
+template <size_t... F>
+inline StatisticFeatureValues read_statistic_features(const Data* d, std::index_sequence<F...>) {
+    return {{static_cast<float>(read_field<typename field_storage<NUMERIC_FIELDS[STATISTIC_FEATURE_FIELDS[F]].type>::type>(
+        d, NUMERIC_FIELDS[STATISTIC_FEATURE_FIELDS[F]].offset))...}};
+}
+
+// The StatisticFeatures of 'd' as floats (all 0 for a null record). Offsets and types come from
+// STATISTIC_FEATURE_FIELDS at compile time, so the per-record loops of the structures read each
+// member directly instead of switching on its type for every value.
+inline StatisticFeatureValues statistic_feature_values(const Data* d) {
+    if (!d) return StatisticFeatureValues{};
+    return read_statistic_features(d, std::make_index_sequence<STATISTIC_FEATURE_COUNT>{});
+}
+
+// The StatisticFeature that names 'field', if there is one
+inline bool statistic_feature_of(const NumericField& field, StatisticFeature& feature) {
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        if (NUMERIC_FIELDS[STATISTIC_FEATURE_FIELDS[f]].offset == field.offset) {
+            feature = static_cast<StatisticFeature>(f);
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // DATA_FIELDS_H_
@@ -38,6 +38,10 @@ public:
 
     Node_AVL* queryById(uint32_t id);
 
+    // Batched queryById: out[i] receives the Data* of ids[i] or nullptr. A group of lookups
+    // descends the tree in lockstep, prefetching the next node and its record for all of them.
+    void findMany(const uint32_t* ids, size_t count, const Data** out) const;
+
     void removeById(uint32_t id);
     size_t getMemoryUsage() const;
 private:
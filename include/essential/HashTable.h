@@ -37,6 +37,10 @@ public:
     // Busca Data* pelo ID, retorna nullptr se não encontrar
     const Data* find(uint32_t id) const;
 
+    // Busca vários IDs de uma vez: out[i] recebe o Data* de ids[i] ou nullptr.
+    // Os buckets, nodes e registros de cada grupo são pré-carregados (prefetch) antes de serem lidos.
+    void findMany(const uint32_t* ids, size_t count, const Data** out) const;
+
     // Limpa toda a tabela (remove apenas os ponteiros e Nodes, não Data* em si)
     void clear();
 
@@ -0,0 +1,63 @@
+// Fixed-bucket histograms of feature values, for distribution views that should not ship records.
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class HistogramScale : uint8_t { LOG = 0, LINEAR };
+
+// One bin of a reply: count of the values in [low, high); the last bin also holds 'high' itself.
+struct HistogramBin {
+    double low;
+    double high;
+    uint64_t count;
+};
+
+// Counts of values in fixed log-linear buckets: every power of two in [2^MIN_EXPONENT, 2^MAX_EXPONENT)
+// is split into SUB_BUCKETS equal buckets, so a value is known to within 1/SUB_BUCKETS of itself.
+// Bucket 0 holds everything below 2^MIN_EXPONENT (zero, negatives, NaN) and the last bucket
+// everything from 2^MAX_EXPONENT up. Values can be removed as well as added, so the histogram
+// follows a window as records are inserted and evicted.
+class LogHistogram {
+public:
+    static constexpr int MIN_EXPONENT = -16;
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - MIN_EXPONENT) * SUB_BUCKETS + 2;
+
+    void add(float value) { ++counts[bucketOf(value)]; ++total; }
+    // 'value' must have been added before
+    void remove(float value) { --counts[bucketOf(value)]; --total; }
+    void clear();
+
+    uint64_t count() const { return total; }
+    uint64_t bucketCount(size_t bucket) const { return counts[bucket]; }
+
+    // At most 'bins' bins covering the occupied buckets, each made of the same number of
+    // consecutive buckets (so of about the same log width). Empty if nothing was added.
+    std::vector<HistogramBin> bins(size_t bins) const;
+
+    static size_t bucketOf(float value);
+    static double bucketLow(size_t bucket);  // 0 for bucket 0
+    static double bucketHigh(size_t bucket); // Infinity for the last bucket
+
+    size_t getMemoryUsage() const { return sizeof(*this); }
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> counts{};
+    uint64_t total = 0;
+};
+
+// 'bins' equal-width bins over [min, max] of the values, counted with the histogram kernel.
+// One bin of width 0 when all the values are equal; empty when there are none.
+std::vector<HistogramBin> linear_histogram(const float* values, size_t n, size_t bins);
+
+// Same bins as LogHistogram::bins, for values that have no maintained histogram
+std::vector<HistogramBin> log_histogram(const float* values, size_t n, size_t bins);
+
+#endif // HISTOGRAM_H
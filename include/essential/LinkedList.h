@@ -4,6 +4,12 @@
 #define DOUBLYLINKEDLIST_H
 
 #include "data.h"
+#include "essential/SlidingWindow.h"
+#include "essential/QuantileSketch.h"
+#include "essential/OrderStatistics.h"
+#include "essential/Histogram.h"
+#include <deque>
+#include "stats_summary.h"
 #include <iostream>
 #include <vector>
 #include <cstdint> // For uint32_t
@@ -14,16 +20,60 @@ private:
         const Data* data; // Stores a pointer to the Data object
         Node* prev;
         Node* next;
+        uint64_t seq; // Increases from head to tail; orders the nodes for the sliding windows
         Node(const Data* d); // Constructor takes a const Data pointer
     };
 
+    // Running statistics of the last 'size' items, updated on append and removal
+    struct Window {
+        int size;
+        Node* start = nullptr;  // Oldest node inside the window
+        int length = 0;
+        uint64_t updates = 0;   // Removals since the sums were last recomputed
+        SlidingAggregate features[STATISTIC_FEATURE_COUNT];
+    };
+
+    // Sketches of the nodes whose seq falls in one QUANTILE_BUCKET_SIZE-long range
+    struct QuantileBucket {
+        Node* first = nullptr; // Oldest node still in the bucket; the 'live' nodes follow it
+        FeatureSketches sketches;
+        explicit QuantileBucket(uint16_t k) : sketches(k) {}
+    };
+
     Node* head;
     Node* tail;
     int count;
+    uint64_t next_seq;
+    std::vector<Window> windows;
+    uint16_t quantile_k = 0;                    // 0 until trackQuantiles()
+    std::deque<QuantileBucket> quantile_buckets;
+    uint64_t first_quantile_bucket = 0;         // seq / QUANTILE_BUCKET_SIZE of quantile_buckets.front()
+    std::vector<OrderStatisticList> order_statistics; // One per feature over every node, keyed by (value, seq); empty until trackOrderStatistics()
+    std::vector<LogHistogram> histograms;             // One per feature over every node; empty until trackHistograms()
+
+    // 'values' are the statistic_feature_values() of 'node', read once for every window
+    void windowAppend(Window& window, Node* node, const StatisticFeatureValues& values);
+    void windowRemove(Window& window, Node* node, const StatisticFeatureValues& values);
+    void rebuildWindow(Window& window);
+    void rebuildExtrema(Window& window);
+    // A tracked window holding exactly the last 'interval_count' items, or nullptr
+    Window* windowFor(int interval_count);
+    // Whether the order statistics hold exactly the last 'interval_count' items
+    bool orderStatisticsCover(int interval_count) const { return !order_statistics.empty() && interval_count >= count; }
+    // summarize() from a window's running aggregates; the median comes from the order statistics when
+    // they cover the interval, else it is selected from the interval's 'records' (collected on first use)
+    StatsSummary windowSummary(Window& window, StatisticFeature feature, int interval_count, std::vector<const Data*>& records);
+    // summarizeField() from the values of the interval
+    StatsSummary gatherSummary(const NumericField& field, int interval_count);
 
-    // Helper to get feature value from a Data object based on StatisticFeature enum
-    float getFeatureValue(const Data* data, StatisticFeature feature);
+    void quantileAppend(Node* node);
+    void quantileRemove(Node* node); // Called before 'node' is unlinked
+    void rebuildQuantiles();
+    void rebuildQuantileBucket(QuantileBucket& bucket);
+    void rebuildOrderStatistics();
 
+    // Records of the last interval_count nodes, most recent first
+    std::vector<const Data*> collectIntervalRecords(int interval_count) const;
     // DECLARATION ADDED: Helper to collect values for a given interval
     std::vector<float> collectIntervalValues(StatisticFeature feature, int interval_count);
 
@@ -35,6 +85,9 @@ public:
     void append(const Data* d); // Takes a const Data pointer
     void insertAt(int index, const Data* d); // Takes a const Data pointer
     const Data* findById(uint32_t id); // Returns const Data pointer
+    // Batched findById: out[i] receives the Data pointer for ids[i] or nullptr.
+    // Resolves all ids in a single pass over the list instead of one pass per id.
+    void findMany(const uint32_t* ids, size_t count, const Data** out);
     bool removeById(uint32_t id); // Removes node, does NOT delete Data
     int size() const;
 
@@ -43,13 +96,53 @@ public:
     // Accessor for the tail of the list (useful for backward iteration)
     const Node* getTail() const { return tail; }
 
+    // Keeps running aggregates for the last 'size' items, so that average, std dev, min and
+    // max over exactly that interval (or over any interval once the list is shorter) are O(1).
+    void trackWindow(int size);
+
+    // Keeps a quantile sketch per feature for every QUANTILE_BUCKET_SIZE appended items, sized
+    // for the given normalized rank error, so that getQuantiles() over long intervals merges
+    // sketches instead of sorting the values.
+    void trackQuantiles(double rank_error);
+
+    // Keeps every feature of every node in an order-statistic list, so that exact quantiles over
+    // the whole list (any interval_count >= size()) take O(log n) instead of a selection.
+    void trackOrderStatistics();
+
+    // Keeps a LogHistogram per feature over every node, updated on append and removal.
+    void trackHistograms();
+
+    // Distribution of a feature over the last interval_count items in at most 'bins' bins. LOG bins
+    // over the whole list come from the maintained histograms in O(buckets); anything else is
+    // counted from the values of the interval.
+    std::vector<HistogramBin> getHistogram(StatisticFeature feature, int interval_count, HistogramScale scale, size_t bins);
+    // Whether getHistogram() over that many items reads the maintained histograms
+    bool histogramMaintained(int interval_count, HistogramScale scale) const;
+
+    // Quantiles (each q in [0, 1]) of a feature over the last interval_count items. Exact when the
+    // order statistics cover the interval, when 'exact' is set, when no sketches are tracked or for
+    // at most QUANTILE_EXACT_LIMIT items; otherwise within the tracked rank error.
+    std::vector<float> getQuantiles(StatisticFeature feature, int interval_count, const std::vector<double>& qs, bool exact = false);
+    // Whether getQuantiles() over that many items is answered exactly
+    bool quantilesExact(int interval_count) const;
+
     // Generic statistical methods that take a StatisticFeature enum and interval_count
     float getAverage(StatisticFeature feature, int interval_count);
     float getStdDev(StatisticFeature feature, int interval_count);
-    float getMedian(StatisticFeature feature, int interval_count);
+    float getMedian(StatisticFeature feature, int interval_count); // getQuantiles() at q = 0.5
     float getMin(StatisticFeature feature, int interval_count);
     float getMax(StatisticFeature feature, int interval_count);
 
+    // All of the above (plus the count) over the last interval_count items. Read from the tracked
+    // window and order statistics when they cover the interval; otherwise in one walk back from the tail.
+    StatsSummary summarize(StatisticFeature feature, int interval_count);
+    // Same, for any numeric field of Data (see NUMERIC_FIELDS)
+    StatsSummary summarizeField(const NumericField& field, int interval_count);
+    // Same, split by the one-byte categorical field at 'group_offset' (see categorical_field_offset)
+    GroupSummaries summarizeByGroup(const NumericField& field, size_t group_offset, int interval_count);
+    // Same, for every StatisticFeature at once
+    StatsSummaryRow summarizeAll(int interval_count);
+
     void print() const;
     size_t getMemoryUsage() const;
 };
@@ -0,0 +1,66 @@
+// Exact order statistics (k-th smallest, quantiles) of a changing multiset of floats
+
+#ifndef ORDERSTATISTICS_H
+#define ORDERSTATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Indexable skip list: every link also stores how many positions it skips, so that the k-th
+// value is found by walking down the levels like a search, in O(log n) expected steps.
+// Entries are ordered by (value, seq); seq tells equal values apart, so that the one to erase
+// is found directly.
+class OrderStatisticList {
+public:
+    explicit OrderStatisticList(uint64_t seed = 1);
+    ~OrderStatisticList();
+
+    OrderStatisticList(OrderStatisticList&& other) noexcept;
+    OrderStatisticList& operator=(OrderStatisticList&& other) noexcept;
+    OrderStatisticList(const OrderStatisticList&) = delete;
+    OrderStatisticList& operator=(const OrderStatisticList&) = delete;
+
+    void insert(float value, uint64_t seq);
+    // Returns false when no entry has both this value and this seq
+    bool erase(float value, uint64_t seq);
+    void clear();
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // k-th smallest value, 0-based; k must be below size()
+    float kth(size_t k) const;
+    // Linear interpolation between the closest ranks, as exact_quantiles(); 0 when empty
+    float quantile(double q) const;
+
+    size_t getMemoryUsage() const;
+
+private:
+    static const int MAX_LEVEL = 32;
+
+    struct Node;
+    struct Link {
+        Node* node;   // Next node on this level, or nullptr
+        size_t width; // Positions skipped, counting the end of the list as position size() + 1
+    };
+    struct Node {
+        float value;
+        uint64_t seq;
+        int level;
+        // Flexible array member trick, as in SkipList. Must be the LAST member.
+        Link next[1];
+    };
+
+    static Node* createNode(int level, float value, uint64_t seq);
+    static bool before(const Node* node, float value, uint64_t seq);
+    int randomLevel();
+    // Fills, for every level, the last node before (value, seq) and its position
+    void findPredecessors(float value, uint64_t seq, Node** update, size_t* position) const;
+
+    Node* head;
+    int level = 1; // Levels in use
+    size_t count = 0;
+    uint64_t random_state;
+};
+
+#endif // ORDERSTATISTICS_H
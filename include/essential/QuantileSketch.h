@@ -0,0 +1,83 @@
+// Mergeable quantile sketches, and the per-bucket sketches the statistics structures keep
+
+#ifndef QUANTILESKETCH_H
+#define QUANTILESKETCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "data.h"
+
+// Records per arrival bucket: each bucket keeps one sketch per StatisticFeature
+const size_t QUANTILE_BUCKET_SIZE = 4096;
+// Intervals up to this many records are answered exactly, from the values themselves
+const size_t QUANTILE_EXACT_LIMIT = 4096;
+
+// KLL sketch (Karnin, Lang and Liberty) of a stream of floats. Level h holds items that stand
+// for 2^h values each; when the sketch outgrows its capacity, the lowest full level is sorted
+// and every other item (alternating between odd and even positions) moves one level up.
+// The number of retained items stays O(k), two sketches merge level by level, and the rank of
+// any answer is within about rankError() * count() of the requested one.
+class QuantileSketch {
+public:
+    static const uint16_t DEFAULT_K = 200;
+
+    explicit QuantileSketch(uint16_t k = DEFAULT_K);
+
+    // Smallest k whose rankError() is at most 'rank_error' (e.g. 0.01 for +-1% of the ranks)
+    static uint16_t kForRankError(double rank_error);
+
+    void add(float value);
+    void merge(const QuantileSketch& other);
+    void clear();
+
+    uint64_t count() const { return n; }
+    bool empty() const { return n == 0; }
+    uint16_t getK() const { return k; }
+    // Normalized rank error, at about 99% confidence
+    double rankError() const;
+
+    // Value of rank q * count(), q in [0, 1]; 0 and 1 give the exact min and max
+    float quantile(double q) const;
+    // Same, for several q at once (sorting the retained items once)
+    std::vector<float> quantiles(const std::vector<double>& qs) const;
+
+    size_t retained() const { return retained_count; }
+    size_t getMemoryUsage() const;
+
+private:
+    size_t levelCapacity(size_t level) const;
+    // Grows the sketch to 'count' levels and recomputes total_capacity, which depends on the height
+    void resizeLevels(size_t count);
+    void compress();
+    void compact(size_t level);
+
+    uint16_t k;
+    uint64_t n = 0;
+    float low = 0.0f;
+    float high = 0.0f;
+    size_t retained_count = 0;
+    size_t total_capacity = 0; // Sum of the level capacities, checked on every add()
+    uint64_t coin = 0x9e3779b97f4a7c15ull; // Deterministic source of the compaction offsets
+    std::vector<std::vector<float>> levels;
+};
+
+// Linear interpolation between the closest ranks (so q = 0.5 is the usual median). Reorders 'values'.
+std::vector<float> exact_quantiles(std::vector<float>& values, const std::vector<double>& qs);
+
+// One sketch per StatisticFeature over a bucket of consecutive arrivals
+struct FeatureSketches {
+    size_t live = 0;    // Records of the bucket still present
+    bool stale = false; // A record was removed: the sketches still count it until rebuilt
+    std::array<QuantileSketch, STATISTIC_FEATURE_COUNT> features; // Indexed by StatisticFeature
+
+    explicit FeatureSketches(uint16_t k);
+    // Adds every feature of 'data' to the sketches; 'live' is left to the owner
+    void add(const Data& data);
+    // Empties the sketches before a stale bucket is refilled with add()
+    void reset();
+    size_t getMemoryUsage() const;
+};
+
+#endif // QUANTILESKETCH_H
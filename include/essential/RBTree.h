@@ -35,6 +35,9 @@ public:
     void insert(const Data* data);
     bool remove(uint32_t key);
     const Data* find(uint32_t key) const;
+    // Batched find: out[i] receives the value for keys[i] or nullptr. Lookups descend in
+    // groups, prefetching the next node of every lookup before reading any of them.
+    void findMany(const uint32_t* keys, size_t count, const Data** out) const;
     bool contains(uint32_t key) const;
 
     // --- Utility Operations ---
@@ -0,0 +1,59 @@
+// Running aggregates of one series over a sliding window of its most recent values
+
+#ifndef SLIDINGWINDOW_H
+#define SLIDINGWINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+// Values enter at the back (newest) or at the front (an older value, when the window grows back
+// after a removal) and leave from the front or from anywhere. Every value carries a sequence
+// number that increases from the oldest to the newest value.
+//
+// Count, sum and sum of squares are kept as Kahan-compensated doubles of (value - shift), with
+// the shift set by the first value, so that the variance does not cancel out for large byte
+// counts. Min and max are the fronts of monotonic deques; removing a value from the middle can
+// expose a value the deques already dropped, so it marks the extrema stale until rebuilt.
+class SlidingAggregate {
+public:
+    void pushBack(float value, uint64_t seq);
+    void pushFront(float value, uint64_t seq);
+    void popFront(float value, uint64_t seq);
+    void erase(float value, uint64_t seq);
+    void clear();
+
+    size_t count() const { return n; }
+    double mean() const;
+    double variance() const; // Population variance, as getStdDev has always reported
+    float min() const { return min_queue.empty() ? 0.0f : min_queue.front().first; }
+    float max() const { return max_queue.empty() ? 0.0f : max_queue.front().first; }
+    bool extremaValid() const { return extrema_valid; }
+
+    // Drops the extrema and lets pushBack() refill them (oldest to newest) without touching the sums.
+    void resetExtrema();
+    void pushExtremum(float value, uint64_t seq);
+
+    size_t getMemoryUsage() const;
+
+private:
+    struct KahanSum {
+        double sum = 0.0;
+        double compensation = 0.0;
+        void add(double value);
+        double value() const { return sum + compensation; }
+    };
+
+    void accumulate(float value, double sign);
+
+    size_t n = 0;
+    double shift = 0.0;
+    KahanSum sum;
+    KahanSum sum_squares;
+    std::deque<std::pair<float, uint64_t>> min_queue; // Increasing values, oldest first
+    std::deque<std::pair<float, uint64_t>> max_queue; // Decreasing values, oldest first
+    bool extrema_valid = true;
+};
+
+#endif // SLIDINGWINDOW_H
@@ -27,6 +27,9 @@ public:
     bool insert(const Data* data);
     bool remove(uint32_t id);
     const Data* search(uint32_t id);
+    // Batched search: out[i] receives the Data* of ids[i] or nullptr. Both candidate slots and
+    // their records are prefetched for a group of ids before any of them is compared.
+    void findMany(const uint32_t* ids, size_t count, const Data** out) const;
     bool contains(uint32_t id) const;
     size_t getSize() const;
     size_t getCapacity() const;
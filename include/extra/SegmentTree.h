@@ -8,47 +8,101 @@
 #include <vector>
 #include <map>
 #include <memory>    // For std::unique_ptr
+#include <array>
 #include <algorithm> // For std::min_element, std::max_element etc.
 #include "data.h"    // For Data struct definition
+#include "stats_summary.h" // For StatsSummary
+#include "essential/QuantileSketch.h" // For the per-bucket quantile sketches
+#include "essential/OrderStatistics.h" // For exact quantiles over the whole tree
+#include "essential/Histogram.h"       // For the maintained distributions
 
 // SegmentTree with methods: insert, remove, find (using id), and getTotalRate
 class SegmentTree {
+public:
+    // Sum, sum of squares, min and max of one feature over a range of indices
+    struct FeatureAggregate {
+        double sum = 0.0;
+        double sum_squares = 0.0;
+        float min = 0.0f;
+        float max = 0.0f;
+    };
+
+    // What every node keeps about the records below it, for each StatisticFeature
+    struct Aggregate {
+        size_t count = 0;
+        std::array<FeatureAggregate, STATISTIC_FEATURE_COUNT> features; // Indexed by StatisticFeature
+
+        void add(const Data& data);
+        void merge(const Aggregate& other);
+        double mean(StatisticFeature feature) const;
+        double variance(StatisticFeature feature) const; // Population variance, as getStdDev reports
+        float min(StatisticFeature feature) const { return features[static_cast<size_t>(feature)].min; }
+        float max(StatisticFeature feature) const { return features[static_cast<size_t>(feature)].max; }
+    };
+
 private:
     // Node struct for the Segment Tree
     struct Node {
         int left, right;                // Range covered by this node
-        float sumRate;                  // Aggregate sum of rates in this node's range
+        Aggregate aggregate;            // Every feature of the records in this node's range
         std::unique_ptr<Node> leftChild;    // Pointer to left child
         std::unique_ptr<Node> rightChild;   // Pointer to right child
         std::vector<const Data*> values;    // Stores pointers to Data objects if leaf node
 
         // Constructor for Node
-        Node(int l, int r) : left(l), right(r), sumRate(0.0f) {}
+        Node(int l, int r) : left(l), right(r) {}
     };
 
     std::unique_ptr<Node> root;             // Root of the Segment Tree
     std::map<uint32_t, int> idToIndex;      // Maps Data ID to its index in the implicit array
     int nextIndex = 0;                      // Next available index for new Data items
 
+    // Quantile sketches for every QUANTILE_BUCKET_SIZE consecutive indices (null once emptied).
+    // Mutable: a bucket left stale by a removal is rebuilt from its leaves by the query that needs it.
+    uint16_t quantile_k = 0;                // 0 until trackQuantiles()
+    mutable std::vector<std::unique_ptr<FeatureSketches>> quantile_buckets;
+    std::vector<OrderStatisticList> order_statistics; // One per feature, keyed by (value, index); empty until trackOrderStatistics()
+    std::vector<LogHistogram> histograms;             // One per feature; empty until trackHistograms()
+
     // Private helper for recursive insertion
     void insert(Node* node, int idx, const Data* data); // Takes const Data*
 
     // Private helper for recursive removal
     bool remove(Node* node, int idx, uint32_t id);
 
-    // Private helper to get sum of rates (handles null nodes)
-    float getSum(Node* node) const;
+    // Recomputes a node's aggregate from its leaf values or from its children
+    void pull(Node* node);
+
+    // Merges the aggregates of the nodes covering [from, to] into 'out'
+    void aggregateRange(const Node* node, int from, int to, Aggregate& out) const;
+    // Merges the aggregates of the 'limit' most recent records into 'out', whole subtrees at a time
+    void aggregateRecent(const Node* node, size_t limit, Aggregate& out) const;
+
+    // Index of the 'rank'-th most recent record below 'node' (1 for the newest), from the node counts
+    int recentIndex(const Node* node, size_t rank) const;
+    // Appends the records whose index lies in [from, to], in index order
+    void collectRange(const Node* node, int from, int to, std::vector<const Data*>& out) const;
+    void quantileInsert(int idx, const Data* data);
+    void quantileRemove(int idx);
+    void rebuildQuantiles();
 
     // Private helper for recursive find
     // Returns const Data* to the object (owned externally).
     const Data* find(Node* node, int idx, uint32_t id); // Returns const Data*
 
-    // Helper to get feature value from a Data object based on StatisticFeature enum
-    float getFeatureValue(const Data* data, StatisticFeature feature) const;
+    // Collects up to 'limit' of the most recent Data pointers, newest first, walking right to left
+    void collectRecentRecursive(const Node* node, size_t limit, std::vector<const Data*>& collected_pointers) const;
+    // The last interval_count records, newest first
+    std::vector<const Data*> collectRecent(int interval_count) const;
+
+    // Whether the order statistics hold exactly the last 'interval_count' records
+    bool orderStatisticsCover(int interval_count) const;
+    // summarize() with count, mean, variance, min and max taken from 'aggregate' (the aggregateRecent()
+    // of the interval). The median is read from the order statistics or sketches where getMedian()
+    // reads it; otherwise it is selected from the interval's 'recent' records, collected on first use.
+    StatsSummary aggregateSummary(const Aggregate& aggregate, StatisticFeature feature, int interval_count,
+                                  std::vector<const Data*>& recent) const;
 
-    // Helper to recursively collect all data pointers from the tree
-    void collectAllDataPointersRecursive(Node* node, std::vector<const Data*>& collected_pointers) const;
-    
     // NEW: Recursive helper for memory usage calculation
     size_t getMemoryUsageRecursive(const Node* node) const;
 
@@ -72,18 +126,70 @@ public: // Moved collectFeatureValuesForInterval to public
     // Note: The returned pointer points to external data.
     const Data* find(uint32_t id); // Returns const Data*
 
+    // Batched find: out[i] receives the Data object for ids[i] or nullptr.
+    // A group of lookups descends the tree in lockstep, prefetching the next node of each one.
+    void findMany(const uint32_t* ids, size_t count, const Data** out) const;
+
     // Gets the total sum of rates across all data in the tree.
     float getTotalRate() const;
 
+    // Index given to a record on insertion (increasing with insertion order), or -1 if absent
+    int indexOf(uint32_t id) const;
+
+    // Aggregates of every feature over the records whose index lies in [first_index, last_index].
+    // Answered from the node aggregates in O(log n), without visiting the leaves.
+    Aggregate aggregateRange(int first_index, int last_index) const;
+    // Same, over the last interval_count records inserted (and not removed)
+    Aggregate aggregateRecent(int interval_count) const;
+
     // NEW: Method to calculate total memory usage
     size_t getMemoryUsage() const;
 
-    // Generic statistical methods that take a StatisticFeature enum and interval_count
+    // Keeps a quantile sketch per feature for every QUANTILE_BUCKET_SIZE indices, sized for the
+    // given normalized rank error, so that getQuantiles() over long intervals merges sketches
+    // instead of sorting the values.
+    void trackQuantiles(double rank_error);
+
+    // Keeps every feature of every record in an order-statistic list, so that exact quantiles over
+    // the whole tree (any interval_count >= its size) take O(log n) instead of a selection.
+    void trackOrderStatistics();
+
+    // Keeps a LogHistogram per feature over every record, updated on insert and removal.
+    void trackHistograms();
+
+    // Distribution of a feature over the last interval_count items in at most 'bins' bins. LOG bins
+    // over the whole tree come from the maintained histograms in O(buckets); anything else is
+    // counted from the values of the interval.
+    std::vector<HistogramBin> getHistogram(StatisticFeature feature, int interval_count, HistogramScale scale, size_t bins) const;
+    // Whether getHistogram() over that many items reads the maintained histograms
+    bool histogramMaintained(int interval_count, HistogramScale scale) const;
+
+    // Quantiles (each q in [0, 1]) of a feature over the last interval_count items. Exact when the
+    // order statistics cover the interval, when 'exact' is set, when no sketches are tracked or for
+    // at most QUANTILE_EXACT_LIMIT items; otherwise within the tracked rank error.
+    std::vector<float> getQuantiles(StatisticFeature feature, int interval_count, const std::vector<double>& qs, bool exact = false) const;
+    // Whether getQuantiles() over that many items is answered exactly
+    bool quantilesExact(int interval_count) const;
+
+    // Generic statistical methods that take a StatisticFeature enum and interval_count.
+    // All but getMedian come from aggregateRecent() in O(log n); getMedian is getQuantiles() at q = 0.5.
     float getAverage(StatisticFeature feature, int interval_count) const;
     float getStdDev(StatisticFeature feature, int interval_count) const;
     float getMedian(StatisticFeature feature, int interval_count) const;
     float getMin(StatisticFeature feature, int interval_count) const;
     float getMax(StatisticFeature feature, int interval_count) const;
+
+    // All of the above (plus the count) over the last interval_count items. Everything but the median
+    // comes from aggregateRecent(); the median needs the values only where getMedian() does, gathered
+    // in a single traversal that visits the rightmost leaves holding them
+    StatsSummary summarize(StatisticFeature feature, int interval_count) const;
+    // Same, for any numeric field of Data (see NUMERIC_FIELDS)
+    StatsSummary summarizeField(const NumericField& field, int interval_count) const;
+    // Same, split by the one-byte categorical field at 'group_offset' (see categorical_field_offset).
+    // The node aggregates are not split by group, so the records of the interval are always visited.
+    GroupSummaries summarizeByGroup(const NumericField& field, size_t group_offset, int interval_count) const;
+    // Same, for every StatisticFeature at once
+    StatsSummaryRow summarizeAll(int interval_count) const;
 };
 
 #endif // SEGMENTTREE_H
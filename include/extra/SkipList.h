@@ -30,6 +30,11 @@ public:
     // Returns a const pointer to the Data object if found, nullptr otherwise.
     const Data* find(uint32_t key) const;
 
+    // Batched find: out[i] receives the Data object for keys[i] or nullptr.
+    // Lookups advance one step at a time in round-robin, each prefetching the node it will
+    // read next, so the cache misses of a group of searches overlap.
+    void findMany(const uint32_t* keys, size_t count, const Data** out) const;
+
     // Checks if the skip list is empty.
     bool empty() const;
 
@@ -0,0 +1,45 @@
+// Vectorized reductions over feature values: sum, sum of squares, min, max, count-in-range and histograms.
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "data.h"
+#include "data_fields.h" // For FieldType
+
+// Instruction sets the kernels are compiled for. The best one the CPU supports is picked once,
+// at startup; SCALAR is the portable fallback and the reference the others are tested against.
+enum class SimdLevel : uint8_t { SCALAR = 0, SSE2, AVX2 };
+
+const char* simd_level_name(SimdLevel level);
+// Best level supported by this CPU (and this build)
+SimdLevel detected_simd_level();
+SimdLevel active_simd_level();
+// Switches every kernel to 'level', or to the best supported level below it. For tests and benchmarks.
+void set_simd_level(SimdLevel level);
+
+// Sums are of (value - shift), accumulated in double: with 'shift' near the mean, the sum of
+// squares gives the variance without cancelling out, as in SlidingAggregate.
+struct Reduction {
+    size_t count = 0;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    float min = 0.0f; // 0 when count is 0
+    float max = 0.0f;
+};
+
+// Over a contiguous column
+Reduction reduce(const float* values, size_t n, float shift = 0.0f);
+
+// Over one field of an array of packed Data records (stride sizeof(Data)), e.g. a copy of a batch
+Reduction reduce_field(const Data* records, size_t n, size_t offset, FieldType type, float shift = 0.0f);
+
+// Number of values with low <= value <= high
+size_t count_in_range(const float* values, size_t n, float low, float high);
+
+// Adds to bins[b] the values of [low, high) that fall into the b-th of bin_count equal-width bins;
+// high itself goes to the last bin, everything else outside the range (and NaN) is skipped.
+void histogram(const float* values, size_t n, float low, float high, uint64_t* bins, size_t bin_count);
+
+#endif // KERNELS_H
@@ -0,0 +1,162 @@
+// Asynchronous logger: callers format into a lock-free ring, a background thread writes in batches.
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t { DEBUG = 0, INFO, WARN, ERROR, OFF };
+
+const char* log_level_name(LogLevel level);
+// "debug", "info", "warn", "error" or "off"; returns false for anything else.
+bool parse_log_level(const std::string& name, LogLevel& level);
+
+// Statements below this level are compiled out entirely. Defaults to INFO; building with
+// -DLOG_MIN_LEVEL=0 (CMake option LOG_DEBUG) keeps the per-request DEBUG lines.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 1
+#endif
+
+const size_t LOG_TEXT_CAPACITY = 232; // Longer messages are truncated; a record fills 256 bytes
+
+// One message. The BINARY sink writes the fields up to 'text' followed by 'length' bytes of text.
+struct LogRecord {
+    uint64_t timestamp_ns; // system_clock, since the epoch
+    uint32_t thread;       // Small number given to each logging thread
+    LogLevel level;
+    uint8_t truncated;
+    uint16_t length;
+    char text[LOG_TEXT_CAPACITY];
+};
+
+enum class LogSink { TEXT, BINARY };
+
+// Bounded multi-producer ring (one sequence number per slot, as in Vyukov's MPMC queue, with a
+// single consumer). Producers never block and never take a lock: when the ring is full the
+// message is dropped and counted. The flusher thread wakes every FLUSH_INTERVAL, formats what
+// is ready and writes it with one fwrite per stream.
+class Logger {
+public:
+    static const size_t DEFAULT_CAPACITY = 4096;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{10};
+
+    // TEXT writes lines to 'out', WARN and above to 'err'; BINARY writes every record to 'out'.
+    Logger(size_t capacity, FILE* out, FILE* err, LogSink sink = LogSink::TEXT);
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Process-wide logger on stdout/stderr. LOG_LEVEL sets the runtime level and
+    // LOG_BINARY_FILE switches it to binary records appended to that file.
+    static Logger& instance();
+
+    bool enabled(LogLevel level) const { return static_cast<uint8_t>(level) >= minimum.load(std::memory_order_relaxed); }
+    void setLevel(LogLevel level) { minimum.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+    LogLevel level() const { return static_cast<LogLevel>(minimum.load(std::memory_order_relaxed)); }
+
+    // Reserves a record, or returns nullptr (and counts a drop) when the ring is full.
+    // Every claimed record must be committed, in any order.
+    LogRecord* claim(size_t& ticket);
+    void commit(size_t ticket);
+
+    // Writes everything committed so far before returning.
+    void flush();
+    // Flushes and ends the flusher thread; later messages stay in the ring.
+    void stop();
+
+    uint64_t written() const { return written_count.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        LogRecord record;
+    };
+
+    void run();
+    void drain(); // Consumer side, under drain_mutex
+    void appendText(std::vector<char>& batch, const LogRecord& record);
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos{0};
+    alignas(64) std::atomic<uint8_t> minimum{static_cast<uint8_t>(LOG_MIN_LEVEL)};
+    std::atomic<uint64_t> written_count{0};
+    std::atomic<uint64_t> dropped_count{0};
+
+    std::mutex drain_mutex; // Taken by the consumer side only (flusher, flush(), stop())
+    size_t dequeue_pos = 0;
+    std::vector<char> out_batch;
+    std::vector<char> err_batch;
+    int64_t cached_second = -1; // Timestamp prefix cache, for the TEXT sink
+    char cached_prefix[32];
+
+    FILE* out;
+    FILE* err;
+    LogSink sink;
+    std::atomic<bool> running{true};
+    std::thread flusher;
+};
+
+// Builds one message in place inside a claimed record; committed when it goes out of scope.
+// Numbers are written with std::to_chars, so a message costs no allocation.
+class LogLine {
+public:
+    LogLine(Logger& logger, LogLevel level);
+    ~LogLine();
+
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(const std::string& text) { append(text.data(), text.size()); return *this; }
+    LogLine& operator<<(char c) { append(&c, 1); return *this; }
+    LogLine& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+    LogLine& operator<<(const void* pointer);
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value, LogLine&>::type operator<<(T value) {
+        char digits[24];
+        append(digits, static_cast<size_t>(std::to_chars(digits, digits + sizeof(digits), value).ptr - digits));
+        return *this;
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, LogLine&>::type operator<<(T value) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), static_cast<double>(value), std::chars_format::general, 6);
+        append(digits, static_cast<size_t>(result.ptr - digits));
+        return *this;
+    }
+
+private:
+    void append(const char* text, size_t n);
+
+    Logger& logger;
+    size_t ticket = 0; // Declared before 'record', which claim() initializes through it
+    LogRecord* record;
+};
+
+#define LOG_AT(level, ...)                                                              \
+    do {                                                                                \
+        if (static_cast<int>(level) >= LOG_MIN_LEVEL && Logger::instance().enabled(level)) { \
+            LogLine log_line_(Logger::instance(), level);                               \
+            log_line_ << __VA_ARGS__;                                                   \
+        }                                                                               \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -0,0 +1,38 @@
+// Publishes the results of continuous queries on a ZMQ PUB socket.
+
+#ifndef QUERY_PUBLISHER_H
+#define QUERY_PUBLISHER_H
+
+#include <string>
+#include <cstdint>
+#include <zmq.hpp> // For the C++ ZeroMQ bindings
+
+// Default endpoint; 5559 is taken by the predictor's stats publisher.
+const char* const QUERY_PUBLISHER_ADDRESS = "tcp://*:5560";
+
+class QueryPublisher {
+public:
+    explicit QueryPublisher(const std::string& bind_address = QUERY_PUBLISHER_ADDRESS);
+    ~QueryPublisher();
+
+    bool start();
+
+    // Sends a two-frame message [topic, payload]. Never blocks: when a slow subscriber fills the
+    // high-water mark the message is dropped for it, so ingest is never held up by a dashboard.
+    bool publish(const std::string& topic, const std::string& payload);
+    bool publish(const std::string& topic, const char* payload, size_t size);
+
+    const std::string& address() const { return bind_address_; }
+    uint64_t publishedCount() const { return published_; }
+    uint64_t droppedCount() const { return dropped_; }
+
+private:
+    zmq::context_t context_;
+    zmq::socket_t publisher_socket_;
+    std::string bind_address_;
+    bool started_;
+    uint64_t published_;
+    uint64_t dropped_;
+};
+
+#endif // QUERY_PUBLISHER_H
@@ -0,0 +1,20 @@
+// Software prefetch helpers shared by the batched lookups (findMany) of the data structures.
+
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <cstddef>
+
+// Number of lookups kept in flight by the batched lookups. Each stage of a group issues one
+// prefetch per lookup before touching any of them, so up to this many cache misses overlap.
+inline constexpr size_t PREFETCH_GROUP_SIZE = 16;
+
+inline void prefetch_read(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#else
+    (void)address;
+#endif
+}
+
+#endif // PREFETCH_H
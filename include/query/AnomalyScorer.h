@@ -0,0 +1,86 @@
+// First-line anomaly detection at ingest: EWMA baselines per feature and a z-score per record.
+
+#ifndef ANOMALYSCORER_H
+#define ANOMALYSCORER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "query/CategoricalIndex.h"
+
+// Exponentially weighted mean and variance of one feature (West's incremental form), so recent
+// records weigh more and the baseline follows slow drifts of the traffic.
+struct EwmaBaseline {
+    double mean = 0.0;
+    double variance = 0.0;
+    uint64_t count = 0;
+
+    void update(double value, double alpha);
+    double stdDev() const;
+};
+
+// Raised when a record's score reaches the threshold. 'feature' is the one that deviated most.
+struct AnomalyAlert {
+    uint32_t id;
+    double score;
+    StatisticFeature feature;
+    float value;
+    double expected; // Baseline mean of log1p(value)
+    double stddev;
+    uint8_t group;   // Value of the grouping field, 0 when ungrouped
+};
+
+using FeatureBaselines = std::array<EwmaBaseline, STATISTIC_FEATURE_COUNT>; // Indexed by StatisticFeature
+
+// Scores each record against the baselines before folding it in. The score is the largest
+// |z| over the StatisticFeatures, taken on log1p(value) since byte and packet counts are heavy
+// tailed. With grouping, a record is compared to the baselines of its service (or proto, ...)
+// once that group has seen 'warmup' records, and to the global baselines until then. No alert is
+// raised before the global baselines are warm. A NaN or infinite feature value is skipped: it is
+// neither scored nor folded into that feature's baselines.
+class AnomalyScorer {
+public:
+    static constexpr double DEFAULT_ALPHA = 0.01;
+    static constexpr double DEFAULT_THRESHOLD = 5.0;
+
+    AnomalyScorer(double alpha = DEFAULT_ALPHA, double threshold = DEFAULT_THRESHOLD);
+
+    // Keeps a second set of baselines per value of 'field'
+    void groupBy(CategoricalField field);
+    bool grouped() const { return is_grouped; }
+    CategoricalField groupField() const { return group_field; }
+
+    // Scores and learns one record; fills 'alert' and returns true when it reaches the threshold.
+    bool score(const Data& record, AnomalyAlert& alert);
+    // Same for a batch, appending its alerts
+    void onBatch(const Data* records, size_t n, std::vector<AnomalyAlert>& alerts);
+
+    const FeatureBaselines& baselines() const { return global; }
+    const FeatureBaselines& groupBaselines(uint8_t group) const { return groups[group]; }
+
+    double alpha() const { return smoothing; }
+    double threshold() const { return alert_threshold; }
+    uint64_t warmup() const { return warmup_count; }
+    uint64_t scoredCount() const { return scored; }
+    uint64_t alertCount() const { return alerted; }
+
+private:
+    double smoothing;
+    double alert_threshold;
+    uint64_t warmup_count; // About one time constant, 1 / alpha records
+    bool is_grouped = false;
+    CategoricalField group_field = CategoricalField::SERVICE;
+    size_t group_offset = 0;
+    FeatureBaselines global;
+    std::array<FeatureBaselines, 256> groups;
+    uint64_t scored = 0;
+    uint64_t alerted = 0;
+};
+
+// One line for the PUB socket
+std::string format_alert(const AnomalyAlert& alert);
+
+#endif // ANOMALYSCORER_H
@@ -0,0 +1,81 @@
+// Compressed bitmap of 32-bit record slots (roaring-style containers).
+
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Values are split into a 16-bit container key (high bits) and a 16-bit offset (low bits).
+// Sparse containers are sorted uint16_t arrays; once a container holds more than
+// ARRAY_MAX_CARDINALITY values it becomes a 65536-bit bitset, whose AND/OR/ANDNOT run
+// word-parallel with SSE2/AVX2.
+class Bitmap {
+public:
+    static const size_t ARRAY_MAX_CARDINALITY = 4096;
+    static const size_t BITSET_WORDS = 1024; // 65536 bits
+
+    void add(uint32_t value);
+    bool remove(uint32_t value);
+    bool contains(uint32_t value) const;
+
+    // Removes every value lower than 'value'. Slots grow with ingest order, so this is how evictions are applied.
+    void removeBelow(uint32_t value);
+
+    size_t cardinality() const;
+    bool empty() const { return containers.empty(); }
+    void clear() { containers.clear(); }
+
+    // Bitmap holding every value of [begin, end)
+    static Bitmap range(uint32_t begin, uint32_t end);
+
+    Bitmap intersect(const Bitmap& other) const; // AND
+    Bitmap unite(const Bitmap& other) const;     // OR
+    Bitmap subtract(const Bitmap& other) const;  // ANDNOT
+
+    // Visits the values in increasing order.
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        for (const Container& c : containers) {
+            uint32_t high = static_cast<uint32_t>(c.key) << 16;
+            if (c.isBitset()) {
+                for (size_t w = 0; w < BITSET_WORDS; ++w) {
+                    uint64_t word = c.bits[w];
+                    while (word) {
+                        uint32_t bit = static_cast<uint32_t>(__builtin_ctzll(word));
+                        visit(high | static_cast<uint32_t>(w * 64 + bit));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (uint16_t low : c.array) visit(high | low);
+            }
+        }
+    }
+
+    size_t getMemoryUsage() const;
+
+private:
+    struct Container {
+        uint16_t key = 0;
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array; // Sorted offsets while the container is sparse
+        std::vector<uint64_t> bits;  // BITSET_WORDS words once the container is dense
+
+        bool isBitset() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+        void toBitset();
+        void normalize(); // Picks the representation that matches the cardinality
+    };
+
+    enum class Op { AND, OR, ANDNOT };
+
+    static Container combine(const Container& a, const Container& b, Op op);
+    Container* findContainer(uint16_t key);
+    const Container* findContainer(uint16_t key) const;
+
+    std::vector<Container> containers; // Sorted by key, never empty containers
+};
+
+#endif // BITMAP_H
@@ -0,0 +1,80 @@
+// Bitmap indexes over the categorical fields of Data, keyed by record slot.
+
+#ifndef CATEGORICALINDEX_H
+#define CATEGORICALINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "query/Bitmap.h"
+
+enum class CategoricalField : uint8_t {
+    LABEL = 0,
+    PROTO,
+    STATE,
+    SERVICE,
+    ATTACK_CAT
+};
+
+const size_t CATEGORICAL_FIELD_COUNT = 5;
+
+// One filter term: "field=v1,v2" matches any listed value, "field!=v1,v2" matches none of them.
+struct CategoricalPredicate {
+    CategoricalField field;
+    std::vector<uint8_t> values;
+    bool negated;
+};
+
+// Maps a query parameter name ("label", "proto", "state", "service", "attack_cat") to its field.
+bool parse_categorical_field(const std::string& name, CategoricalField& field);
+
+const char* categorical_field_name(CategoricalField field);
+
+uint8_t categorical_value(const Data* d, CategoricalField field);
+
+// Offset of 'field' in Data; every categorical field is stored in one byte, so grouping loops can
+// read it with read_field<uint8_t> instead of switching on the field per record.
+size_t categorical_field_offset(CategoricalField field);
+
+// Record-level check of a single predicate, used when scanning instead of intersecting bitmaps.
+bool predicate_matches(const Data* d, const CategoricalPredicate& predicate);
+
+// Extracts the categorical filters from the parsed query parameters. A parameter named
+// "proto!" (from "proto!=6") is the negated form. Returns false and fills 'error' on a bad value.
+bool parse_categorical_predicates(const std::map<std::string, std::string>& params,
+                                  std::vector<CategoricalPredicate>& predicates, std::string& error);
+
+class CategoricalIndexes {
+public:
+    void insert(const Data* d, uint32_t slot);
+
+    // Drops every slot below 'first_live_slot' (records evicted from the RecordStore).
+    void evictBelow(uint32_t first_live_slot);
+
+    void clear();
+
+    const Bitmap& lookup(CategoricalField field, uint8_t value) const;
+
+    // Number of live records with 'value' in 'field'. Kept up to date on insert and evict,
+    // these counters are the cardinality statistics used by the QueryPlanner.
+    size_t count(CategoricalField field, uint8_t value) const { return counts[static_cast<size_t>(field)][value]; }
+
+    // Slots among [first_slot, end_slot) that satisfy every predicate. Positive predicates are
+    // intersected in the given order, so the most selective one should come first.
+    Bitmap evaluate(const std::vector<CategoricalPredicate>& predicates, uint32_t first_slot, uint32_t end_slot) const;
+
+    // Union of the bitmaps of the values listed in 'predicate' (ignores 'negated').
+    Bitmap valuesOf(const CategoricalPredicate& predicate) const;
+
+    size_t getMemoryUsage() const;
+
+private:
+    std::array<std::array<Bitmap, 256>, CATEGORICAL_FIELD_COUNT> bitmaps;
+    std::array<std::array<uint32_t, 256>, CATEGORICAL_FIELD_COUNT> counts{};
+};
+
+#endif // CATEGORICALINDEX_H
@@ -0,0 +1,119 @@
+// Column-wise copy of the live records, for statistics and filters that read a few fields of many rows.
+
+#ifndef COLUMNSTORE_H
+#define COLUMNSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "data.h"
+#include "data_fields.h"
+#include "query/Bitmap.h"
+#include "query/RangePredicate.h"
+#include "stats_summary.h"
+
+// Rows per block. Slot s lives in block s / COLUMN_BLOCK_ROWS, at row s % COLUMN_BLOCK_ROWS.
+const size_t COLUMN_BLOCK_ROWS = 4096;
+// Every column of a block starts on a cache line (and on a vector register boundary)
+const size_t COLUMN_ALIGNMENT = 64;
+
+// Number of columns: one per NUMERIC_FIELDS entry plus one per one-byte flag or categorical member
+const size_t COLUMN_COUNT = NUMERIC_FIELD_COUNT + 7;
+
+// Same records and slots as the RecordStore, stored as one array per member of Data inside
+// blocks of COLUMN_BLOCK_ROWS rows. Each block is a single aligned allocation, so a scan of one
+// field over a window reads contiguous values of its native type instead of one cache line per
+// record. Slots are kept in lockstep with the RecordStore by appending and evicting in the same
+// order; evicted rows free their block once all of its rows are gone.
+class ColumnStore {
+public:
+    ColumnStore() = default;
+
+    ColumnStore(const ColumnStore&) = delete;
+    ColumnStore& operator=(const ColumnStore&) = delete;
+
+    // Scatters 'record' into the columns and returns its slot.
+    uint32_t append(const Data& record);
+
+    // Evicts the 'n' oldest records. Returns how many were evicted.
+    size_t evictOldest(size_t n);
+
+    // Rebuilds the record in 'slot' into 'out'. Returns false if the slot is not live.
+    bool read(uint32_t slot, Data& out) const;
+
+    uint32_t firstSlot() const { return first_slot; }
+    uint32_t endSlot() const { return end_slot; }
+    size_t size() const { return end_slot - first_slot; }
+    bool empty() const { return end_slot == first_slot; }
+
+    // Calls fn(values, n, first) for each block-contiguous run of the live slots in [begin, end):
+    // 'values' points to the n values of NUMERIC_FIELDS[field_index] for slots first, first + 1, ...
+    // T must be the storage type of the field.
+    template <typename T, typename Fn>
+    void scan(size_t field_index, uint32_t begin, uint32_t end, Fn&& fn) const {
+        if (begin < first_slot) begin = first_slot;
+        if (end > end_slot) end = end_slot;
+        while (begin < end) {
+            size_t block = begin / COLUMN_BLOCK_ROWS;
+            uint32_t block_end = static_cast<uint32_t>((block + 1) * COLUMN_BLOCK_ROWS);
+            uint32_t run_end = end < block_end ? end : block_end;
+            const T* values = column<T>(blocks[block - first_block].get(), field_index);
+            fn(values + (begin - block * COLUMN_BLOCK_ROWS), static_cast<size_t>(run_end - begin), begin);
+            begin = run_end;
+        }
+    }
+
+    // Count, mean, variance, min and max of a field over the 'interval_count' newest records (all
+    // of them if it exceeds the store, none if it is not positive, like the list and segment tree).
+    // Blocks are reduced in place with compute_moments() and merged; windows of several blocks are
+    // split over the shared ThreadPool.
+    Moments moments(const NumericField& field, int interval_count) const;
+
+    // The moments plus the median. Only the median needs a copy of the window, to select from.
+    StatsSummary summarizeField(const NumericField& field, int interval_count) const;
+    StatsSummaryRow summarizeAll(int interval_count) const;
+
+    // Slots of the live records that satisfy every range, checked column by column on each block
+    // with a selection vector. 'rows_examined' is increased by the rows read.
+    Bitmap select(const std::vector<RangePredicate>& ranges, size_t& rows_examined) const;
+
+    size_t getMemoryUsage() const;
+
+private:
+    struct FreeAligned {
+        void operator()(unsigned char* block) const;
+    };
+    using Block = std::unique_ptr<unsigned char[], FreeAligned>;
+
+    // Byte offset of every column inside a block, and its width
+    struct Layout {
+        size_t data_offset[COLUMN_COUNT]; // Of the member in Data
+        size_t width[COLUMN_COUNT];
+        size_t column_offset[COLUMN_COUNT];
+        size_t block_bytes;
+        Layout();
+    };
+    static const Layout& layout();
+
+    template <typename T>
+    static const T* column(const unsigned char* block, size_t index) {
+        return reinterpret_cast<const T*>(block + layout().column_offset[index]);
+    }
+
+    uint32_t windowBegin(int interval_count) const {
+        size_t n = static_cast<size_t>(interval_count > 0 ? interval_count : 0);
+        return n >= size() ? first_slot : end_slot - static_cast<uint32_t>(n);
+    }
+
+    // summarizeField with a caller-owned buffer for the median, reused across the features of summarizeAll
+    StatsSummary summarize(const NumericField& field, int interval_count, std::vector<float>& scratch) const;
+
+    std::deque<Block> blocks;
+    size_t first_block = 0; // Block index of blocks.front()
+    uint32_t first_slot = 0;
+    uint32_t end_slot = 0;
+};
+
+#endif // COLUMNSTORE_H
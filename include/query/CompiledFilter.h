@@ -0,0 +1,57 @@
+// Filter predicates compiled into typed terms and evaluated block-wise with selection vectors.
+
+#ifndef COMPILEDFILTER_H
+#define COMPILEDFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "data.h"
+#include "data_fields.h"
+#include "query/Bitmap.h"
+#include "query/CategoricalIndex.h"
+#include "query/RangePredicate.h"
+#include "query/RecordStore.h"
+
+// Records processed per block; selection vectors index into a block, so this must fit in uint16_t.
+const size_t FILTER_BLOCK_SIZE = 1024;
+
+// One compiled condition: a closed range on a numeric field (bounds already converted to the
+// storage type of the field) or a membership test on a one-byte categorical field.
+struct FilterTerm {
+    size_t offset;
+    FieldType type;
+    bool membership;       // true: 'members' test, false: [low, high] test
+    float float_low = 0.0f, float_high = 0.0f;
+    uint32_t int_low = 0, int_high = 0;
+    uint64_t members[4] = {0, 0, 0, 0}; // Bit v is set if value v passes (negation already applied)
+};
+
+class CompiledFilter {
+public:
+    CompiledFilter() = default;
+
+    // Compiles the predicates in the given order, which is also the evaluation order:
+    // callers pass the most selective first.
+    CompiledFilter(const std::vector<CategoricalPredicate>& predicates, const std::vector<RangePredicate>& ranges);
+
+    bool empty() const { return terms.empty(); }
+    size_t size() const { return terms.size(); }
+
+    // Row-at-a-time check, for index walks that stop after a page.
+    bool matches(const Data* d) const;
+
+    // Slots of the live records that pass every term. 'rows_examined' is increased by the rows read.
+    Bitmap evaluate(const RecordStore& store, size_t& rows_examined) const;
+
+    // Same, restricted to the slots in 'candidates'.
+    Bitmap evaluate(const RecordStore& store, const Bitmap& candidates, size_t& rows_examined) const;
+
+private:
+    // Narrows 'selection' (indexes into 'rows') term by term; returns the number of survivors.
+    size_t filterBlock(const Data* const* rows, uint16_t* selection, size_t count) const;
+
+    std::vector<FilterTerm> terms;
+};
+
+#endif // COMPILEDFILTER_H
@@ -0,0 +1,79 @@
+// Server-side cursors for QUERY_FILTERED_SORTED / FETCH.
+
+#ifndef QUERYCURSOR_H
+#define QUERYCURSOR_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+#include "data.h"
+
+// Retained partial order over a candidate set.
+// The candidates are heapified once (O(N)) and every call to next() pops only the
+// rows it returns (O(n log N)), so page 2 never repeats the work done for page 1.
+class PartialOrder {
+public:
+    using Comparator = std::function<bool(const Data*, const Data*)>;
+
+    PartialOrder(std::vector<const Data*> rows, Comparator less);
+
+    // Rows that are already in their final order (e.g. produced by an index walk) skip the heap.
+    static PartialOrder presorted(std::vector<const Data*> ordered_rows);
+
+    // Appends the next 'n' rows (in 'less' order) to 'out'. Returns how many were appended.
+    size_t next(size_t n, std::vector<const Data*>& out);
+
+    size_t remaining() const { return heap.size() - position; }
+    size_t total() const { return total_rows; }
+
+private:
+    PartialOrder() = default;
+
+    std::vector<const Data*> heap;  // Binary heap, or the ordered rows when 'less' is empty
+    Comparator less;
+    size_t total_rows = 0;
+    size_t position = 0;            // Rows already handed out in presorted mode
+};
+
+class CursorManager {
+public:
+    explicit CursorManager(size_t max_cursors = 64,
+                           std::chrono::seconds ttl = std::chrono::seconds(60));
+
+    // Takes ownership of the remaining rows of 'order' and returns the new cursor id.
+    // 'delivered' is the number of rows already sent with the first page.
+    uint32_t open(PartialOrder order, size_t delivered);
+
+    // Fetches the next 'n' rows of a cursor. Returns false if the cursor does not exist
+    // or has expired. 'first_row_number' receives the 1-based position of the first row.
+    // The cursor is closed automatically once it is exhausted.
+    bool fetch(uint32_t cursor_id, size_t n, std::vector<const Data*>& out,
+               size_t& first_row_number, size_t& remaining);
+
+    bool close(uint32_t cursor_id);
+
+    // Drops cursors that were not touched within the TTL.
+    void expireIdle();
+
+    // Drops every cursor. Called when records are evicted, since cursors hold raw pointers.
+    void invalidateAll();
+
+    size_t size() const { return cursors.size(); }
+
+private:
+    struct Cursor {
+        PartialOrder order;
+        size_t delivered;
+        std::chrono::steady_clock::time_point last_access;
+    };
+
+    std::map<uint32_t, Cursor> cursors;
+    uint32_t next_id = 1;
+    size_t max_cursors;
+    std::chrono::seconds ttl;
+};
+
+#endif // QUERYCURSOR_H
@@ -0,0 +1,105 @@
+// Cost-based planning and execution of QUERY_FILTERED_SORTED.
+
+#ifndef QUERYPLANNER_H
+#define QUERYPLANNER_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "query/CategoricalIndex.h"
+#include "query/QueryCursor.h"
+#include "query/RangePredicate.h"
+#include "query/CompiledFilter.h"
+#include "query/ColumnStore.h"
+#include "query/RecordStore.h"
+#include "query/SortedIndex.h"
+
+// Everything QUERY_FILTERED_SORTED asks for, parsed once.
+struct QueryRequest {
+    std::vector<CategoricalPredicate> predicates;
+    std::vector<RangePredicate> ranges;
+    SortField sort_field = SortField::ID;
+    bool ascending = true;
+    size_t page_size = 20;
+    bool want_cursor = false;
+    bool stream = false;
+};
+
+// Parses the "key=value" parameters of QUERY_FILTERED_SORTED. Returns false and fills 'error' on bad input.
+bool parse_query_request(const std::map<std::string, std::string>& params, QueryRequest& request, std::string& error);
+
+enum class AccessPath {
+    INDEX_WALK,      // No filter: walk the sort index
+    INDEX_INTERSECT, // Intersect the bitmaps, materialize the matches and heap-order them
+    ORDERED_SCAN     // Walk the sort index and check the predicates on each record
+};
+
+const char* access_path_name(AccessPath path);
+
+struct PredicateEstimate {
+    CategoricalPredicate predicate;
+    size_t estimated_rows;
+    double selectivity;
+};
+
+// Indexed ranges are evaluated while planning: the exact match count is their estimate, and the
+// bitmap is reused by the execution. Unindexed ranges are estimated from a sample and evaluated
+// by the compiled residual filter, over the candidates left by the bitmaps.
+struct RangeEstimate {
+    RangePredicate predicate;
+    Bitmap matches;      // Indexed ranges only
+    double selectivity;
+    bool indexed;        // Served by a sorted index rather than a block scan
+    size_t rows_examined;
+    size_t estimated_rows;
+};
+
+struct QueryPlan {
+    QueryRequest request;
+    AccessPath path = AccessPath::INDEX_WALK;
+    std::vector<PredicateEstimate> predicates; // Evaluation order, driving predicate first
+    std::vector<RangeEstimate> ranges;         // Most selective first
+    CompiledFilter residual;                   // Unindexed ranges, applied block-wise after the bitmaps
+    CompiledFilter row_filter;                 // Every predicate, checked per row by ORDERED_SCAN
+    size_t live_rows = 0;
+    size_t estimated_matches = 0;
+    double intersect_cost = 0.0;               // Cost model units (~ns), for EXPLAIN
+    double ordered_scan_cost = 0.0;
+};
+
+// Filled in by QueryPlanner::execute
+struct QueryExecution {
+    size_t total_matches = 0;
+    size_t rows_examined = 0; // Bitmap matches materialized or index entries visited
+    double plan_us = 0.0;
+    double execute_us = 0.0;
+};
+
+class QueryPlanner {
+public:
+    QueryPlanner(const RecordStore& store, const CategoricalIndexes& categorical, const SortedIndexes& sorted);
+
+    // Estimates every predicate from the per-value cardinality counters, orders them by selectivity
+    // and picks the access path with the lowest estimated cost.
+    QueryPlan plan(const QueryRequest& request) const;
+
+    // Runs 'plan'. The returned order holds at least the first page; when a cursor was requested it
+    // holds every match.
+    PartialOrder execute(const QueryPlan& plan, QueryExecution& execution) const;
+
+    // Human readable plan for the EXPLAIN prefix
+    std::string explain(const QueryPlan& plan, const QueryExecution& execution) const;
+
+    // When set (slots in lockstep with the record store), unindexed ranges that have no bitmap
+    // to narrow them are scanned over its columns instead of the packed records.
+    void setColumnStore(const ColumnStore* store) { columns = store; }
+
+private:
+    const RecordStore& store;
+    const CategoricalIndexes& categorical;
+    const SortedIndexes& sorted;
+    const ColumnStore* columns = nullptr;
+};
+
+#endif // QUERYPLANNER_H
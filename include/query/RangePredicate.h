@@ -0,0 +1,42 @@
+// Range filters over the numeric fields of Data.
+
+#ifndef RANGEPREDICATE_H
+#define RANGEPREDICATE_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "data_fields.h"
+#include "query/Bitmap.h"
+#include "query/RecordStore.h"
+#include "query/SortedIndex.h"
+
+// Closed interval over one numeric field. Exclusive and open bounds are normalized at parse time
+// (x > 5 becomes x >= nextafter(5)), so evaluation is always low <= value <= high.
+struct RangePredicate {
+    const NumericField* field;
+    double low;
+    double high;
+};
+
+// Extracts the numeric filters from the parsed query parameters: "f>x", "f>=x", "f<x", "f<=x",
+// "f=x" and "f=x..y" (between, inclusive). Terms on the same field are merged into one range.
+// Returns false and fills 'error' on a bad value.
+bool parse_range_predicates(const std::map<std::string, std::string>& params,
+                            std::vector<RangePredicate>& predicates, std::string& error);
+
+bool range_matches(const Data* d, const RangePredicate& predicate);
+
+// "sbytes in [1000001, inf]"
+std::string describe_range(const RangePredicate& predicate);
+
+// True if the field of 'predicate' has a sorted index to serve it.
+bool range_has_index(const RangePredicate& predicate);
+
+// Slots of the live records that satisfy 'predicate'. Uses the sorted index of the field when there
+// is one and a block scan over the record store otherwise. 'rows_examined' counts entries/rows read.
+Bitmap evaluate_range(const RangePredicate& predicate, const RecordStore& store,
+                      const SortedIndexes& sorted, size_t& rows_examined);
+
+#endif // RANGEPREDICATE_H
@@ -0,0 +1,39 @@
+// Owner of every live record, addressed by ingest slot.
+
+#ifndef RECORDSTORE_H
+#define RECORDSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include "data.h"
+
+// Records get consecutive slots in ingest order and are evicted oldest first, so the live
+// records always occupy the slot range [firstSlot(), endSlot()). The data structures and
+// indexes keep raw pointers to these records; the pointers stay valid until eviction.
+class RecordStore {
+public:
+    // Copies 'record' into the store and returns its slot.
+    uint32_t append(const Data& record);
+
+    // Evicts the 'n' oldest records. Returns how many were evicted.
+    size_t evictOldest(size_t n);
+
+    // Returns the record in 'slot', or nullptr if it was evicted or not assigned yet.
+    const Data* at(uint32_t slot) const;
+
+    // i-th oldest live record (0 = oldest)
+    const Data* operator[](size_t i) const { return records[i].get(); }
+
+    uint32_t firstSlot() const { return first_slot; }
+    uint32_t endSlot() const { return first_slot + static_cast<uint32_t>(records.size()); }
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+private:
+    std::deque<std::unique_ptr<Data>> records;
+    uint32_t first_slot = 0;
+};
+
+#endif // RECORDSTORE_H
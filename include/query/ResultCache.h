@@ -0,0 +1,84 @@
+// Bounded LRU cache of formatted replies for the read-only commands.
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+// Version of the data a reply was computed from. 'batches' counts the ingested batches and
+// 'first_live_slot' is the eviction watermark of the record store; any change to either can
+// change the result of a query.
+struct CacheEpoch {
+    uint64_t batches = 0;
+    uint32_t first_live_slot = 0;
+
+    bool operator==(const CacheEpoch& other) const {
+        return batches == other.batches && first_live_slot == other.first_live_slot;
+    }
+    bool operator!=(const CacheEpoch& other) const { return !(*this == other); }
+};
+
+struct CacheStats {
+    uint64_t hits = 0;          // Served from an entry of the current epoch
+    uint64_t stale_hits = 0;    // Served from an older epoch, within the command's tolerance
+    uint64_t misses = 0;
+    uint64_t invalidations = 0; // Entries dropped because they were too stale
+    uint64_t evictions = 0;     // Entries dropped by the LRU bound
+};
+
+class ResultCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ResultCache(size_t max_entries = 256, size_t max_bytes = 8 * 1024 * 1024);
+
+    // How old (in wall time) a reply of 'command' may be and still be served after the epoch moved on.
+    // Commands without a tolerance are only served for the exact epoch they were computed at.
+    void setTolerance(const std::string& command, std::chrono::milliseconds max_age);
+
+    // Returns true and fills 'reply' if 'key' is cached for 'epoch', or for an older epoch
+    // within the tolerance of 'command'. Stale entries outside the tolerance are dropped.
+    bool lookup(const std::string& command, const std::string& key, const CacheEpoch& epoch,
+                std::string& reply, Clock::time_point now = Clock::now());
+
+    void store(const std::string& key, const CacheEpoch& epoch, const std::string& reply,
+               Clock::time_point now = Clock::now());
+
+    // Drops every entry. Used when the data changes outside of ingest/eviction (REMOVE_DATA_BY_ID).
+    void invalidateAll();
+
+    size_t size() const { return index.size(); }
+    size_t bytes() const { return total_bytes; }
+    const CacheStats& stats() const { return counters; }
+    std::string describe() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::string reply;
+        CacheEpoch epoch;
+        Clock::time_point computed_at;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+
+    std::list<Entry> lru; // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::map<std::string, std::chrono::milliseconds> tolerances;
+    size_t max_entries;
+    size_t max_bytes;
+    size_t total_bytes = 0;
+    CacheStats counters;
+};
+
+// Canonical cache key for a command and its parsed parameters: parameters are ordered by key,
+// so "a=1 b=2" and "b=2  a=1" share an entry.
+std::string normalize_request(const std::string& command, const std::map<std::string, std::string>& params);
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,155 @@
+// Ordered secondary indexes over the sort keys offered by QUERY_FILTERED_SORTED.
+
+#ifndef SORTEDINDEX_H
+#define SORTEDINDEX_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <map>
+#include <string>
+#include <utility>
+#include "data.h"
+#include "data_fields.h"   // For NumericField
+#include "query/QueryCursor.h" // For PartialOrder::Comparator
+
+// Sort keys accepted by the "sort_by" query parameter
+enum class SortField : uint8_t {
+    ID = 0,
+    DUR,
+    RATE,
+    SBYTES,
+    DBYTES
+};
+
+// Resolves a "sort_by" value once per query. Unknown names fall back to ID, like the old comparator did.
+SortField parse_sort_field(const std::string& name);
+
+// Strict lookup: returns false if 'name' has no sorted index.
+bool find_sort_field(const std::string& name, SortField& field);
+
+const char* sort_field_name(SortField field);
+
+// Builds a comparator for 'field' with the field dispatch done here, outside of the comparisons.
+PartialOrder::Comparator make_sort_comparator(SortField field, bool ascending);
+// Same, for any numeric field; the comparator is instantiated for the field's storage type.
+PartialOrder::Comparator make_field_comparator(const NumericField& field, bool ascending);
+
+struct IndexEntry {
+    const Data* record;
+    uint32_t slot; // RecordStore slot, so range scans can produce bitmaps
+};
+
+// Largest key that is <= 'value', used to position a range scan.
+template <typename Key>
+Key floor_key(double value) {
+    if constexpr (std::is_floating_point<Key>::value) {
+        Key key = static_cast<Key>(value);
+        if (static_cast<double>(key) > value) key = std::nextafter(key, -std::numeric_limits<Key>::infinity());
+        return key;
+    } else {
+        if (!(value > 0.0)) return 0;
+        if (value >= static_cast<double>(std::numeric_limits<Key>::max())) return std::numeric_limits<Key>::max();
+        return static_cast<Key>(std::floor(value));
+    }
+}
+
+// Ordered index of one field. Entries are keyed by (value, id) so ties have a stable order
+// and removal only has to look at the entries of a single record.
+template <typename Key>
+class FieldIndex {
+public:
+    using Extractor = Key (*)(const Data*);
+
+    explicit FieldIndex(Extractor extract) : extract(extract) {}
+
+    void insert(const Data* d, uint32_t slot) {
+        entries.emplace(std::make_pair(extract(d), d->id), IndexEntry{d, slot});
+    }
+
+    bool remove(const Data* d) {
+        auto range = entries.equal_range(std::make_pair(extract(d), d->id));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second.record == d) {
+                entries.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Visits the records in key order until 'visit' returns false.
+    template <typename Visitor>
+    void walk(bool ascending, Visitor&& visit) const {
+        if (ascending) {
+            for (auto it = entries.begin(); it != entries.end(); ++it)
+                if (!visit(it->second.record)) return;
+        } else {
+            for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+                if (!visit(it->second.record)) return;
+        }
+    }
+
+    // Visits every entry with low <= value <= high, in ascending order.
+    template <typename Visitor>
+    void walkRange(double low, double high, Visitor&& visit) const {
+        for (auto it = entries.lower_bound(std::make_pair(floor_key<Key>(low), 0u)); it != entries.end(); ++it) {
+            double key = static_cast<double>(it->first.first);
+            if (key > high) return;
+            if (key >= low) visit(it->second);
+        }
+    }
+
+    void clear() { entries.clear(); }
+    size_t size() const { return entries.size(); }
+
+private:
+    Extractor extract;
+    std::multimap<std::pair<Key, uint32_t>, IndexEntry> entries;
+};
+
+// The indexes for every SortField, kept up to date on insert and evict.
+class SortedIndexes {
+public:
+    SortedIndexes();
+
+    void insert(const Data* d, uint32_t slot);
+    void remove(const Data* d);
+    void clear();
+    size_t size() const { return by_id.size(); }
+
+    // Visits the records ordered by 'field' until 'visit' returns false.
+    template <typename Visitor>
+    void walk(SortField field, bool ascending, Visitor&& visit) const {
+        switch (field) {
+            case SortField::DUR: by_dur.walk(ascending, visit); break;
+            case SortField::RATE: by_rate.walk(ascending, visit); break;
+            case SortField::SBYTES: by_sbytes.walk(ascending, visit); break;
+            case SortField::DBYTES: by_dbytes.walk(ascending, visit); break;
+            default: by_id.walk(ascending, visit); break;
+        }
+    }
+
+    // Visits the entries whose 'field' lies in [low, high], in ascending order.
+    template <typename Visitor>
+    void walkRange(SortField field, double low, double high, Visitor&& visit) const {
+        switch (field) {
+            case SortField::DUR: by_dur.walkRange(low, high, visit); break;
+            case SortField::RATE: by_rate.walkRange(low, high, visit); break;
+            case SortField::SBYTES: by_sbytes.walkRange(low, high, visit); break;
+            case SortField::DBYTES: by_dbytes.walkRange(low, high, visit); break;
+            default: by_id.walkRange(low, high, visit); break;
+        }
+    }
+
+private:
+    FieldIndex<uint32_t> by_id;
+    FieldIndex<float> by_dur;
+    FieldIndex<float> by_rate;
+    FieldIndex<uint32_t> by_sbytes;
+    FieldIndex<uint32_t> by_dbytes;
+};
+
+#endif // SORTEDINDEX_H
@@ -0,0 +1,78 @@
+// Continuous queries: filters and aggregates registered once and evaluated on every ingested batch.
+
+#ifndef SUBSCRIPTION_H
+#define SUBSCRIPTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "data_fields.h"
+#include "query/CategoricalIndex.h"
+#include "query/RangePredicate.h"
+#include "query/RecordStore.h"
+
+enum class SubscriptionKind { FILTER, STATS };
+
+// Running aggregate of one numeric field (Welford), updated with each matching record.
+struct RunningStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double value);
+    double stdDev() const;
+};
+
+struct Subscription {
+    uint32_t id;
+    SubscriptionKind kind;
+    std::string topic;                 // "sub.<id>.", never a prefix of another subscription's topic
+    std::vector<CategoricalPredicate> predicates;
+    std::vector<RangePredicate> ranges;
+    size_t max_rows;                   // FILTER: rows per published delta
+    const NumericField* field;         // STATS: aggregated field
+    RunningStats stats;                // STATS: since the subscription was created
+    uint64_t published = 0;            // Messages published so far
+};
+
+// One message for the PUB socket. FILTER deltas carry the new matching rows (valid until the next
+// eviction); STATS refreshes carry only the header.
+struct Publication {
+    std::string topic;
+    std::string header;
+    std::vector<const Data*> rows;
+};
+
+class SubscriptionManager {
+public:
+    explicit SubscriptionManager(size_t max_subscriptions = 64, const std::string& topic_prefix = "sub.");
+
+    // Registers a subscription from the parsed parameters of "SUBSCRIBE FILTER ..." or
+    // "SUBSCRIBE STATS ...". FILTER accepts the QUERY_FILTERED_SORTED filters plus limit=<rows>;
+    // STATS additionally needs field=<numeric field>. Returns 0 and fills 'error' on failure.
+    uint32_t subscribe(SubscriptionKind kind, const std::map<std::string, std::string>& params, std::string& error);
+
+    bool unsubscribe(uint32_t id);
+
+    // Evaluates every subscription against the records in slots [first_slot, end_slot) of 'store'
+    // (the batch just ingested) and appends one publication per subscription that has news.
+    void onBatch(const RecordStore& store, uint32_t first_slot, uint32_t end_slot, std::vector<Publication>& out);
+
+    const Subscription* find(uint32_t id) const;
+    size_t size() const { return subscriptions.size(); }
+    std::string describe() const;
+
+private:
+    std::map<uint32_t, Subscription> subscriptions;
+    uint32_t next_id = 1;
+    size_t max_subscriptions;
+    std::string topic_prefix;
+};
+
+#endif // SUBSCRIPTION_H
@@ -0,0 +1,104 @@
+// Lock-free latency histograms for the request handlers of the REP server.
+
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// HDR-style log-linear histogram of nanosecond values. Values below 2^(SUB_BUCKET_BITS + 1) get one
+// bucket each; above that, every power of two is split into 2^SUB_BUCKET_BITS equal buckets, so a
+// recorded value is known to within ~6% up to 2^MAX_EXPONENT ns (~18 minutes).
+// Recording is a relaxed atomic increment, so any thread may record or read at any time.
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr unsigned MAX_EXPONENT = 40;
+    static constexpr size_t BUCKET_COUNT = 2 * SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS - 1) * SUB_BUCKETS;
+
+    void record(uint64_t nanoseconds);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Value at quantile q in [0, 1] (midpoint of the bucket that holds it), 0 if empty.
+    uint64_t percentile(double q) const;
+
+    void reset();
+
+    static size_t bucketOf(uint64_t nanoseconds);
+    static uint64_t bucketLow(size_t bucket);
+    static uint64_t bucketHigh(size_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maximum{0};
+};
+
+// Phases of one request. QUEUE_WAIT is the time the main loop spent since its previous poll of
+// the REP socket, an upper bound of how long the request sat in the queue. TOTAL runs from
+// receipt to the reply being sent (queue wait excluded).
+enum class RequestPhase : uint8_t { QUEUE_WAIT = 0, PARSE, EXECUTE, FORMAT, TOTAL };
+const size_t REQUEST_PHASE_COUNT = 5;
+const char* request_phase_name(RequestPhase phase);
+
+// Histograms per (command, ds_id, phase). Commands are registered up front, so the lookup on the
+// recording path is read-only; unregistered commands are recorded under "OTHER".
+class ServerStats {
+public:
+    static const int MAX_DS_ID = 8;
+
+    explicit ServerStats(const std::vector<std::string>& commands);
+
+    // ds_id 0 means "not structure specific"; out of range ids are folded into 0.
+    void record(const std::string& command, int ds_id, RequestPhase phase, uint64_t nanoseconds);
+
+    const LatencyHistogram* find(const std::string& command, int ds_id, RequestPhase phase) const;
+
+    // Table of count and p50/p90/p99/p999/max (in microseconds) for every series with samples.
+    std::string describe() const;
+    void reset();
+
+private:
+    size_t commandIndex(const std::string& command) const;
+    LatencyHistogram& histogram(size_t command, int ds_id, RequestPhase phase) const;
+
+    std::vector<std::string> commands; // Last entry is "OTHER"
+    std::unique_ptr<LatencyHistogram[]> histograms;
+};
+
+// Splits the handling of one request into phases: the handler calls enter() when it moves on to
+// the next phase, and finish() records every phase plus the total.
+class RequestTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RequestTimer(ServerStats& stats, Clock::time_point received, Clock::duration queue_wait);
+
+    void setCommand(const std::string& command) { this->command = command; }
+    void setDsId(int ds_id) { this->ds_id = ds_id; }
+    void enter(RequestPhase phase);
+    void finish();
+
+private:
+    ServerStats& stats;
+    std::string command;
+    int ds_id = 0;
+    Clock::time_point received;
+    Clock::time_point phase_start;
+    RequestPhase phase = RequestPhase::PARSE;
+    uint64_t elapsed[REQUEST_PHASE_COUNT] = {0, 0, 0, 0, 0};
+    bool finished = false;
+};
+
+#endif // LATENCYSTATS_H
@@ -0,0 +1,106 @@
+// Reply formatting into pooled buffers with std::to_chars, in text, JSON or CSV.
+
+#ifndef RESPONSEFORMATTER_H
+#define RESPONSEFORMATTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "data.h"
+
+// Growable byte buffer; numbers are written with std::to_chars, so no locale and no temporaries.
+class ResponseBuffer {
+public:
+    explicit ResponseBuffer(size_t initial_capacity = 16 * 1024);
+
+    void clear() { length = 0; }
+    char* data() { return storage.get(); }
+    const char* data() const { return storage.get(); }
+    size_t size() const { return length; }
+    size_t capacity() const { return allocated; }
+    bool empty() const { return length == 0; }
+    std::string str() const { return std::string(storage.get(), length); }
+
+    void append(const char* text, size_t n);
+    void append(const std::string& text) { append(text.data(), text.size()); }
+    void append(const char* text);
+    void append(char c);
+    void appendUInt(uint64_t value);
+    // Fixed notation with 'precision' decimals, same digits as std::fixed << std::setprecision(precision)
+    void appendFixed(double value, int precision);
+
+private:
+    char* reserve(size_t n); // Room for n more bytes; returns the write position
+
+    std::unique_ptr<char[]> storage;
+    size_t allocated;
+    size_t length = 0;
+};
+
+struct PooledBufferDeleter {
+    void operator()(ResponseBuffer* buffer) const;
+};
+using PooledBuffer = std::unique_ptr<ResponseBuffer, PooledBufferDeleter>;
+
+// Buffers are recycled instead of freed. A reply sent zero-copy hands its buffer to ZMQ, which
+// gives it back through zmqFree() from its I/O thread once the bytes are on the wire.
+class BufferPool {
+public:
+    static BufferPool& instance();
+
+    // An empty buffer that goes back to the pool when the handle is dropped
+    PooledBuffer acquire();
+    void release(ResponseBuffer* buffer);
+
+    // zmq_free_fn for zmq::message_t(data, size, BufferPool::zmqFree, buffer)
+    static void zmqFree(void* data, void* hint);
+
+    size_t idle() const;
+
+private:
+    BufferPool() = default;
+
+    static const size_t MAX_IDLE_BUFFERS = 16;
+    static const size_t MAX_POOLED_CAPACITY = 4 * 1024 * 1024; // Larger buffers are freed, not kept
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ResponseBuffer>> free_buffers;
+};
+
+enum class OutputFormat { TEXT, JSON, CSV };
+
+// "text", "json" or "csv"; returns false for anything else.
+bool parse_output_format(const std::string& name, OutputFormat& format);
+
+// "ID: 7, Dur: 1.25s, SBytes: ..., Label: Attack" (the one-line summary of the text replies)
+void append_record_summary(ResponseBuffer& out, const Data& d);
+
+// Multi-line detail view used by QUERY_DATA_BY_ID
+void append_record_table(ResponseBuffer& out, const Data& d);
+
+// Position of a page of rows within a query result, for the JSON and CSV headers.
+struct PageInfo {
+    size_t matches;         // Total matches of the query
+    size_t first_row_number;
+    size_t remaining;       // Rows left behind a cursor
+    uint32_t cursor_id;     // 0 when no cursor is open
+};
+
+// Opens a page. TEXT writes 'text_header' as is; JSON writes {"matches":..,..,"rows":[ (or a
+// complete header object when 'streamed', the rows following as separate arrays); CSV writes a
+// "# ..." summary line and the column names.
+void append_page_header(ResponseBuffer& out, OutputFormat format, const PageInfo& page,
+                        const std::string& text_header, bool streamed);
+
+// 'count' rows numbered from 'first_row_number'. In JSON, 'standalone' wraps them in their own
+// array (a streamed frame) instead of continuing the array opened by the header.
+void append_rows(ResponseBuffer& out, OutputFormat format, const Data* const* rows, size_t count,
+                 size_t first_row_number, bool standalone);
+
+// Closes what append_page_header opened (JSON: "]}").
+void append_page_footer(ResponseBuffer& out, OutputFormat format, bool streamed);
+
+#endif // RESPONSEFORMATTER_H
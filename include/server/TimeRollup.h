@@ -0,0 +1,63 @@
+// Per-second / per-minute rollups of the ingested batches, for dashboards that chart the stream
+// without rescanning the records.
+
+#ifndef TIMEROLLUP_H
+#define TIMEROLLUP_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "data.h"
+
+const size_t ATTACK_CATEGORY_COUNT = 10; // Attack_cat::NORMAL .. Attack_cat::GENERIC
+
+// Sum, sum of squares, min and max of one feature in one bucket. Sums are of (value - shift), the
+// shift being the first value the bucket saw, as in the other running aggregates.
+struct RollupFeature {
+    float shift = 0.0f;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    float min = 0.0f;
+    float max = 0.0f;
+
+    double mean(uint64_t count) const { return count ? shift + sum / count : 0.0; }
+    double variance(uint64_t count) const;
+    double stddev(uint64_t count) const { return std::sqrt(variance(count)); }
+};
+
+// Everything ingested during [index * resolution, (index + 1) * resolution)
+struct RollupBucket {
+    int64_t index = -1; // -1 while the slot has never been used
+    uint64_t count = 0;
+    std::array<RollupFeature, STATISTIC_FEATURE_COUNT> features; // Indexed by StatisticFeature
+    std::array<uint32_t, 2> labels{};                              // Normal, attack
+    std::array<uint32_t, ATTACK_CATEGORY_COUNT> attack_categories{};
+
+    int64_t startMs(int64_t resolution_ms) const { return index * resolution_ms; }
+};
+
+// Fixed ring of 'capacity' buckets of 'resolution_ms' each. A batch is stamped with its ingest
+// time and folded into a single bucket with the reduction kernels; a bucket is recycled once the
+// ring has wrapped around past it. Batches older than the ring are dropped.
+class TimeRollup {
+public:
+    TimeRollup(int64_t resolution_ms, size_t capacity);
+
+    void addBatch(const Data* records, size_t n, int64_t timestamp_ms);
+
+    // Non-empty buckets overlapping [from_ms, to_ms] that are still in the ring, oldest first
+    std::vector<const RollupBucket*> series(int64_t from_ms, int64_t to_ms) const;
+
+    int64_t resolutionMs() const { return resolution_ms; }
+    size_t capacity() const { return ring.size(); }
+    size_t getMemoryUsage() const { return sizeof(*this) + ring.size() * sizeof(RollupBucket); }
+
+private:
+    int64_t resolution_ms;
+    int64_t latest_index = -1;
+    std::vector<RollupBucket> ring;
+};
+
+#endif // TIMEROLLUP_H
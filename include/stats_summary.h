@@ -0,0 +1,114 @@
+// Count, mean, variance, min, max and median of one feature, gathered in a single traversal
+
+#ifndef STATS_SUMMARY_H
+#define STATS_SUMMARY_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "data.h"
+#include "data_fields.h"
+
+struct StatsSummary {
+    size_t count = 0;
+    double mean = 0.0;
+    double variance = 0.0; // Population variance, as getStdDev reports
+    float min = 0.0f;
+    float max = 0.0f;
+    float median = 0.0f;
+
+    double stddev() const { return std::sqrt(variance); }
+};
+
+using StatsSummaryRow = std::array<StatsSummary, STATISTIC_FEATURE_COUNT>; // Indexed by StatisticFeature
+
+// "dur", "rate", ..., "dbytes"
+const char* statistic_feature_name(StatisticFeature feature);
+
+// Count, mean, sum of squared deviations (M2), min and max of a column. Partial results of
+// separate chunks combine with merge() (Chan et al.'s parallel form of Welford's update).
+struct Moments {
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    float min = 0.0f;
+    float max = 0.0f;
+
+    void merge(const Moments& other);
+    double variance() const { return count ? m2 / count : 0.0; } // Population variance
+};
+
+// Moments of values[0, n). Each chunk is reduced in two passes of the vector kernels (the second
+// shifted by the chunk's mean); from PARALLEL_MIN_CHUNK values per thread on, the chunks run on
+// the shared ThreadPool.
+Moments compute_moments(const float* values, size_t n);
+
+// Median of values[0, n) in linear time: the middle value, or the mean of the two middle values
+// (what sorting would give). Reorders the values; 0 when n is 0.
+float select_median(float* values, size_t n);
+
+// Takes the values of one traversal into a contiguous column. finish() takes its moments with
+// compute_moments() and selects the median in linear time.
+class SummaryBuilder {
+public:
+    explicit SummaryBuilder(size_t expected_count = 0) { values.reserve(expected_count); }
+
+    void add(float value) { values.push_back(value); }
+    // Appends 'field' of every row, resolving the field type once for the whole column. Long
+    // columns are gathered in parallel chunks, the rows being scattered in memory.
+    void addField(const Data* const* rows, size_t n, const NumericField& field);
+
+    // Reorders the collected values; call once.
+    StatsSummary finish();
+
+private:
+    std::vector<float> values;
+};
+
+// Count, mean, variance, min and max of one group, accumulated one value at a time. Sums are of
+// (value - first value of the group), so that large byte counts do not cancel out.
+struct GroupSummary {
+    size_t count = 0;
+    float shift = 0.0f;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    float min = 0.0f;
+    float max = 0.0f;
+
+    void add(float value) {
+        if (count == 0) shift = min = max = value;
+        double centered = static_cast<double>(value) - shift;
+        ++count;
+        sum += centered;
+        sum_squares += centered * centered;
+        if (value < min) min = value;
+        if (value > max) max = value;
+    }
+    double mean() const { return count ? shift + sum / count : 0.0; }
+    double variance() const {
+        if (count == 0) return 0.0;
+        double centered_mean = sum / count;
+        return std::max(0.0, sum_squares / count - centered_mean * centered_mean);
+    }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+// Indexed by the value of a one-byte categorical field (proto, state, service, attack_cat, label)
+using GroupSummaries = std::array<GroupSummary, 256>;
+
+// One pass over 'rows': each value of 'field' goes to the group named by the byte at 'group_offset'.
+// Both fields are resolved once; the loop is instantiated for the field's storage type.
+inline void summarize_groups(const Data* const* rows, size_t n, size_t group_offset, const NumericField& field,
+                             GroupSummaries& groups) {
+    visit_field_type(field.type, [&](auto tag) {
+        using T = decltype(tag);
+        const size_t offset = field.offset;
+        for (size_t i = 0; i < n; ++i) {
+            groups[read_field<uint8_t>(rows[i], group_offset)].add(static_cast<float>(read_field<T>(rows[i], offset)));
+        }
+    });
+}
+
+#endif // STATS_SUMMARY_H
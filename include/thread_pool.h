@@ -0,0 +1,71 @@
+// Shared worker threads for splitting large statistics computations into chunks.
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers fed from one queue. run() hands out task indices through a shared counter
+// and the calling thread works on them too, so a run() issued from inside a task cannot deadlock
+// and a pool without workers simply runs everything on the caller.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t workers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Shared pool: STATS_THREADS threads in total if set, else one per CPU the process may use:
+    // the hardware threads, capped by a cgroup CPU quota (a container with cpus: '0.5' runs
+    // serially). The caller counts as one.
+    static ThreadPool& instance();
+
+    // Threads that work on a run(), the caller included
+    size_t concurrency() const { return workers.size() + 1; }
+
+    // Calls fn(i) for every i in [0, tasks) and returns once all calls have returned.
+    void run(size_t tasks, const std::function<void(size_t)>& fn);
+
+private:
+    void work();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable available;
+    bool stopping = false;
+};
+
+// Below this many values a computation stays on the calling thread: splitting costs more than it saves.
+const size_t PARALLEL_MIN_CHUNK = 16384;
+
+// Number of chunks to split n items into: at most one per thread of the shared pool, each of
+// at least 'min_chunk' items. 1 means serial.
+inline size_t chunk_count(size_t n, size_t min_chunk = PARALLEL_MIN_CHUNK) {
+    size_t chunks = std::min(ThreadPool::instance().concurrency(), n / std::max<size_t>(min_chunk, 1));
+    return std::max<size_t>(chunks, 1);
+}
+
+// Calls fn(chunk, begin, end) for each of 'chunks' contiguous parts of [0, n), in parallel on the
+// shared pool when there is more than one. Callers size their per-chunk partial results with
+// chunk_count() first and merge them afterwards.
+template <typename Fn>
+void parallel_chunks(size_t n, size_t chunks, Fn&& fn) {
+    if (chunks <= 1) {
+        fn(size_t(0), size_t(0), n);
+        return;
+    }
+    ThreadPool::instance().run(chunks, [&](size_t chunk) {
+        fn(chunk, n * chunk / chunks, n * (chunk + 1) / chunks);
+    });
+}
+
+#endif // THREAD_POOL_H
@@ -4,6 +4,7 @@
 #include "data.h"
 #include <algorithm>
 #include <iostream>
+#include "prefetch.h" // For prefetch_read, PREFETCH_GROUP_SIZE
 
 size_t AVL::getMemoryUsage() const {
     return getMemoryUsageRecursive(_root);
@@ -221,6 +222,42 @@ void AVL::printPreOrderHierarchicalRecursive(Node_AVL* node, int depth, int inde
 
 
 
+void AVL::findMany(const uint32_t* ids, size_t count, const Data** out) const {
+    Node_AVL* cursor[PREFETCH_GROUP_SIZE];
+    for (size_t base = 0; base < count; base += PREFETCH_GROUP_SIZE) {
+        size_t group = std::min(PREFETCH_GROUP_SIZE, count - base);
+        for (size_t i = 0; i < group; ++i) {
+            cursor[i] = _root;
+            out[base + i] = nullptr;
+        }
+
+        bool active = _root != nullptr;
+        while (active) {
+            active = false;
+            // One level per round: compare, step down and prefetch the child
+            for (size_t i = 0; i < group; ++i) {
+                Node_AVL* node = cursor[i];
+                if (!node) continue;
+                uint32_t key = node->data->id;
+                if (key == ids[base + i]) {
+                    out[base + i] = node->data;
+                    cursor[i] = nullptr;
+                    continue;
+                }
+                cursor[i] = key > ids[base + i] ? node->left : node->right;
+                if (cursor[i]) {
+                    prefetch_read(cursor[i]);
+                    active = true;
+                }
+            }
+            // The ids live in the records, so they are the second miss of every level
+            for (size_t i = 0; i < group; ++i) {
+                if (cursor[i]) prefetch_read(cursor[i]->data);
+            }
+        }
+    }
+}
+
 AVL::Node_AVL* AVL::queryById(uint32_t id){
     Node_AVL* temp = _root;
     while(temp != nullptr && temp->data->id != id){
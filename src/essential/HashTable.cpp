@@ -3,6 +3,8 @@
 #include "essential/HashTable.h" // Correct header for THIS HashTable.cpp
 #include <iostream> // For potential debug/error output
 #include <functional> // For std::hash
+#include <algorithm>  // For std::min
+#include "prefetch.h" // For prefetch_read, PREFETCH_GROUP_SIZE
 
 HashTable::HashTable(size_t capacidade)
     : table(capacidade), itemCount(0) {}
@@ -74,6 +76,38 @@ bool HashTable::remove(uint32_t id) {
     return false;
 }
 
+void HashTable::findMany(const uint32_t* ids, size_t count, const Data** out) const {
+    size_t buckets[PREFETCH_GROUP_SIZE];
+    for (size_t base = 0; base < count; base += PREFETCH_GROUP_SIZE) {
+        size_t group = std::min(PREFETCH_GROUP_SIZE, count - base);
+        // Stage 1: bucket headers
+        for (size_t i = 0; i < group; ++i) {
+            buckets[i] = hash(ids[base + i]);
+            prefetch_read(&table[buckets[i]]);
+        }
+        // Stage 2: first node of each chain
+        for (size_t i = 0; i < group; ++i) {
+            const std::list<Node>& chain = table[buckets[i]];
+            if (!chain.empty()) prefetch_read(&chain.front());
+        }
+        // Stage 3: the record the first node points to, whose id is compared
+        for (size_t i = 0; i < group; ++i) {
+            const std::list<Node>& chain = table[buckets[i]];
+            if (!chain.empty() && chain.front().data) prefetch_read(chain.front().data);
+        }
+        // Stage 4: resolve; longer chains are walked without prefetching
+        for (size_t i = 0; i < group; ++i) {
+            out[base + i] = nullptr;
+            for (const auto& node : table[buckets[i]]) {
+                if (node.data && node.data->id == ids[base + i]) {
+                    out[base + i] = node.data;
+                    break;
+                }
+            }
+        }
+    }
+}
+
 const Data* HashTable::find(uint32_t id) const {
     size_t idx = hash(id);
     for (const auto &node : table[idx]) {
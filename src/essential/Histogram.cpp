@@ -0,0 +1,79 @@
+#include "essential/Histogram.h"
+#include <algorithm> // For std::min
+#include <cmath>     // For std::ldexp
+#include <cstring>   // For memcpy
+#include <limits>    // For infinity
+#include "kernels.h" // For reduce, histogram
+
+namespace {
+const float MIN_VALUE = std::ldexp(1.0f, LogHistogram::MIN_EXPONENT);
+const float MAX_VALUE = std::ldexp(1.0f, LogHistogram::MAX_EXPONENT);
+}
+
+void LogHistogram::clear() {
+    counts.fill(0);
+    total = 0;
+}
+
+size_t LogHistogram::bucketOf(float value) {
+    if (!(value >= MIN_VALUE)) return 0;
+    if (value >= MAX_VALUE) return BUCKET_COUNT - 1;
+    // Exponent and top mantissa bits of the (normal, positive) float
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    size_t sub = (bits >> (23 - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return 1 + static_cast<size_t>(exponent - MIN_EXPONENT) * SUB_BUCKETS + sub;
+}
+
+double LogHistogram::bucketLow(size_t bucket) {
+    if (bucket == 0) return 0.0;
+    size_t position = bucket - 1;
+    int exponent = MIN_EXPONENT + static_cast<int>(position / SUB_BUCKETS);
+    return std::ldexp(1.0 + static_cast<double>(position % SUB_BUCKETS) / SUB_BUCKETS, exponent);
+}
+
+double LogHistogram::bucketHigh(size_t bucket) {
+    if (bucket + 1 >= BUCKET_COUNT) return std::numeric_limits<double>::infinity();
+    return bucketLow(bucket + 1);
+}
+
+std::vector<HistogramBin> LogHistogram::bins(size_t bins) const {
+    std::vector<HistogramBin> result;
+    if (total == 0 || bins == 0) return result;
+    size_t first = 0, last = BUCKET_COUNT - 1;
+    while (counts[first] == 0) ++first;
+    while (counts[last] == 0) --last;
+    size_t per_bin = (last - first + bins) / bins; // ceil((last - first + 1) / bins)
+    for (size_t start = first; start <= last; start += per_bin) {
+        size_t end = std::min(start + per_bin - 1, last);
+        HistogramBin bin{bucketLow(start), bucketHigh(end), 0};
+        for (size_t b = start; b <= end; ++b) bin.count += counts[b];
+        result.push_back(bin);
+    }
+    return result;
+}
+
+std::vector<HistogramBin> linear_histogram(const float* values, size_t n, size_t bins) {
+    std::vector<HistogramBin> result;
+    if (n == 0 || bins == 0) return result;
+    Reduction range = reduce(values, n);
+    if (!(range.max > range.min)) {
+        result.push_back(HistogramBin{range.min, range.max, n});
+        return result;
+    }
+    std::vector<uint64_t> counts(bins, 0);
+    histogram(values, n, range.min, range.max, counts.data(), bins);
+    double width = (static_cast<double>(range.max) - range.min) / bins;
+    for (size_t b = 0; b < bins; ++b) {
+        double high = (b + 1 == bins) ? range.max : range.min + width * (b + 1);
+        result.push_back(HistogramBin{range.min + width * b, high, counts[b]});
+    }
+    return result;
+}
+
+std::vector<HistogramBin> log_histogram(const float* values, size_t n, size_t bins) {
+    LogHistogram counts;
+    for (size_t i = 0; i < n; ++i) counts.add(values[i]);
+    return counts.bins(bins);
+}
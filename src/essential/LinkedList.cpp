@@ -5,15 +5,23 @@
 #include <algorithm>
 #include <iostream> // For print and potential debug output
 #include <vector>   // For median, and temporary storage for interval calculations
-#include <numeric>  // For std::accumulate
+#include <unordered_map> // For the pending ids of findMany
+#include "prefetch.h" // For prefetch_read
 
-DoublyLinkedList::Node::Node(const Data* d) : data(d), prev(nullptr), next(nullptr) {}
+DoublyLinkedList::Node::Node(const Data* d) : data(d), prev(nullptr), next(nullptr), seq(0) {}
 
-DoublyLinkedList::DoublyLinkedList() : head(nullptr), tail(nullptr), count(0) {}
+DoublyLinkedList::DoublyLinkedList() : head(nullptr), tail(nullptr), count(0), next_seq(0) {}
 
 size_t DoublyLinkedList::getMemoryUsage() const {
     // Memory for each node is a const Data* pointer + 2 node pointers (prev, next)
-    return size() * (sizeof(Node)); 
+    size_t usage = size() * (sizeof(Node));
+    for (const Window& window : windows) {
+        for (const SlidingAggregate& feature : window.features) usage += feature.getMemoryUsage();
+    }
+    for (const QuantileBucket& bucket : quantile_buckets) usage += sizeof(Node*) + bucket.sketches.getMemoryUsage();
+    for (const OrderStatisticList& list : order_statistics) usage += list.getMemoryUsage();
+    for (const LogHistogram& histogram : histograms) usage += histogram.getMemoryUsage();
+    return usage;
 }
 
 DoublyLinkedList::~DoublyLinkedList() {
@@ -33,6 +41,7 @@ DoublyLinkedList::~DoublyLinkedList() {
 
 void DoublyLinkedList::append(const Data* d) {
     Node* newNode = new Node(d);
+    newNode->seq = next_seq++;
     if (!head) {
         head = tail = newNode;
     } else {
@@ -41,6 +50,11 @@ void DoublyLinkedList::append(const Data* d) {
         tail = newNode;
     }
     count++;
+    const StatisticFeatureValues values = statistic_feature_values(d); // Read once for every structure below
+    for (Window& window : windows) windowAppend(window, newNode, values);
+    quantileAppend(newNode);
+    for (size_t f = 0; f < order_statistics.size(); ++f) order_statistics[f].insert(values[f], newNode->seq);
+    for (size_t f = 0; f < histograms.size(); ++f) histograms[f].add(values[f]);
 }
 
 void DoublyLinkedList::insertAt(int index, const Data* d) {
@@ -71,6 +85,47 @@ void DoublyLinkedList::insertAt(int index, const Data* d) {
         current->prev = newNode;
     }
     count++;
+
+    // Only appends keep the sequence numbers in list order: renumber and rebuild the windows
+    next_seq = 0;
+    for (Node* node = head; node; node = node->next) node->seq = next_seq++;
+    for (Window& window : windows) rebuildWindow(window);
+    rebuildQuantiles();
+    rebuildOrderStatistics();
+    if (!histograms.empty()) {
+        const StatisticFeatureValues values = statistic_feature_values(d);
+        for (size_t f = 0; f < histograms.size(); ++f) histograms[f].add(values[f]);
+    }
+}
+
+void DoublyLinkedList::findMany(const uint32_t* ids, size_t count, const Data** out) {
+    // id -> first position in 'ids'; duplicates are filled in from it at the end
+    std::unordered_map<uint32_t, size_t> pending;
+    pending.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = nullptr;
+        pending.emplace(ids[i], i);
+    }
+
+    size_t remaining = pending.size();
+    for (Node* current = head; current && remaining > 0; current = current->next) {
+        // The next node and the record after it are the misses of the following iterations
+        if (current->next) {
+            prefetch_read(current->next);
+            if (current->next->next) prefetch_read(current->next->next);
+            prefetch_read(current->next->data);
+        }
+        if (!current->data) continue;
+        auto it = pending.find(current->data->id);
+        if (it != pending.end() && !out[it->second]) {
+            out[it->second] = current->data;
+            --remaining;
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!out[i]) out[i] = out[pending[ids[i]]];
+    }
 }
 
 const Data* DoublyLinkedList::findById(uint32_t id) {
@@ -87,6 +142,11 @@ bool DoublyLinkedList::removeById(uint32_t id) {
     Node* current = head;
     while (current) {
         if (current->data && current->data->id == id) { // Check for null data pointer too
+            const StatisticFeatureValues values = statistic_feature_values(current->data);
+            for (Window& window : windows) windowRemove(window, current, values);
+            quantileRemove(current);
+            for (size_t f = 0; f < order_statistics.size(); ++f) order_statistics[f].erase(values[f], current->seq);
+            for (size_t f = 0; f < histograms.size(); ++f) histograms[f].remove(values[f]);
             if (current == head) {
                 head = current->next;
                 if (head) head->prev = nullptr;
@@ -114,82 +174,325 @@ int DoublyLinkedList::size() const {
     return count;
 }
 
-// Helper to get feature value from a Data object based on StatisticFeature enum
-float DoublyLinkedList::getFeatureValue(const Data* data, StatisticFeature feature) {
-    if (!data) return 0.0f; // Handle null data pointer gracefully for statistics
-
-    switch (feature) {
-        case StatisticFeature::DUR: return data->dur;
-        case StatisticFeature::RATE: return data->rate;
-        case StatisticFeature::SLOAD: return data->sload;
-        case StatisticFeature::DLOAD: return data->dload;
-        case StatisticFeature::SPKTS: return static_cast<float>(data->spkts);
-        case StatisticFeature::DPKTS: return static_cast<float>(data->dpkts);
-        case StatisticFeature::SBYTES: return static_cast<float>(data->sbytes);
-        case StatisticFeature::DBYTES: return static_cast<float>(data->dbytes);
-        // Add cases for other features as they are included in StatisticFeature enum
-        default: return 0.0f; // Should not happen if enum and implementation are in sync
+// The records of the last 'interval_count' nodes, most recent first
+std::vector<const Data*> DoublyLinkedList::collectIntervalRecords(int interval_count) const {
+    std::vector<const Data*> records;
+    int actual_count = std::min(count, std::max(interval_count, 0));
+    records.reserve(actual_count);
+    Node* current = tail;
+    for (int i = 0; i < actual_count && current; ++i, current = current->prev) {
+        if (current->data) records.push_back(current->data);
     }
+    return records;
 }
 
-// Helper to collect values for a given interval
+// Helper to collect values for a given interval, most recent first
 std::vector<float> DoublyLinkedList::collectIntervalValues(StatisticFeature feature, int interval_count) {
-    std::vector<float> values;
-    if (count == 0) return values;
+    std::vector<const Data*> records = collectIntervalRecords(interval_count);
+    std::vector<float> values(records.size());
+    gather_field(records.data(), records.size(), statistic_feature_field(feature), values.data());
+    return values;
+}
 
-    int actual_count = std::min(count, interval_count);
-    values.reserve(actual_count);
 
-    Node* current = tail; // Start from the tail to get the most recent items
-    for (int i = 0; i < actual_count; ++i) {
-        if (current && current->data) {
-            values.push_back(getFeatureValue(current->data, feature));
-        }
-        if (current) current = current->prev;
+void DoublyLinkedList::trackWindow(int size) {
+    if (size <= 0) return;
+    for (const Window& window : windows) {
+        if (window.size == size) return;
     }
-    // The values are collected in reverse order (most recent first).
-    // For statistics like average, min/max, it doesn't matter.
-    // For median, sorting will handle it.
-    return values;
+    windows.emplace_back();
+    windows.back().size = size;
+    rebuildWindow(windows.back());
+}
+
+void DoublyLinkedList::windowAppend(Window& window, Node* node, const StatisticFeatureValues& values) {
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) window.features[f].pushBack(values[f], node->seq);
+    if (!window.start) window.start = node;
+    if (++window.length > window.size) {
+        // Slide: the oldest node leaves the window
+        Node* leaving = window.start;
+        const StatisticFeatureValues leaving_values = statistic_feature_values(leaving->data);
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) window.features[f].popFront(leaving_values[f], leaving->seq);
+        window.start = leaving->next;
+        --window.length;
+        ++window.updates;
+    }
+    // Recompute the sums now and then, so that rounding can not build up over a long run
+    if (window.updates > std::max<uint64_t>(16 * static_cast<uint64_t>(window.size), 65536)) rebuildWindow(window);
+}
+
+// Called before 'node' is unlinked
+void DoublyLinkedList::windowRemove(Window& window, Node* node, const StatisticFeatureValues& values) {
+    if (!window.start || node->seq < window.start->seq) return; // Older than the window
+    Node* older = window.start->prev; // Joins the window, which still has to hold the last 'size' items
+    const StatisticFeatureValues older_values = statistic_feature_values(older ? older->data : nullptr);
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        if (node == window.start) window.features[f].popFront(values[f], node->seq);
+        else window.features[f].erase(values[f], node->seq);
+        if (older) window.features[f].pushFront(older_values[f], older->seq);
+    }
+    if (older) window.start = older;
+    else if (node == window.start) window.start = node->next;
+    if (!older) --window.length;
+    ++window.updates;
 }
 
+void DoublyLinkedList::rebuildWindow(Window& window) {
+    for (SlidingAggregate& feature : window.features) feature.clear();
+    window.start = nullptr;
+    window.length = 0;
+    window.updates = 0;
+    Node* start = tail;
+    for (int i = 1; start && start->prev && i < window.size; ++i) start = start->prev;
+    for (Node* node = start; node; node = node->next) {
+        const StatisticFeatureValues values = statistic_feature_values(node->data);
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) window.features[f].pushBack(values[f], node->seq);
+        ++window.length;
+    }
+    window.start = start;
+}
+
+void DoublyLinkedList::rebuildExtrema(Window& window) {
+    for (SlidingAggregate& feature : window.features) feature.resetExtrema();
+    for (Node* node = window.start; node; node = node->next) {
+        const StatisticFeatureValues values = statistic_feature_values(node->data);
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) window.features[f].pushExtremum(values[f], node->seq);
+    }
+}
+
+DoublyLinkedList::Window* DoublyLinkedList::windowFor(int interval_count) {
+    for (Window& window : windows) {
+        // A window that holds the whole list answers every interval at least as long as the list
+        if (window.size == interval_count || (window.length == count && interval_count >= count)) return &window;
+    }
+    return nullptr;
+}
+
+void DoublyLinkedList::trackQuantiles(double rank_error) {
+    quantile_k = QuantileSketch::kForRankError(rank_error);
+    rebuildQuantiles();
+}
+
+void DoublyLinkedList::quantileAppend(Node* node) {
+    if (quantile_k == 0 || !node->data) return;
+    uint64_t bucket_number = node->seq / QUANTILE_BUCKET_SIZE;
+    if (quantile_buckets.empty()) first_quantile_bucket = bucket_number;
+    while (bucket_number - first_quantile_bucket >= quantile_buckets.size()) quantile_buckets.emplace_back(quantile_k);
+    QuantileBucket& bucket = quantile_buckets[bucket_number - first_quantile_bucket];
+    if (!bucket.first) bucket.first = node;
+    ++bucket.sketches.live;
+    bucket.sketches.add(*node->data);
+}
+
+void DoublyLinkedList::quantileRemove(Node* node) {
+    if (quantile_k == 0 || !node->data) return;
+    uint64_t bucket_number = node->seq / QUANTILE_BUCKET_SIZE;
+    if (bucket_number < first_quantile_bucket || bucket_number - first_quantile_bucket >= quantile_buckets.size()) return;
+    QuantileBucket& bucket = quantile_buckets[bucket_number - first_quantile_bucket];
+    --bucket.sketches.live;
+    bucket.sketches.stale = true; // Sketches can not forget a value: rebuilt when next needed
+    if (bucket.first == node) bucket.first = bucket.sketches.live > 0 ? node->next : nullptr;
+    // Buckets emptied by the eviction of the oldest records are dropped
+    while (!quantile_buckets.empty() && quantile_buckets.front().sketches.live == 0) {
+        quantile_buckets.pop_front();
+        ++first_quantile_bucket;
+    }
+}
+
+void DoublyLinkedList::rebuildQuantiles() {
+    quantile_buckets.clear();
+    for (Node* node = head; node; node = node->next) quantileAppend(node);
+}
+
+void DoublyLinkedList::rebuildQuantileBucket(QuantileBucket& bucket) {
+    bucket.sketches.reset();
+    Node* node = bucket.first;
+    for (size_t i = 0; i < bucket.sketches.live && node; ++i, node = node->next) bucket.sketches.add(*node->data);
+}
+
+void DoublyLinkedList::trackOrderStatistics() {
+    order_statistics.clear();
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) order_statistics.emplace_back(f + 1);
+    rebuildOrderStatistics();
+}
+
+void DoublyLinkedList::rebuildOrderStatistics() {
+    for (OrderStatisticList& list : order_statistics) list.clear();
+    if (order_statistics.empty()) return;
+    for (Node* node = head; node; node = node->next) {
+        const StatisticFeatureValues values = statistic_feature_values(node->data);
+        for (size_t f = 0; f < order_statistics.size(); ++f) order_statistics[f].insert(values[f], node->seq);
+    }
+}
+
+void DoublyLinkedList::trackHistograms() {
+    histograms.assign(STATISTIC_FEATURE_COUNT, LogHistogram());
+    for (Node* node = head; node; node = node->next) {
+        const StatisticFeatureValues values = statistic_feature_values(node->data);
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) histograms[f].add(values[f]);
+    }
+}
+
+bool DoublyLinkedList::histogramMaintained(int interval_count, HistogramScale scale) const {
+    return !histograms.empty() && scale == HistogramScale::LOG && interval_count >= count;
+}
+
+std::vector<HistogramBin> DoublyLinkedList::getHistogram(StatisticFeature feature, int interval_count, HistogramScale scale, size_t bins) {
+    if (histogramMaintained(interval_count, scale)) return histograms[static_cast<size_t>(feature)].bins(bins);
+    std::vector<float> values = collectIntervalValues(feature, interval_count);
+    if (scale == HistogramScale::LOG) return log_histogram(values.data(), values.size(), bins);
+    return linear_histogram(values.data(), values.size(), bins);
+}
+
+bool DoublyLinkedList::quantilesExact(int interval_count) const {
+    return quantile_k == 0 || orderStatisticsCover(interval_count) || static_cast<size_t>(std::min(count, std::max(interval_count, 0))) <= QUANTILE_EXACT_LIMIT;
+}
+
+std::vector<float> DoublyLinkedList::getQuantiles(StatisticFeature feature, int interval_count, const std::vector<double>& qs, bool exact) {
+    if (orderStatisticsCover(interval_count)) {
+        std::vector<float> result;
+        for (double q : qs) result.push_back(order_statistics[static_cast<size_t>(feature)].quantile(q));
+        return result;
+    }
+    if (exact || quantilesExact(interval_count)) {
+        std::vector<float> values = collectIntervalValues(feature, interval_count);
+        return exact_quantiles(values, qs);
+    }
+
+    size_t f = static_cast<size_t>(feature);
+    size_t needed = static_cast<size_t>(std::min(count, interval_count));
+    QuantileSketch merged(quantile_k);
+    // Newest buckets first; the oldest one the interval reaches into is usually only partly inside
+    for (size_t b = quantile_buckets.size(); b-- > 0 && needed > 0;) {
+        QuantileBucket& bucket = quantile_buckets[b];
+        size_t live = bucket.sketches.live;
+        if (live == 0) continue;
+        if (live <= needed) {
+            if (bucket.sketches.stale) rebuildQuantileBucket(bucket);
+            merged.merge(bucket.sketches.features[f]);
+            needed -= live;
+        } else {
+            Node* node = bucket.first;
+            for (size_t skip = live - needed; skip > 0 && node; --skip) node = node->next;
+            const NumericField& field = statistic_feature_field(feature);
+            visit_field_type(field.type, [&](auto tag) {
+                using T = decltype(tag);
+                for (; needed > 0 && node; --needed, node = node->next)
+                    merged.add(node->data ? static_cast<float>(read_field<T>(node->data, field.offset)) : 0.0f);
+            });
+        }
+    }
+    return merged.quantiles(qs);
+}
 
 // Generic statistical methods that take a StatisticFeature enum and interval_count
 float DoublyLinkedList::getAverage(StatisticFeature feature, int interval_count) {
+    if (Window* window = windowFor(interval_count)) {
+        return static_cast<float>(window->features[static_cast<size_t>(feature)].mean());
+    }
     std::vector<float> values = collectIntervalValues(feature, interval_count);
-    if (values.empty()) return 0.0f;
-    return std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+    return static_cast<float>(compute_moments(values.data(), values.size()).mean); // 0 when empty
 }
 
 float DoublyLinkedList::getStdDev(StatisticFeature feature, int interval_count) {
-    std::vector<float> values = collectIntervalValues(feature, interval_count);
-    if (values.empty()) return 0.0f;
-    float avg = getAverage(feature, interval_count); // Use the same average calculated on the interval
-    float sum_sq_diff = 0.0f;
-    for (float val : values) {
-        sum_sq_diff += (val - avg) * (val - avg);
+    if (Window* window = windowFor(interval_count)) {
+        return static_cast<float>(std::sqrt(window->features[static_cast<size_t>(feature)].variance()));
     }
-    return (values.size() > 0) ? std::sqrt(sum_sq_diff / values.size()) : 0.0f;
+    std::vector<float> values = collectIntervalValues(feature, interval_count);
+    return static_cast<float>(std::sqrt(compute_moments(values.data(), values.size()).variance()));
 }
 
 float DoublyLinkedList::getMedian(StatisticFeature feature, int interval_count) {
-    std::vector<float> values = collectIntervalValues(feature, interval_count);
-    if (values.empty()) return 0.0f;
-    std::sort(values.begin(), values.end());
-    int mid = values.size() / 2;
-    return values.size() % 2 == 0 ? (values[mid - 1] + values[mid]) / 2.0f : values[mid];
+    return getQuantiles(feature, interval_count, {0.5})[0];
 }
 
 float DoublyLinkedList::getMin(StatisticFeature feature, int interval_count) {
+    if (Window* window = windowFor(interval_count)) {
+        SlidingAggregate& aggregate = window->features[static_cast<size_t>(feature)];
+        if (!aggregate.extremaValid()) rebuildExtrema(*window);
+        return aggregate.min();
+    }
     std::vector<float> values = collectIntervalValues(feature, interval_count);
-    if (values.empty()) return 0.0f; // Or std::numeric_limits<float>::max();
-    return *std::min_element(values.begin(), values.end());
+    return compute_moments(values.data(), values.size()).min; // 0 when empty
 }
 
 float DoublyLinkedList::getMax(StatisticFeature feature, int interval_count) {
+    if (Window* window = windowFor(interval_count)) {
+        SlidingAggregate& aggregate = window->features[static_cast<size_t>(feature)];
+        if (!aggregate.extremaValid()) rebuildExtrema(*window);
+        return aggregate.max();
+    }
     std::vector<float> values = collectIntervalValues(feature, interval_count);
-    if (values.empty()) return 0.0f; // Or std::numeric_limits<float>::lowest();
-    return *std::max_element(values.begin(), values.end());
+    return compute_moments(values.data(), values.size()).max; // 0 when empty
+}
+
+
+StatsSummary DoublyLinkedList::windowSummary(Window& window, StatisticFeature feature, int interval_count,
+                                             std::vector<const Data*>& records) {
+    size_t f = static_cast<size_t>(feature);
+    SlidingAggregate& aggregate = window.features[f];
+    StatsSummary summary;
+    summary.count = aggregate.count();
+    if (summary.count == 0) return summary;
+    if (!aggregate.extremaValid()) rebuildExtrema(window);
+    summary.mean = aggregate.mean();
+    summary.variance = aggregate.variance();
+    summary.min = aggregate.min();
+    summary.max = aggregate.max();
+    if (orderStatisticsCover(interval_count)) {
+        summary.median = order_statistics[f].quantile(0.5);
+    } else {
+        if (records.empty()) records = collectIntervalRecords(interval_count);
+        std::vector<float> values(records.size());
+        gather_field(records.data(), records.size(), statistic_feature_field(feature), values.data());
+        summary.median = select_median(values.data(), values.size());
+    }
+    return summary;
+}
+
+StatsSummary DoublyLinkedList::gatherSummary(const NumericField& field, int interval_count) {
+    std::vector<const Data*> records = collectIntervalRecords(interval_count);
+    SummaryBuilder builder(records.size());
+    builder.addField(records.data(), records.size(), field);
+    return builder.finish();
+}
+
+StatsSummary DoublyLinkedList::summarize(StatisticFeature feature, int interval_count) {
+    Window* window = windowFor(interval_count);
+    if (!window) return gatherSummary(statistic_feature_field(feature), interval_count);
+    std::vector<const Data*> records;
+    return windowSummary(*window, feature, interval_count, records);
+}
+
+StatsSummary DoublyLinkedList::summarizeField(const NumericField& field, int interval_count) {
+    StatisticFeature feature;
+    if (statistic_feature_of(field, feature)) return summarize(feature, interval_count);
+    return gatherSummary(field, interval_count);
+}
+
+GroupSummaries DoublyLinkedList::summarizeByGroup(const NumericField& field, size_t group_offset, int interval_count) {
+    std::vector<const Data*> records = collectIntervalRecords(interval_count);
+    GroupSummaries groups{};
+    summarize_groups(records.data(), records.size(), group_offset, field, groups);
+    return groups;
+}
+
+StatsSummaryRow DoublyLinkedList::summarizeAll(int interval_count) {
+    StatsSummaryRow row;
+    if (Window* window = windowFor(interval_count)) {
+        std::vector<const Data*> records; // Collected at most once, for medians the order statistics do not cover
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f)
+            row[f] = windowSummary(*window, static_cast<StatisticFeature>(f), interval_count, records);
+        return row;
+    }
+    // One traversal for the records, then one typed column per feature
+    std::vector<const Data*> records = collectIntervalRecords(interval_count);
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        SummaryBuilder builder(records.size());
+        builder.addField(records.data(), records.size(), statistic_feature_field(static_cast<StatisticFeature>(f)));
+        row[f] = builder.finish();
+    }
+    return row;
 }
 
 
@@ -0,0 +1,168 @@
+#include "essential/OrderStatistics.h"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For std::floor
+#include <cstdlib>   // For malloc, free
+#include <new>       // For placement new, std::bad_alloc
+
+OrderStatisticList::OrderStatisticList(uint64_t seed)
+    : head(createNode(MAX_LEVEL, 0.0f, 0)), random_state(seed ? seed : 1) {
+    // The end of an empty list is position 1
+    for (int i = 0; i < MAX_LEVEL; ++i) head->next[i] = Link{nullptr, 1};
+}
+
+OrderStatisticList::~OrderStatisticList() {
+    if (!head) return; // Moved from
+    clear();
+    free(head);
+}
+
+OrderStatisticList::OrderStatisticList(OrderStatisticList&& other) noexcept
+    : head(other.head), level(other.level), count(other.count), random_state(other.random_state) {
+    other.head = nullptr;
+    other.count = 0;
+}
+
+OrderStatisticList& OrderStatisticList::operator=(OrderStatisticList&& other) noexcept {
+    if (this != &other) {
+        if (head) {
+            clear();
+            free(head);
+        }
+        head = other.head;
+        level = other.level;
+        count = other.count;
+        random_state = other.random_state;
+        other.head = nullptr;
+        other.count = 0;
+    }
+    return *this;
+}
+
+OrderStatisticList::Node* OrderStatisticList::createNode(int level, float value, uint64_t seq) {
+    size_t node_size = sizeof(Node) + (level - 1) * sizeof(Link);
+    void* memory = malloc(node_size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return new (memory) Node{value, seq, level, {}};
+}
+
+bool OrderStatisticList::before(const Node* node, float value, uint64_t seq) {
+    return node->value < value || (node->value == value && node->seq < seq);
+}
+
+int OrderStatisticList::randomLevel() {
+    // xorshift64; each extra level with probability 1/2
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 7;
+    random_state ^= random_state << 17;
+    uint64_t bits = random_state;
+    int new_level = 1;
+    while ((bits & 1) && new_level < MAX_LEVEL) {
+        ++new_level;
+        bits >>= 1;
+    }
+    return new_level;
+}
+
+void OrderStatisticList::findPredecessors(float value, uint64_t seq, Node** update, size_t* position) const {
+    Node* current = head;
+    size_t pos = 0; // head is position 0, the values are 1..count
+    for (int i = MAX_LEVEL - 1; i >= 0; --i) {
+        if (i < level) {
+            while (current->next[i].node && before(current->next[i].node, value, seq)) {
+                pos += current->next[i].width;
+                current = current->next[i].node;
+            }
+        }
+        update[i] = current;
+        position[i] = pos;
+    }
+}
+
+void OrderStatisticList::insert(float value, uint64_t seq) {
+    Node* update[MAX_LEVEL];
+    size_t position[MAX_LEVEL];
+    findPredecessors(value, seq, update, position);
+
+    int node_level = randomLevel();
+    level = std::max(level, node_level);
+    Node* node = createNode(node_level, value, seq);
+    size_t node_position = position[0] + 1;
+    for (int i = 0; i < MAX_LEVEL; ++i) {
+        Link& link = update[i]->next[i];
+        if (i < node_level) {
+            // Split the link that jumped over the new node
+            node->next[i] = Link{link.node, link.width - (node_position - position[i]) + 1};
+            link = Link{node, node_position - position[i]};
+        } else {
+            ++link.width; // Jumps over the new node
+        }
+    }
+    ++count;
+}
+
+bool OrderStatisticList::erase(float value, uint64_t seq) {
+    Node* update[MAX_LEVEL];
+    size_t position[MAX_LEVEL];
+    findPredecessors(value, seq, update, position);
+
+    Node* node = update[0]->next[0].node;
+    if (!node || node->value != value || node->seq != seq) return false;
+    for (int i = 0; i < MAX_LEVEL; ++i) {
+        Link& link = update[i]->next[i];
+        if (link.node == node) {
+            link = Link{node->next[i].node, link.width + node->next[i].width - 1};
+        } else {
+            --link.width;
+        }
+    }
+    free(node);
+    --count;
+    while (level > 1 && !head->next[level - 1].node) --level;
+    return true;
+}
+
+void OrderStatisticList::clear() {
+    Node* current = head->next[0].node;
+    while (current) {
+        Node* next = current->next[0].node;
+        free(current);
+        current = next;
+    }
+    for (int i = 0; i < MAX_LEVEL; ++i) head->next[i] = Link{nullptr, 1};
+    level = 1;
+    count = 0;
+}
+
+float OrderStatisticList::kth(size_t k) const {
+    size_t target = k + 1;
+    const Node* current = head;
+    size_t pos = 0;
+    for (int i = level - 1; i >= 0; --i) {
+        while (current->next[i].node && pos + current->next[i].width <= target) {
+            pos += current->next[i].width;
+            current = current->next[i].node;
+        }
+    }
+    return current->value;
+}
+
+float OrderStatisticList::quantile(double q) const {
+    if (count == 0) return 0.0f;
+    double position = std::min(std::max(q, 0.0), 1.0) * static_cast<double>(count - 1);
+    size_t below = static_cast<size_t>(std::floor(position));
+    double fraction = position - static_cast<double>(below);
+    double lower = kth(below);
+    if (fraction == 0.0) return static_cast<float>(lower);
+    double upper = kth(below + 1);
+    return static_cast<float>((1.0 - fraction) * lower + fraction * upper);
+}
+
+size_t OrderStatisticList::getMemoryUsage() const {
+    size_t total = sizeof(*this) + sizeof(Node) + (MAX_LEVEL - 1) * sizeof(Link);
+    for (const Node* current = head->next[0].node; current; current = current->next[0].node) {
+        total += sizeof(Node) + (current->level - 1) * sizeof(Link);
+    }
+    return total;
+}
@@ -0,0 +1,171 @@
+#include "essential/QuantileSketch.h"
+#include "data_fields.h"   // For statistic_feature_values
+#include <algorithm>       // For std::sort, std::nth_element, std::min_element
+#include <cmath>           // For std::pow, std::ceil, std::floor
+#include <utility>         // For std::pair
+
+QuantileSketch::QuantileSketch(uint16_t k) : k(std::max<uint16_t>(k, 8)) {}
+
+uint16_t QuantileSketch::kForRankError(double rank_error) {
+    // Inverse of rankError(), the empirical fit published with the DataSketches KLL sketch
+    if (rank_error <= 0.0) return 65535;
+    double k = std::ceil(std::pow(2.296 / rank_error, 1.0 / 0.9723));
+    return static_cast<uint16_t>(std::min(std::max(k, 8.0), 65535.0));
+}
+
+double QuantileSketch::rankError() const {
+    return 2.296 / std::pow(static_cast<double>(k), 0.9723);
+}
+
+size_t QuantileSketch::levelCapacity(size_t level) const {
+    // The top level holds k items and every level below it two thirds of the one above
+    size_t depth = levels.size() - 1 - level;
+    double capacity = std::ceil(k * std::pow(2.0 / 3.0, static_cast<double>(depth)));
+    return std::max<size_t>(2, static_cast<size_t>(capacity));
+}
+
+void QuantileSketch::resizeLevels(size_t count) {
+    levels.resize(count);
+    total_capacity = 0;
+    for (size_t h = 0; h < levels.size(); ++h) total_capacity += levelCapacity(h);
+}
+
+void QuantileSketch::add(float value) {
+    if (n == 0 || value < low) low = value;
+    if (n == 0 || value > high) high = value;
+    ++n;
+    if (levels.empty()) resizeLevels(1);
+    levels[0].push_back(value);
+    ++retained_count;
+    if (retained_count > total_capacity) compress();
+}
+
+void QuantileSketch::compact(size_t level) {
+    if (level + 1 == levels.size()) resizeLevels(levels.size() + 1);
+    std::vector<float>& items = levels[level];
+    std::vector<float>& above = levels[level + 1];
+    std::sort(items.begin(), items.end());
+
+    // An odd item out stays behind; the others pair up and one of each pair moves up with twice the weight
+    bool odd = items.size() % 2 != 0;
+    float leftover = odd ? items.back() : 0.0f;
+    size_t paired = items.size() - (odd ? 1 : 0);
+    coin ^= coin << 13;
+    coin ^= coin >> 7;
+    coin ^= coin << 17;
+    for (size_t i = coin & 1; i < paired; i += 2) above.push_back(items[i]);
+    retained_count -= paired / 2;
+    items.clear();
+    if (odd) items.push_back(leftover);
+}
+
+void QuantileSketch::compress() {
+    while (retained_count > total_capacity) {
+        for (size_t h = 0; h < levels.size(); ++h) {
+            if (levels[h].size() >= levelCapacity(h)) {
+                compact(h);
+                break;
+            }
+        }
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.n == 0) return;
+    if (n == 0 || other.low < low) low = other.low;
+    if (n == 0 || other.high > high) high = other.high;
+    n += other.n;
+    if (levels.size() < other.levels.size()) resizeLevels(other.levels.size());
+    for (size_t h = 0; h < other.levels.size(); ++h) {
+        levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+        retained_count += other.levels[h].size();
+    }
+    compress();
+}
+
+void QuantileSketch::clear() {
+    n = 0;
+    retained_count = 0;
+    total_capacity = 0;
+    levels.clear();
+}
+
+float QuantileSketch::quantile(double q) const {
+    return quantiles({q})[0];
+}
+
+std::vector<float> QuantileSketch::quantiles(const std::vector<double>& qs) const {
+    std::vector<float> result(qs.size(), 0.0f);
+    if (n == 0) return result;
+
+    // Every retained item with its weight, in value order
+    std::vector<std::pair<float, uint64_t>> weighted;
+    weighted.reserve(retained_count);
+    for (size_t h = 0; h < levels.size(); ++h) {
+        for (float value : levels[h]) weighted.emplace_back(value, uint64_t(1) << h);
+    }
+    std::sort(weighted.begin(), weighted.end());
+
+    for (size_t i = 0; i < qs.size(); ++i) {
+        double q = qs[i];
+        if (q <= 0.0) { result[i] = low; continue; }
+        if (q >= 1.0) { result[i] = high; continue; }
+        double target = q * static_cast<double>(n);
+        uint64_t cumulative = 0;
+        result[i] = high;
+        for (const auto& item : weighted) {
+            cumulative += item.second;
+            if (static_cast<double>(cumulative) >= target) {
+                result[i] = item.first;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+size_t QuantileSketch::getMemoryUsage() const {
+    size_t usage = sizeof(*this) + levels.capacity() * sizeof(std::vector<float>);
+    for (const std::vector<float>& level : levels) usage += level.capacity() * sizeof(float);
+    return usage;
+}
+
+std::vector<float> exact_quantiles(std::vector<float>& values, const std::vector<double>& qs) {
+    std::vector<float> result(qs.size(), 0.0f);
+    if (values.empty()) return result;
+    for (size_t i = 0; i < qs.size(); ++i) {
+        double position = std::min(std::max(qs[i], 0.0), 1.0) * static_cast<double>(values.size() - 1);
+        size_t below = static_cast<size_t>(std::floor(position));
+        double fraction = position - static_cast<double>(below);
+        std::nth_element(values.begin(), values.begin() + below, values.end());
+        double lower = values[below];
+        if (fraction == 0.0) {
+            result[i] = static_cast<float>(lower);
+            continue;
+        }
+        // nth_element left everything greater or equal after 'below': the next rank is their minimum
+        double upper = *std::min_element(values.begin() + below + 1, values.end());
+        result[i] = static_cast<float>((1.0 - fraction) * lower + fraction * upper);
+    }
+    return result;
+}
+
+FeatureSketches::FeatureSketches(uint16_t k) {
+    for (QuantileSketch& sketch : features) sketch = QuantileSketch(k);
+}
+
+void FeatureSketches::add(const Data& data) {
+    const StatisticFeatureValues values = statistic_feature_values(&data);
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) features[f].add(values[f]);
+}
+
+void FeatureSketches::reset() {
+    for (QuantileSketch& sketch : features) sketch.clear();
+    stale = false;
+}
+
+size_t FeatureSketches::getMemoryUsage() const {
+    size_t usage = sizeof(*this);
+    for (const QuantileSketch& sketch : features) usage += sketch.getMemoryUsage() - sizeof(sketch);
+    return usage;
+}
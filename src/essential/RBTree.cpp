@@ -1,6 +1,8 @@
 // Criado por Gemini AI 2.5 pro, baeado no código de Luiz Henrique
 
 #include "essential/RBTree.h"
+#include <algorithm>  // For std::min
+#include "prefetch.h" // For prefetch_read, PREFETCH_GROUP_SIZE
 
 size_t RBTree::getMemoryUsage() const {
     if (root_ == nil_) return sizeof(*nil_);
@@ -63,6 +65,37 @@ typename RBTree::Node* RBTree::search(uint32_t key) const {
     return nil_;
 }
 
+void RBTree::findMany(const uint32_t* keys, size_t count, const Data** out) const {
+    Node* cursor[PREFETCH_GROUP_SIZE];
+    for (size_t base = 0; base < count; base += PREFETCH_GROUP_SIZE) {
+        size_t group = std::min(PREFETCH_GROUP_SIZE, count - base);
+        for (size_t i = 0; i < group; ++i) {
+            cursor[i] = root_;
+            out[base + i] = nullptr;
+        }
+
+        bool active = root_ != nil_;
+        while (active) {
+            active = false;
+            for (size_t i = 0; i < group; ++i) {
+                Node* node = cursor[i];
+                if (node == nil_) continue;
+                uint32_t key = keys[base + i];
+                if (key == node->key) {
+                    out[base + i] = node->value;
+                    cursor[i] = nil_;
+                    continue;
+                }
+                cursor[i] = key < node->key ? node->left : node->right;
+                if (cursor[i] != nil_) {
+                    prefetch_read(cursor[i]);
+                    active = true;
+                }
+            }
+        }
+    }
+}
+
 const Data* RBTree::find(uint32_t key) const {
     Node* node = search(key);
     if (node != nil_) {
@@ -0,0 +1,96 @@
+#include "essential/SlidingWindow.h"
+#include <algorithm> // For std::max
+#include <cmath>     // For std::fabs
+
+// Neumaier's variant of Kahan summation, which stays exact-ish when terms are subtracted
+void SlidingAggregate::KahanSum::add(double value) {
+    double t = sum + value;
+    if (std::fabs(sum) >= std::fabs(value)) compensation += (sum - t) + value;
+    else compensation += (value - t) + sum;
+    sum = t;
+}
+
+void SlidingAggregate::accumulate(float value, double sign) {
+    if (n == 0 && sign > 0) {
+        // An empty window restarts from exact zeros, which also discards any accumulated drift
+        shift = value;
+        sum = KahanSum();
+        sum_squares = KahanSum();
+    }
+    double centered = static_cast<double>(value) - shift;
+    sum.add(sign * centered);
+    sum_squares.add(sign * centered * centered);
+    if (sign > 0) ++n;
+    else --n;
+}
+
+void SlidingAggregate::pushBack(float value, uint64_t seq) {
+    accumulate(value, 1.0);
+    pushExtremum(value, seq);
+}
+
+void SlidingAggregate::pushExtremum(float value, uint64_t seq) {
+    while (!min_queue.empty() && min_queue.back().first >= value) min_queue.pop_back();
+    min_queue.emplace_back(value, seq);
+    while (!max_queue.empty() && max_queue.back().first <= value) max_queue.pop_back();
+    max_queue.emplace_back(value, seq);
+}
+
+void SlidingAggregate::pushFront(float value, uint64_t seq) {
+    accumulate(value, 1.0);
+    // An older value only matters while it is strictly beyond everything newer
+    if (min_queue.empty() || value < min_queue.front().first) min_queue.emplace_front(value, seq);
+    if (max_queue.empty() || value > max_queue.front().first) max_queue.emplace_front(value, seq);
+}
+
+void SlidingAggregate::popFront(float value, uint64_t seq) {
+    if (n == 0) return;
+    accumulate(value, -1.0);
+    if (!min_queue.empty() && min_queue.front().second == seq) min_queue.pop_front();
+    if (!max_queue.empty() && max_queue.front().second == seq) max_queue.pop_front();
+}
+
+void SlidingAggregate::erase(float value, uint64_t seq) {
+    if (n == 0) return;
+    accumulate(value, -1.0);
+    if (n == 0) {
+        min_queue.clear();
+        max_queue.clear();
+        extrema_valid = true;
+        return;
+    }
+    bool in_min = std::any_of(min_queue.begin(), min_queue.end(), [seq](const std::pair<float, uint64_t>& e) { return e.second == seq; });
+    bool in_max = std::any_of(max_queue.begin(), max_queue.end(), [seq](const std::pair<float, uint64_t>& e) { return e.second == seq; });
+    // A value that was in neither deque was dominated by a newer one and hid nothing
+    if (in_min || in_max) extrema_valid = false;
+}
+
+void SlidingAggregate::clear() {
+    n = 0;
+    shift = 0.0;
+    sum = KahanSum();
+    sum_squares = KahanSum();
+    min_queue.clear();
+    max_queue.clear();
+    extrema_valid = true;
+}
+
+void SlidingAggregate::resetExtrema() {
+    min_queue.clear();
+    max_queue.clear();
+    extrema_valid = true;
+}
+
+double SlidingAggregate::mean() const {
+    return n ? shift + sum.value() / static_cast<double>(n) : 0.0;
+}
+
+double SlidingAggregate::variance() const {
+    if (n == 0) return 0.0;
+    double centered_mean = sum.value() / static_cast<double>(n);
+    return std::max(0.0, sum_squares.value() / static_cast<double>(n) - centered_mean * centered_mean);
+}
+
+size_t SlidingAggregate::getMemoryUsage() const {
+    return sizeof(*this) + (min_queue.size() + max_queue.size()) * sizeof(std::pair<float, uint64_t>);
+}
@@ -6,6 +6,8 @@
 #include <utility>   // For std::swap
 #include <stdexcept> // For std::runtime_error if needed, though replaced with cerr
 #include <iostream>  // For std::cerr, std::cout
+#include <algorithm> // For std::min
+#include "prefetch.h" // For prefetch_read, PREFETCH_GROUP_SIZE
 
 CuckooHashTable::CuckooHashTable(size_t initial_capacity)
     : capacity(initial_capacity), size(0) {
@@ -160,6 +162,32 @@ bool CuckooHashTable::remove(uint32_t id) {
     return false; // Item not found
 }
 
+void CuckooHashTable::findMany(const uint32_t* ids, size_t count, const Data** out) const {
+    size_t pos1[PREFETCH_GROUP_SIZE], pos2[PREFETCH_GROUP_SIZE];
+    for (size_t base = 0; base < count; base += PREFETCH_GROUP_SIZE) {
+        size_t group = std::min(PREFETCH_GROUP_SIZE, count - base);
+        // Stage 1: both candidate entries
+        for (size_t i = 0; i < group; ++i) {
+            pos1[i] = hash1(ids[base + i]);
+            pos2[i] = hash2(ids[base + i]);
+            prefetch_read(&table1[pos1[i]]);
+            prefetch_read(&table2[pos2[i]]);
+        }
+        // Stage 2: the records they point to
+        for (size_t i = 0; i < group; ++i) {
+            if (table1[pos1[i]].data) prefetch_read(table1[pos1[i]].data);
+            if (table2[pos2[i]].data) prefetch_read(table2[pos2[i]].data);
+        }
+        // Stage 3: compare
+        for (size_t i = 0; i < group; ++i) {
+            uint32_t id = ids[base + i];
+            const Data* d1 = table1[pos1[i]].data;
+            const Data* d2 = table2[pos2[i]].data;
+            out[base + i] = (d1 && d1->id == id) ? d1 : (d2 && d2->id == id) ? d2 : nullptr;
+        }
+    }
+}
+
 const Data* CuckooHashTable::search(uint32_t id) {
     size_t pos1 = hash1(id);
     if (table1[pos1].data != nullptr && table1[pos1].data->id == id) {
@@ -5,8 +5,8 @@
 #include <iostream>            // For debug output (if any)
 #include <algorithm>           // For std::find_if, std::min, std::max, std::sort, std::reverse
 #include <vector>              // Already included via SegmentTree.h, but good practice to list dependencies
-#include <numeric>             // For std::accumulate
 #include <cmath>               // For std::sqrt
+#include "prefetch.h"          // For prefetch_read, PREFETCH_GROUP_SIZE
 
 // Private helper for recursive insertion
 void SegmentTree::insert(Node* node, int idx, const Data* data) { // Changed to const Data*
@@ -14,8 +14,7 @@ void SegmentTree::insert(Node* node, int idx, const Data* data) { // Changed to
     if (node->left == node->right) {
         // Here we store the pointer to the Data object
         node->values.push_back(data);
-        // Access rate via pointer
-        if (data) node->sumRate += data->rate; // Update sum of rates for this leaf
+        if (data) node->aggregate.add(*data); // Update the aggregates for this leaf
         return;
     }
 
@@ -33,8 +32,8 @@ void SegmentTree::insert(Node* node, int idx, const Data* data) { // Changed to
         insert(node->rightChild.get(), idx, data); // Recurse into right child
     }
 
-    // Update sum of rates for current (non-leaf) node based on its children
-    node->sumRate = getSum(node->leftChild.get()) + getSum(node->rightChild.get());
+    // Update the aggregates of the current (non-leaf) node from its children
+    pull(node);
 }
 
 // Private helper for recursive removal
@@ -49,8 +48,8 @@ bool SegmentTree::remove(Node* node, int idx, uint32_t id) {
             return d && d->id == id; // Check for null pointer before dereferencing
         });
         if (it != vec.end()) {
-            if (*it) node->sumRate -= (*it)->rate; // Update sum of rates, access rate via pointer
             vec.erase(it);             // Remove the Data pointer from the vector
+            pull(node);                // Min and max cannot be undone, so rebuild from what is left
             return true;
         }
         return false; // Item not found in this leaf node
@@ -64,16 +63,90 @@ bool SegmentTree::remove(Node* node, int idx, uint32_t id) {
     else
         removed = remove(node->rightChild.get(), idx, id); // Try removing from right child
 
-    // If an item was removed from a child, update this node's sumRate
+    // If an item was removed from a child, update this node's aggregates
     if (removed)
-        node->sumRate = getSum(node->leftChild.get()) + getSum(node->rightChild.get());
+        pull(node);
 
     return removed;
 }
 
-// Private helper to get sum of rates (handles null nodes by returning 0)
-float SegmentTree::getSum(Node* node) const {
-    return node ? node->sumRate : 0.0f;
+void SegmentTree::Aggregate::add(const Data& data) {
+    const StatisticFeatureValues values = statistic_feature_values(&data);
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        float value = values[f];
+        FeatureAggregate& a = features[f];
+        a.sum += value;
+        a.sum_squares += static_cast<double>(value) * value;
+        if (count == 0 || value < a.min) a.min = value;
+        if (count == 0 || value > a.max) a.max = value;
+    }
+    ++count;
+}
+
+void SegmentTree::Aggregate::merge(const Aggregate& other) {
+    if (other.count == 0) return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        FeatureAggregate& a = features[f];
+        const FeatureAggregate& b = other.features[f];
+        a.sum += b.sum;
+        a.sum_squares += b.sum_squares;
+        a.min = std::min(a.min, b.min);
+        a.max = std::max(a.max, b.max);
+    }
+    count += other.count;
+}
+
+double SegmentTree::Aggregate::mean(StatisticFeature feature) const {
+    return count ? features[static_cast<size_t>(feature)].sum / static_cast<double>(count) : 0.0;
+}
+
+double SegmentTree::Aggregate::variance(StatisticFeature feature) const {
+    if (count == 0) return 0.0;
+    const FeatureAggregate& a = features[static_cast<size_t>(feature)];
+    double average = a.sum / static_cast<double>(count);
+    return std::max(0.0, a.sum_squares / static_cast<double>(count) - average * average);
+}
+
+void SegmentTree::pull(Node* node) {
+    Aggregate aggregate;
+    if (node->left == node->right) {
+        for (const Data* d : node->values)
+            if (d) aggregate.add(*d);
+    } else {
+        if (node->leftChild) aggregate.merge(node->leftChild->aggregate);
+        if (node->rightChild) aggregate.merge(node->rightChild->aggregate);
+    }
+    node->aggregate = aggregate;
+}
+
+void SegmentTree::aggregateRange(const Node* node, int from, int to, Aggregate& out) const {
+    if (!node || node->aggregate.count == 0 || to < node->left || node->right < from) return;
+    if (from <= node->left && node->right <= to) {
+        out.merge(node->aggregate); // Fully covered: no need to go further down
+        return;
+    }
+    aggregateRange(node->leftChild.get(), from, to, out);
+    aggregateRange(node->rightChild.get(), from, to, out);
+}
+
+void SegmentTree::aggregateRecent(const Node* node, size_t limit, Aggregate& out) const {
+    if (!node || out.count >= limit || node->aggregate.count == 0) return;
+    if (node->aggregate.count <= limit - out.count) {
+        out.merge(node->aggregate);
+        return;
+    }
+    if (node->left == node->right) {
+        // A leaf holding more records than still needed: take its newest ones
+        for (auto it = node->values.rbegin(); it != node->values.rend() && out.count < limit; ++it)
+            if (*it) out.add(**it);
+        return;
+    }
+    aggregateRecent(node->rightChild.get(), limit, out);
+    aggregateRecent(node->leftChild.get(), limit, out);
 }
 
 // Private helper for recursive find
@@ -97,60 +170,33 @@ const Data* SegmentTree::find(Node* node, int idx, uint32_t id) { // Changed ret
         return find(node->rightChild.get(), idx, id); // Search in right child
 }
 
-// Helper to get feature value from a Data object based on StatisticFeature enum (copied from LinkedList.cpp)
-float SegmentTree::getFeatureValue(const Data* data, StatisticFeature feature) const {
-    if (!data) return 0.0f; // Handle null data pointer gracefully for statistics
-
-    switch (feature) {
-        case StatisticFeature::DUR: return data->dur;
-        case StatisticFeature::RATE: return data->rate;
-        case StatisticFeature::SLOAD: return data->sload;
-        case StatisticFeature::DLOAD: return data->dload;
-        case StatisticFeature::SPKTS: return static_cast<float>(data->spkts);
-        case StatisticFeature::DPKTS: return static_cast<float>(data->dpkts);
-        case StatisticFeature::SBYTES: return static_cast<float>(data->sbytes);
-        case StatisticFeature::DBYTES: return static_cast<float>(data->dbytes);
-        default: return 0.0f; // Should not happen if enum and implementation are in sync
-    }
-}
-
-// Helper to recursively collect all Data* pointers from the tree
-void SegmentTree::collectAllDataPointersRecursive(Node* node, std::vector<const Data*>& collected_pointers) const {
-    if (!node) return;
+void SegmentTree::collectRecentRecursive(const Node* node, size_t limit, std::vector<const Data*>& collected_pointers) const {
+    if (!node || collected_pointers.size() >= limit) return;
     if (node->left == node->right) { // Leaf node
-        for (const Data* d_ptr : node->values) {
-            collected_pointers.push_back(d_ptr);
+        for (auto it = node->values.rbegin(); it != node->values.rend() && collected_pointers.size() < limit; ++it) {
+            if (*it) collected_pointers.push_back(*it);
         }
         return;
     }
-    collectAllDataPointersRecursive(node->leftChild.get(), collected_pointers);
-    collectAllDataPointersRecursive(node->rightChild.get(), collected_pointers);
+    collectRecentRecursive(node->rightChild.get(), limit, collected_pointers);
+    collectRecentRecursive(node->leftChild.get(), limit, collected_pointers);
 }
 
-// Helper to collect feature values for a given interval
-std::vector<float> SegmentTree::collectFeatureValuesForInterval(StatisticFeature feature, int interval_count) const {
-    std::vector<const Data*> all_data_pointers;
-    // Collect all pointers by traversing the tree
-    collectAllDataPointersRecursive(root.get(), all_data_pointers);
-
-    std::vector<float> values;
-    if (all_data_pointers.empty()) return values;
-
-    // Determine the actual subset of values to process (last 'interval_count' items)
-    size_t start_index = 0;
-    if (all_data_pointers.size() > interval_count) {
-        start_index = all_data_pointers.size() - interval_count;
-    }
+std::vector<const Data*> SegmentTree::collectRecent(int interval_count) const {
+    std::vector<const Data*> recent;
+    size_t limit = static_cast<size_t>(std::max(interval_count, 0));
+    recent.reserve(std::min(limit, idToIndex.size()));
+    // Only the rightmost leaves holding the last 'interval_count' items are visited
+    collectRecentRecursive(root.get(), limit, recent);
+    return recent;
+}
 
-    // Populate values with the relevant feature values from the subset
-    // Note: The order of insertion into the SegmentTree determines the order of data in leaf nodes.
-    // Assuming `nextIndex` increments sequentially for new data, the order of `Data*` in `all_data_pointers`
-    // will generally be the order of insertion.
-    for (size_t i = start_index; i < all_data_pointers.size(); ++i) {
-        if (all_data_pointers[i]) {
-            values.push_back(getFeatureValue(all_data_pointers[i], feature));
-        }
-    }
+// Helper to collect feature values for a given interval, oldest first
+std::vector<float> SegmentTree::collectFeatureValuesForInterval(StatisticFeature feature, int interval_count) const {
+    std::vector<const Data*> recent = collectRecent(interval_count);
+    std::reverse(recent.begin(), recent.end());
+    std::vector<float> values(recent.size());
+    gather_field(recent.data(), recent.size(), statistic_feature_field(feature), values.data());
     return values;
 }
 
@@ -175,6 +221,11 @@ void SegmentTree::insert(const Data* data) { // Changed to const Data*
     int idx = nextIndex++;
     idToIndex[data->id] = idx; // Map Data ID to its allocated index
     insert(root.get(), idx, data); // Call recursive helper
+    quantileInsert(idx, data);
+    if (order_statistics.empty() && histograms.empty()) return;
+    const StatisticFeatureValues values = statistic_feature_values(data);
+    for (size_t f = 0; f < order_statistics.size(); ++f) order_statistics[f].insert(values[f], static_cast<uint64_t>(idx));
+    for (size_t f = 0; f < histograms.size(); ++f) histograms[f].add(values[f]);
 }
 
 // Public remove method
@@ -183,13 +234,62 @@ bool SegmentTree::remove(uint32_t id) {
     auto it = idToIndex.find(id);
     if (it == idToIndex.end()) return false; // ID not found in the tree
 
+    // The values are needed to find the record in the order statistics and histograms
+    const Data* data = (order_statistics.empty() && histograms.empty()) ? nullptr : find(root.get(), it->second, id);
+
     // Call recursive helper to remove
     bool success = remove(root.get(), it->second, id);
-    if (success)
+    if (success) {
+        quantileRemove(it->second);
+        if (data) {
+            const StatisticFeatureValues values = statistic_feature_values(data);
+            for (size_t f = 0; f < order_statistics.size(); ++f) order_statistics[f].erase(values[f], static_cast<uint64_t>(it->second));
+            for (size_t f = 0; f < histograms.size(); ++f) histograms[f].remove(values[f]);
+        }
         idToIndex.erase(it); // Remove mapping if successfully removed from tree
+    }
     return success;
 }
 
+// Batched find: descends PREFETCH_GROUP_SIZE paths in lockstep, prefetching each next child
+void SegmentTree::findMany(const uint32_t* ids, size_t count, const Data** out) const {
+    const Node* cursor[PREFETCH_GROUP_SIZE];
+    int index[PREFETCH_GROUP_SIZE];
+    for (size_t base = 0; base < count; base += PREFETCH_GROUP_SIZE) {
+        size_t group = std::min(PREFETCH_GROUP_SIZE, count - base);
+        bool active = false;
+        for (size_t i = 0; i < group; ++i) {
+            out[base + i] = nullptr;
+            auto it = idToIndex.find(ids[base + i]);
+            cursor[i] = (it != idToIndex.end()) ? root.get() : nullptr;
+            index[i] = (it != idToIndex.end()) ? it->second : 0;
+            active = active || cursor[i];
+        }
+
+        while (active) {
+            active = false;
+            for (size_t i = 0; i < group; ++i) {
+                const Node* node = cursor[i];
+                if (!node) continue;
+                if (node->left == node->right) {
+                    // Leaf: scan its records
+                    for (const Data* d_ptr : node->values) {
+                        if (d_ptr && d_ptr->id == ids[base + i]) { out[base + i] = d_ptr; break; }
+                    }
+                    cursor[i] = nullptr;
+                    continue;
+                }
+                int mid = (node->left + node->right) / 2;
+                cursor[i] = index[i] <= mid ? node->leftChild.get() : node->rightChild.get();
+                if (cursor[i]) {
+                    prefetch_read(cursor[i]);
+                    active = true;
+                }
+            }
+        }
+    }
+}
+
 // Public find method
 const Data* SegmentTree::find(uint32_t id) { // Changed return type to const Data*
     // Find the internal index corresponding to the Data ID
@@ -202,7 +302,24 @@ const Data* SegmentTree::find(uint32_t id) { // Changed return type to const Dat
 
 // Public method to get total rate
 float SegmentTree::getTotalRate() const {
-    return getSum(root.get());
+    return root ? static_cast<float>(root->aggregate.features[static_cast<size_t>(StatisticFeature::RATE)].sum) : 0.0f;
+}
+
+int SegmentTree::indexOf(uint32_t id) const {
+    auto it = idToIndex.find(id);
+    return it == idToIndex.end() ? -1 : it->second;
+}
+
+SegmentTree::Aggregate SegmentTree::aggregateRange(int first_index, int last_index) const {
+    Aggregate out;
+    if (first_index <= last_index) aggregateRange(root.get(), first_index, last_index, out);
+    return out;
+}
+
+SegmentTree::Aggregate SegmentTree::aggregateRecent(int interval_count) const {
+    Aggregate out;
+    if (interval_count > 0) aggregateRecent(root.get(), static_cast<size_t>(interval_count), out);
+    return out;
 }
 
 // NEW: Recursive helper function for calculating memory usage
@@ -232,44 +349,220 @@ size_t SegmentTree::getMemoryUsage() const {
         return 0;
     }
     // Start recursion from the root
-    return getMemoryUsageRecursive(root.get());
+    size_t usage = getMemoryUsageRecursive(root.get());
+    usage += quantile_buckets.capacity() * sizeof(std::unique_ptr<FeatureSketches>);
+    for (const auto& bucket : quantile_buckets)
+        if (bucket) usage += bucket->getMemoryUsage();
+    for (const OrderStatisticList& list : order_statistics) usage += list.getMemoryUsage();
+    for (const LogHistogram& histogram : histograms) usage += histogram.getMemoryUsage();
+    return usage;
+}
+
+
+int SegmentTree::recentIndex(const Node* node, size_t rank) const {
+    while (node->left != node->right) {
+        size_t right_count = node->rightChild ? node->rightChild->aggregate.count : 0;
+        if (rank <= right_count) {
+            node = node->rightChild.get();
+        } else {
+            rank -= right_count;
+            node = node->leftChild.get();
+        }
+    }
+    return node->left;
+}
+
+void SegmentTree::collectRange(const Node* node, int from, int to, std::vector<const Data*>& out) const {
+    if (!node || node->aggregate.count == 0 || to < node->left || node->right < from) return;
+    if (node->left == node->right) {
+        for (const Data* d : node->values)
+            if (d) out.push_back(d);
+        return;
+    }
+    collectRange(node->leftChild.get(), from, to, out);
+    collectRange(node->rightChild.get(), from, to, out);
+}
+
+void SegmentTree::trackQuantiles(double rank_error) {
+    quantile_k = QuantileSketch::kForRankError(rank_error);
+    rebuildQuantiles();
+}
+
+void SegmentTree::quantileInsert(int idx, const Data* data) {
+    if (quantile_k == 0) return;
+    size_t bucket_number = static_cast<size_t>(idx) / QUANTILE_BUCKET_SIZE;
+    if (bucket_number >= quantile_buckets.size()) quantile_buckets.resize(bucket_number + 1);
+    std::unique_ptr<FeatureSketches>& bucket = quantile_buckets[bucket_number];
+    if (!bucket) bucket = std::make_unique<FeatureSketches>(quantile_k);
+    ++bucket->live;
+    bucket->add(*data);
+}
+
+void SegmentTree::quantileRemove(int idx) {
+    if (quantile_k == 0) return;
+    size_t bucket_number = static_cast<size_t>(idx) / QUANTILE_BUCKET_SIZE;
+    if (bucket_number >= quantile_buckets.size() || !quantile_buckets[bucket_number]) return;
+    std::unique_ptr<FeatureSketches>& bucket = quantile_buckets[bucket_number];
+    if (--bucket->live == 0) bucket.reset(); // Emptied, typically by evicting the oldest records
+    else bucket->stale = true;               // Sketches can not forget a value: rebuilt when next needed
 }
 
+void SegmentTree::rebuildQuantiles() {
+    quantile_buckets.clear();
+    if (quantile_k == 0) return;
+    std::vector<const Data*> records;
+    collectRange(root.get(), root->left, root->right, records);
+    for (const Data* d : records) quantileInsert(idToIndex.at(d->id), d);
+}
+
+void SegmentTree::trackOrderStatistics() {
+    order_statistics.clear();
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) order_statistics.emplace_back(f + 1);
+    std::vector<const Data*> records;
+    collectRange(root.get(), root->left, root->right, records);
+    for (const Data* d : records) {
+        int idx = idToIndex.at(d->id);
+        const StatisticFeatureValues values = statistic_feature_values(d);
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) order_statistics[f].insert(values[f], static_cast<uint64_t>(idx));
+    }
+}
+
+void SegmentTree::trackHistograms() {
+    histograms.assign(STATISTIC_FEATURE_COUNT, LogHistogram());
+    std::vector<const Data*> records;
+    collectRange(root.get(), root->left, root->right, records);
+    for (const Data* d : records) {
+        const StatisticFeatureValues values = statistic_feature_values(d);
+        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) histograms[f].add(values[f]);
+    }
+}
+
+bool SegmentTree::histogramMaintained(int interval_count, HistogramScale scale) const {
+    return !histograms.empty() && scale == HistogramScale::LOG && static_cast<size_t>(std::max(interval_count, 0)) >= idToIndex.size();
+}
+
+std::vector<HistogramBin> SegmentTree::getHistogram(StatisticFeature feature, int interval_count, HistogramScale scale, size_t bins) const {
+    if (histogramMaintained(interval_count, scale)) return histograms[static_cast<size_t>(feature)].bins(bins);
+    std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
+    if (scale == HistogramScale::LOG) return log_histogram(values.data(), values.size(), bins);
+    return linear_histogram(values.data(), values.size(), bins);
+}
+
+bool SegmentTree::quantilesExact(int interval_count) const {
+    return quantile_k == 0 || orderStatisticsCover(interval_count) || std::min(idToIndex.size(), static_cast<size_t>(std::max(interval_count, 0))) <= QUANTILE_EXACT_LIMIT;
+}
+
+std::vector<float> SegmentTree::getQuantiles(StatisticFeature feature, int interval_count, const std::vector<double>& qs, bool exact) const {
+    if (orderStatisticsCover(interval_count)) {
+        std::vector<float> result;
+        for (double q : qs) result.push_back(order_statistics[static_cast<size_t>(feature)].quantile(q));
+        return result;
+    }
+    if (exact || quantilesExact(interval_count)) {
+        std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
+        return exact_quantiles(values, qs);
+    }
+
+    size_t f = static_cast<size_t>(feature);
+    size_t needed = std::min(idToIndex.size(), static_cast<size_t>(interval_count));
+    int first = recentIndex(root.get(), needed);
+    size_t first_bucket = static_cast<size_t>(first) / QUANTILE_BUCKET_SIZE;
+    QuantileSketch merged(quantile_k);
+
+    // The oldest bucket is usually only partly inside the interval: its records are added one by one
+    std::vector<const Data*> records;
+    int first_bucket_end = static_cast<int>((first_bucket + 1) * QUANTILE_BUCKET_SIZE) - 1;
+    collectRange(root.get(), first, first_bucket_end, records);
+    std::vector<float> values(records.size());
+    gather_field(records.data(), records.size(), statistic_feature_field(feature), values.data());
+    for (float value : values) merged.add(value);
+
+    for (size_t b = first_bucket + 1; b < quantile_buckets.size(); ++b) {
+        FeatureSketches* bucket = quantile_buckets[b].get();
+        if (!bucket) continue;
+        if (bucket->stale) {
+            records.clear();
+            collectRange(root.get(), static_cast<int>(b * QUANTILE_BUCKET_SIZE), static_cast<int>((b + 1) * QUANTILE_BUCKET_SIZE) - 1, records);
+            bucket->reset();
+            for (const Data* d : records) bucket->add(*d);
+        }
+        merged.merge(bucket->features[f]);
+    }
+    return merged.quantiles(qs);
+}
 
 // Generic statistical methods that take a StatisticFeature enum and interval_count
 float SegmentTree::getAverage(StatisticFeature feature, int interval_count) const {
-    std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
-    if (values.empty()) return 0.0f;
-    return std::accumulate(values.begin(), values.end(), 0.0f) / values.size();
+    return static_cast<float>(aggregateRecent(interval_count).mean(feature));
 }
 
 float SegmentTree::getStdDev(StatisticFeature feature, int interval_count) const {
-    std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
-    if (values.empty()) return 0.0f;
-    float avg = getAverage(feature, interval_count); // Use the same average calculated on the interval
-    float sum_sq_diff = 0.0f;
-    for (float val : values) {
-        sum_sq_diff += (val - avg) * (val - avg);
-    }
-    return (values.size() > 0) ? std::sqrt(sum_sq_diff / values.size()) : 0.0f;
+    return static_cast<float>(std::sqrt(aggregateRecent(interval_count).variance(feature)));
 }
 
 float SegmentTree::getMedian(StatisticFeature feature, int interval_count) const {
-    std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
-    if (values.empty()) return 0.0f;
-    std::sort(values.begin(), values.end());
-    int mid = values.size() / 2;
-    return values.size() % 2 == 0 ? (values[mid - 1] + values[mid]) / 2.0f : values[mid];
+    return getQuantiles(feature, interval_count, {0.5})[0];
 }
 
 float SegmentTree::getMin(StatisticFeature feature, int interval_count) const {
-    std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
-    if (values.empty()) return 0.0f; // Or std::numeric_limits<float>::max();
-    return *std::min_element(values.begin(), values.end());
+    return aggregateRecent(interval_count).min(feature); // 0 when empty
 }
 
 float SegmentTree::getMax(StatisticFeature feature, int interval_count) const {
-    std::vector<float> values = collectFeatureValuesForInterval(feature, interval_count);
-    if (values.empty()) return 0.0f; // Or std::numeric_limits<float>::lowest();
-    return *std::max_element(values.begin(), values.end());
+    return aggregateRecent(interval_count).max(feature); // 0 when empty
+}
+
+bool SegmentTree::orderStatisticsCover(int interval_count) const {
+    return !order_statistics.empty() && static_cast<size_t>(std::max(interval_count, 0)) >= idToIndex.size();
+}
+
+StatsSummary SegmentTree::aggregateSummary(const Aggregate& aggregate, StatisticFeature feature, int interval_count,
+                                           std::vector<const Data*>& recent) const {
+    StatsSummary summary;
+    summary.count = aggregate.count;
+    if (summary.count == 0) return summary;
+    summary.mean = aggregate.mean(feature);
+    summary.variance = aggregate.variance(feature);
+    summary.min = aggregate.min(feature);
+    summary.max = aggregate.max(feature);
+    if (orderStatisticsCover(interval_count) || !quantilesExact(interval_count)) {
+        summary.median = getMedian(feature, interval_count);
+    } else {
+        if (recent.empty()) recent = collectRecent(interval_count);
+        std::vector<float> values(recent.size());
+        gather_field(recent.data(), recent.size(), statistic_feature_field(feature), values.data());
+        summary.median = select_median(values.data(), values.size());
+    }
+    return summary;
+}
+
+StatsSummary SegmentTree::summarize(StatisticFeature feature, int interval_count) const {
+    std::vector<const Data*> recent;
+    return aggregateSummary(aggregateRecent(interval_count), feature, interval_count, recent);
+}
+
+StatsSummary SegmentTree::summarizeField(const NumericField& field, int interval_count) const {
+    StatisticFeature feature;
+    if (statistic_feature_of(field, feature)) return summarize(feature, interval_count);
+    // Other fields have no node aggregates
+    std::vector<const Data*> recent = collectRecent(interval_count);
+    SummaryBuilder builder(recent.size());
+    builder.addField(recent.data(), recent.size(), field);
+    return builder.finish();
+}
+
+GroupSummaries SegmentTree::summarizeByGroup(const NumericField& field, size_t group_offset, int interval_count) const {
+    std::vector<const Data*> recent = collectRecent(interval_count);
+    GroupSummaries groups{};
+    summarize_groups(recent.data(), recent.size(), group_offset, field, groups);
+    return groups;
+}
+
+StatsSummaryRow SegmentTree::summarizeAll(int interval_count) const {
+    Aggregate aggregate = aggregateRecent(interval_count);
+    std::vector<const Data*> recent; // Collected at most once, for the medians that need the values
+    StatsSummaryRow row;
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f)
+        row[f] = aggregateSummary(aggregate, static_cast<StatisticFeature>(f), interval_count, recent);
+    return row;
 }
@@ -7,6 +7,8 @@
 #include <new>     // For placement new
 #include <vector>
 #include <iomanip> // For std::setw
+#include <algorithm> // For std::min
+#include "prefetch.h" // For prefetch_read, PREFETCH_GROUP_SIZE
 
 size_t SkipList::getMemoryUsage() const {
     size_t total_size = sizeof(*head_); // Start with header size
@@ -115,6 +117,39 @@ void SkipList::insert(const Data* data) {
     size_++;
 }
 
+// Batched find: walks PREFETCH_GROUP_SIZE searches down the levels in lockstep, prefetching each next node
+void SkipList::findMany(const uint32_t* keys, size_t count, const Data** out) const {
+    Node* current[PREFETCH_GROUP_SIZE];
+    int level[PREFETCH_GROUP_SIZE];
+    for (size_t base = 0; base < count; base += PREFETCH_GROUP_SIZE) {
+        size_t group = std::min(PREFETCH_GROUP_SIZE, count - base);
+        for (size_t i = 0; i < group; ++i) {
+            current[i] = head_;
+            level[i] = current_level_;
+            out[base + i] = nullptr;
+        }
+
+        size_t active = group;
+        while (active > 0) {
+            active = 0;
+            for (size_t i = 0; i < group; ++i) {
+                if (level[i] < 0) continue; // Finished
+                uint32_t key = keys[base + i];
+                Node* next = current[i]->forward[level[i]];
+                if (next != nullptr && next->key < key) {
+                    current[i] = next;     // Same level, one node to the right
+                } else if (--level[i] < 0) {
+                    // Bottom reached: the candidate is the next node on level 0
+                    if (next != nullptr && next->key == key) out[base + i] = next->value;
+                    continue;
+                }
+                if (current[i]->forward[level[i]]) prefetch_read(current[i]->forward[level[i]]);
+                ++active;
+            }
+        }
+    }
+}
+
 // Find a data element by its key
 const Data* SkipList::find(uint32_t key) const {
     Node* current = head_;
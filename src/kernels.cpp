@@ -0,0 +1,351 @@
+#include "kernels.h"
+#include <algorithm> // For std::min, std::max
+#include <atomic>
+#include <cstring>   // For std::memcpy
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// ---- Scalar reference ----
+
+void reduce_into(Reduction& r, const float* values, size_t n, float shift) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = values[i];
+        if (r.count == 0 || v < r.min) r.min = v;
+        if (r.count == 0 || v > r.max) r.max = v;
+        double d = static_cast<double>(v) - shift;
+        r.sum += d;
+        r.sum_squares += d * d;
+        ++r.count;
+    }
+}
+
+float field_value(const Data* record, size_t offset, FieldType type) {
+    const char* p = reinterpret_cast<const char*>(record) + offset;
+    switch (type) {
+        case FieldType::FLOAT: { float v; std::memcpy(&v, p, sizeof(v)); return v; }
+        case FieldType::UINT8: return static_cast<float>(static_cast<uint8_t>(*p));
+        case FieldType::UINT16: { uint16_t v; std::memcpy(&v, p, sizeof(v)); return static_cast<float>(v); }
+        case FieldType::UINT32: { uint32_t v; std::memcpy(&v, p, sizeof(v)); return static_cast<float>(v); }
+    }
+    return 0.0f;
+}
+
+void reduce_field_into(Reduction& r, const Data* records, size_t n, size_t offset, FieldType type, float shift) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = field_value(records + i, offset, type);
+        reduce_into(r, &v, 1, shift);
+    }
+}
+
+Reduction reduce_scalar(const float* values, size_t n, float shift) {
+    Reduction r;
+    reduce_into(r, values, n, shift);
+    return r;
+}
+
+Reduction reduce_field_scalar(const Data* records, size_t n, size_t offset, FieldType type, float shift) {
+    Reduction r;
+    reduce_field_into(r, records, n, offset, type, shift);
+    return r;
+}
+
+size_t count_in_range_scalar(const float* values, size_t n, float low, float high) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) count += (values[i] >= low && values[i] <= high);
+    return count;
+}
+
+// The bin of 'v' in float arithmetic, the same steps the vector versions take
+inline void histogram_add(float v, float low, float high, float scale, float last_bin, uint64_t* bins) {
+    if (!(v >= low && v <= high)) return;
+    float position = std::min((v - low) * scale, last_bin);
+    ++bins[static_cast<size_t>(position)];
+}
+
+void histogram_scalar(const float* values, size_t n, float low, float high, uint64_t* bins, size_t bin_count) {
+    float scale = static_cast<float>(bin_count) / (high - low);
+    float last_bin = static_cast<float>(bin_count - 1);
+    for (size_t i = 0; i < n; ++i) histogram_add(values[i], low, high, scale, last_bin, bins);
+}
+
+#ifdef KERNELS_X86
+
+// ---- SSE2: 4 floats per step ----
+
+struct Sse2State {
+    __m128 min, max;
+    __m128d sum0, sum1, squares0, squares1;
+};
+
+inline void sse2_step(Sse2State& s, __m128 x, __m128d shift) {
+    s.min = _mm_min_ps(s.min, x);
+    s.max = _mm_max_ps(s.max, x);
+    __m128d low = _mm_sub_pd(_mm_cvtps_pd(x), shift);
+    __m128d high = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), shift);
+    s.sum0 = _mm_add_pd(s.sum0, low);
+    s.sum1 = _mm_add_pd(s.sum1, high);
+    s.squares0 = _mm_add_pd(s.squares0, _mm_mul_pd(low, low));
+    s.squares1 = _mm_add_pd(s.squares1, _mm_mul_pd(high, high));
+}
+
+Reduction sse2_finish(const Sse2State& s, size_t count) {
+    float mins[4], maxs[4];
+    double sums[2], squares[2];
+    _mm_storeu_ps(mins, s.min);
+    _mm_storeu_ps(maxs, s.max);
+    _mm_storeu_pd(sums, _mm_add_pd(s.sum0, s.sum1));
+    _mm_storeu_pd(squares, _mm_add_pd(s.squares0, s.squares1));
+    Reduction r;
+    r.count = count;
+    r.sum = sums[0] + sums[1];
+    r.sum_squares = squares[0] + squares[1];
+    r.min = std::min(std::min(mins[0], mins[1]), std::min(mins[2], mins[3]));
+    r.max = std::max(std::max(maxs[0], maxs[1]), std::max(maxs[2], maxs[3]));
+    return r;
+}
+
+Reduction reduce_sse2(const float* values, size_t n, float shift) {
+    if (n < 4) return reduce_scalar(values, n, shift);
+    Sse2State s;
+    s.min = s.max = _mm_loadu_ps(values);
+    s.sum0 = s.sum1 = s.squares0 = s.squares1 = _mm_setzero_pd();
+    __m128d shift_d = _mm_set1_pd(shift);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) sse2_step(s, _mm_loadu_ps(values + i), shift_d);
+    Reduction r = sse2_finish(s, i);
+    reduce_into(r, values + i, n - i, shift);
+    return r;
+}
+
+size_t count_in_range_sse2(const float* values, size_t n, float low, float high) {
+    __m128 low_v = _mm_set1_ps(low), high_v = _mm_set1_ps(high);
+    size_t count = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        __m128 inside = _mm_and_ps(_mm_cmpge_ps(x, low_v), _mm_cmple_ps(x, high_v));
+        count += static_cast<size_t>(__builtin_popcount(_mm_movemask_ps(inside)));
+    }
+    return count + count_in_range_scalar(values + i, n - i, low, high);
+}
+
+void histogram_sse2(const float* values, size_t n, float low, float high, uint64_t* bins, size_t bin_count) {
+    float scale = static_cast<float>(bin_count) / (high - low);
+    float last_bin = static_cast<float>(bin_count - 1);
+    __m128 low_v = _mm_set1_ps(low), high_v = _mm_set1_ps(high);
+    __m128 scale_v = _mm_set1_ps(scale), last_v = _mm_set1_ps(last_bin);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(values + i);
+        int inside = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(x, low_v), _mm_cmple_ps(x, high_v)));
+        if (!inside) continue;
+        // Out-of-range lanes may hold garbage indices; they are masked out below
+        __m128 position = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(x, low_v), scale_v), last_v);
+        alignas(16) int32_t index[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(position));
+        for (int lane = 0; lane < 4; ++lane)
+            if (inside & (1 << lane)) ++bins[index[lane]];
+    }
+    for (; i < n; ++i) histogram_add(values[i], low, high, scale, last_bin, bins);
+}
+
+// ---- AVX2: 8 floats per step, gathers for strided fields ----
+
+struct Avx2State {
+    __m256 min, max;
+    __m256d sum0, sum1, squares0, squares1;
+};
+
+__attribute__((target("avx2")))
+inline void avx2_step(Avx2State& s, __m256 x, __m256d shift) {
+    s.min = _mm256_min_ps(s.min, x);
+    s.max = _mm256_max_ps(s.max, x);
+    __m256d low = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), shift);
+    __m256d high = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), shift);
+    s.sum0 = _mm256_add_pd(s.sum0, low);
+    s.sum1 = _mm256_add_pd(s.sum1, high);
+    s.squares0 = _mm256_add_pd(s.squares0, _mm256_mul_pd(low, low));
+    s.squares1 = _mm256_add_pd(s.squares1, _mm256_mul_pd(high, high));
+}
+
+__attribute__((target("avx2")))
+Reduction avx2_finish(const Avx2State& s, size_t count) {
+    alignas(32) float mins[8], maxs[8];
+    alignas(32) double sums[4], squares[4];
+    _mm256_store_ps(mins, s.min);
+    _mm256_store_ps(maxs, s.max);
+    _mm256_store_pd(sums, _mm256_add_pd(s.sum0, s.sum1));
+    _mm256_store_pd(squares, _mm256_add_pd(s.squares0, s.squares1));
+    Reduction r;
+    r.count = count;
+    r.sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    r.sum_squares = (squares[0] + squares[1]) + (squares[2] + squares[3]);
+    r.min = *std::min_element(mins, mins + 8);
+    r.max = *std::max_element(maxs, maxs + 8);
+    return r;
+}
+
+__attribute__((target("avx2")))
+void avx2_init(Avx2State& s, __m256 first) {
+    s.min = s.max = first;
+    s.sum0 = s.sum1 = s.squares0 = s.squares1 = _mm256_setzero_pd();
+}
+
+__attribute__((target("avx2")))
+Reduction reduce_avx2(const float* values, size_t n, float shift) {
+    if (n < 8) return reduce_scalar(values, n, shift);
+    Avx2State s;
+    avx2_init(s, _mm256_loadu_ps(values));
+    __m256d shift_d = _mm256_set1_pd(shift);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) avx2_step(s, _mm256_loadu_ps(values + i), shift_d);
+    Reduction r = avx2_finish(s, i);
+    reduce_into(r, values + i, n - i, shift);
+    return r;
+}
+
+// Eight records' field as floats, from one 32-bit gather. Narrower fields read a few bytes past
+// the field, which stay inside the record for every record but the last.
+__attribute__((target("avx2")))
+inline __m256 avx2_gather_field(const char* base, __m256i byte_offsets, FieldType type) {
+    if (type == FieldType::FLOAT) return _mm256_i32gather_ps(reinterpret_cast<const float*>(base), byte_offsets, 1);
+    __m256i raw = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base), byte_offsets, 1);
+    if (type == FieldType::UINT8) return _mm256_cvtepi32_ps(_mm256_and_si256(raw, _mm256_set1_epi32(0xFF)));
+    if (type == FieldType::UINT16) return _mm256_cvtepi32_ps(_mm256_and_si256(raw, _mm256_set1_epi32(0xFFFF)));
+    // UINT32 does not fit the signed conversion: convert both 16-bit halves
+    __m256 high = _mm256_cvtepi32_ps(_mm256_srli_epi32(raw, 16));
+    __m256 low = _mm256_cvtepi32_ps(_mm256_and_si256(raw, _mm256_set1_epi32(0xFFFF)));
+    return _mm256_add_ps(_mm256_mul_ps(high, _mm256_set1_ps(65536.0f)), low);
+}
+
+__attribute__((target("avx2")))
+Reduction reduce_field_avx2(const Data* records, size_t n, size_t offset, FieldType type, float shift) {
+    if (n < 9) return reduce_field_scalar(records, n, offset, type, shift);
+    const int stride = static_cast<int>(sizeof(Data));
+    __m256i byte_offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(stride));
+    const char* base = reinterpret_cast<const char*>(records) + offset;
+    Avx2State s;
+    avx2_init(s, avx2_gather_field(base, byte_offsets, type));
+    __m256d shift_d = _mm256_set1_pd(shift);
+    size_t i = 0;
+    // At least the last record is left to the scalar loop (see avx2_gather_field)
+    for (; i + 8 < n; i += 8) avx2_step(s, avx2_gather_field(base + i * sizeof(Data), byte_offsets, type), shift_d);
+    Reduction r = avx2_finish(s, i);
+    reduce_field_into(r, records + i, n - i, offset, type, shift);
+    return r;
+}
+
+__attribute__((target("avx2")))
+size_t count_in_range_avx2(const float* values, size_t n, float low, float high) {
+    __m256 low_v = _mm256_set1_ps(low), high_v = _mm256_set1_ps(high);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(values + i);
+        __m256 inside = _mm256_and_ps(_mm256_cmp_ps(x, low_v, _CMP_GE_OQ), _mm256_cmp_ps(x, high_v, _CMP_LE_OQ));
+        count += static_cast<size_t>(__builtin_popcount(_mm256_movemask_ps(inside)));
+    }
+    return count + count_in_range_scalar(values + i, n - i, low, high);
+}
+
+__attribute__((target("avx2")))
+void histogram_avx2(const float* values, size_t n, float low, float high, uint64_t* bins, size_t bin_count) {
+    float scale = static_cast<float>(bin_count) / (high - low);
+    float last_bin = static_cast<float>(bin_count - 1);
+    __m256 low_v = _mm256_set1_ps(low), high_v = _mm256_set1_ps(high);
+    __m256 scale_v = _mm256_set1_ps(scale), last_v = _mm256_set1_ps(last_bin);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(values + i);
+        int inside = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x, low_v, _CMP_GE_OQ), _mm256_cmp_ps(x, high_v, _CMP_LE_OQ)));
+        if (!inside) continue;
+        // Out-of-range lanes may hold garbage indices; they are masked out below
+        __m256 position = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(x, low_v), scale_v), last_v);
+        alignas(32) int32_t index[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(index), _mm256_cvttps_epi32(position));
+        for (int lane = 0; lane < 8; ++lane)
+            if (inside & (1 << lane)) ++bins[index[lane]];
+    }
+    for (; i < n; ++i) histogram_add(values[i], low, high, scale, last_bin, bins);
+}
+
+#endif // KERNELS_X86
+
+struct KernelTable {
+    Reduction (*reduce)(const float*, size_t, float);
+    Reduction (*reduce_field)(const Data*, size_t, size_t, FieldType, float);
+    size_t (*count_in_range)(const float*, size_t, float, float);
+    void (*histogram)(const float*, size_t, float, float, uint64_t*, size_t);
+};
+
+const KernelTable SCALAR_KERNELS = {reduce_scalar, reduce_field_scalar, count_in_range_scalar, histogram_scalar};
+#ifdef KERNELS_X86
+// SSE2 has no gather: strided fields stay scalar
+const KernelTable SSE2_KERNELS = {reduce_sse2, reduce_field_scalar, count_in_range_sse2, histogram_sse2};
+const KernelTable AVX2_KERNELS = {reduce_avx2, reduce_field_avx2, count_in_range_avx2, histogram_avx2};
+#endif
+
+const KernelTable& table_for(SimdLevel level) {
+#ifdef KERNELS_X86
+    if (level == SimdLevel::AVX2) return AVX2_KERNELS;
+    if (level == SimdLevel::SSE2) return SSE2_KERNELS;
+#endif
+    (void)level;
+    return SCALAR_KERNELS;
+}
+
+std::atomic<SimdLevel>& active_level() {
+    static std::atomic<SimdLevel> level{detected_simd_level()};
+    return level;
+}
+
+inline const KernelTable& active_kernels() {
+    return table_for(active_level().load(std::memory_order_relaxed));
+}
+
+} // namespace
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+SimdLevel detected_simd_level() {
+#ifdef KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+SimdLevel active_simd_level() {
+    return active_level().load(std::memory_order_relaxed);
+}
+
+void set_simd_level(SimdLevel level) {
+    active_level().store(std::min(level, detected_simd_level()), std::memory_order_relaxed);
+}
+
+Reduction reduce(const float* values, size_t n, float shift) {
+    return active_kernels().reduce(values, n, shift);
+}
+
+Reduction reduce_field(const Data* records, size_t n, size_t offset, FieldType type, float shift) {
+    return active_kernels().reduce_field(records, n, offset, type, shift);
+}
+
+size_t count_in_range(const float* values, size_t n, float low, float high) {
+    return active_kernels().count_in_range(values, n, low, high);
+}
+
+void histogram(const float* values, size_t n, float low, float high, uint64_t* bins, size_t bin_count) {
+    if (bin_count == 0 || !(high > low)) return;
+    active_kernels().histogram(values, n, low, high, bins, bin_count);
+}
@@ -0,0 +1,218 @@
+#include "logger.h"
+#include <cstdlib>   // For std::getenv
+#include <cstring>   // For std::memcpy, std::strlen
+#include <ctime>     // For gmtime_r
+
+namespace {
+
+uint32_t current_thread_number() {
+    static std::atomic<uint32_t> next_thread{1};
+    thread_local uint32_t number = next_thread.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+size_t round_up_to_power_of_two(size_t n) {
+    size_t capacity = 2;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+FILE* open_binary_log() {
+    const char* path = std::getenv("LOG_BINARY_FILE");
+    return (path && *path) ? std::fopen(path, "ab") : nullptr;
+}
+
+} // namespace
+
+const char* log_level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+bool parse_log_level(const std::string& name, LogLevel& level) {
+    if (name == "debug") level = LogLevel::DEBUG;
+    else if (name == "info") level = LogLevel::INFO;
+    else if (name == "warn") level = LogLevel::WARN;
+    else if (name == "error") level = LogLevel::ERROR;
+    else if (name == "off") level = LogLevel::OFF;
+    else return false;
+    return true;
+}
+
+Logger::Logger(size_t capacity, FILE* out, FILE* err, LogSink sink)
+    : out(out), err(err), sink(sink) {
+    capacity = round_up_to_power_of_two(capacity);
+    slots.reset(new Slot[capacity]);
+    mask = capacity - 1;
+    for (size_t i = 0; i < capacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    flusher = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    stop();
+}
+
+Logger& Logger::instance() {
+    static FILE* binary = open_binary_log();
+    static Logger logger(DEFAULT_CAPACITY, binary ? binary : stdout, stderr, binary ? LogSink::BINARY : LogSink::TEXT);
+    static const bool configured = [] {
+        LogLevel level;
+        const char* name = std::getenv("LOG_LEVEL");
+        if (name && parse_log_level(name, level)) logger.setLevel(level);
+        return true;
+    }();
+    (void)configured;
+    return logger;
+}
+
+LogRecord* Logger::claim(size_t& ticket) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots[pos & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                ticket = pos;
+                return &slot.record;
+            }
+        } else if (diff < 0) {
+            // The slot still holds a record from one lap ago: the ring is full
+            dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::commit(size_t ticket) {
+    slots[ticket & mask].sequence.store(ticket + 1, std::memory_order_release);
+}
+
+void Logger::appendText(std::vector<char>& batch, const LogRecord& record) {
+    // "2026-01-31T12:34:56.789012Z INFO  [t3] text", the date part formatted once per second
+    int64_t second = static_cast<int64_t>(record.timestamp_ns / 1000000000ull);
+    if (second != cached_second) {
+        std::time_t t = static_cast<std::time_t>(second);
+        std::tm utc;
+        gmtime_r(&t, &utc);
+        std::strftime(cached_prefix, sizeof(cached_prefix), "%Y-%m-%dT%H:%M:%S.", &utc);
+        cached_second = second;
+    }
+    char head[96];
+    char* p = head;
+    size_t prefix_length = std::strlen(cached_prefix);
+    std::memcpy(p, cached_prefix, prefix_length);
+    p += prefix_length;
+    uint32_t micros = static_cast<uint32_t>(record.timestamp_ns % 1000000000ull / 1000);
+    for (int digit = 5; digit >= 0; --digit, micros /= 10) p[digit] = static_cast<char>('0' + micros % 10);
+    p += 6;
+    *p++ = 'Z';
+    *p++ = ' ';
+    const char* level = log_level_name(record.level);
+    size_t level_length = std::strlen(level);
+    std::memcpy(p, level, level_length);
+    p += level_length;
+    for (size_t pad = level_length; pad < 6; ++pad) *p++ = ' ';
+    *p++ = '[';
+    *p++ = 't';
+    p = std::to_chars(p, head + sizeof(head) - 2, record.thread).ptr; // Leaves room for "] "
+    *p++ = ']';
+    *p++ = ' ';
+
+    batch.insert(batch.end(), head, p);
+    batch.insert(batch.end(), record.text, record.text + record.length);
+    if (record.truncated) batch.insert(batch.end(), {'.', '.', '.'});
+    batch.push_back('\n');
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    uint64_t drained = 0;
+    for (;;) {
+        Slot& slot = slots[dequeue_pos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1) break; // Not committed yet
+        const LogRecord& record = slot.record;
+        if (sink == LogSink::BINARY) {
+            const char* bytes = reinterpret_cast<const char*>(&record);
+            out_batch.insert(out_batch.end(), bytes, bytes + offsetof(LogRecord, text) + record.length);
+        } else {
+            appendText(record.level >= LogLevel::WARN ? err_batch : out_batch, record);
+        }
+        slot.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+        ++dequeue_pos;
+        ++drained;
+    }
+    if (!out_batch.empty()) {
+        std::fwrite(out_batch.data(), 1, out_batch.size(), out);
+        std::fflush(out);
+        out_batch.clear();
+    }
+    if (!err_batch.empty()) {
+        std::fwrite(err_batch.data(), 1, err_batch.size(), err);
+        std::fflush(err);
+        err_batch.clear();
+    }
+    written_count.fetch_add(drained, std::memory_order_relaxed);
+}
+
+void Logger::run() {
+    while (running.load(std::memory_order_acquire)) {
+        drain();
+        std::this_thread::sleep_for(FLUSH_INTERVAL);
+    }
+}
+
+void Logger::flush() {
+    drain();
+}
+
+void Logger::stop() {
+    running.store(false, std::memory_order_release);
+    if (flusher.joinable()) flusher.join();
+    drain();
+}
+
+LogLine::LogLine(Logger& logger, LogLevel level)
+    : logger(logger), record(logger.claim(ticket)) {
+    if (!record) return;
+    record->timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    record->thread = current_thread_number();
+    record->level = level;
+    record->truncated = 0;
+    record->length = 0;
+}
+
+LogLine::~LogLine() {
+    if (record) logger.commit(ticket);
+}
+
+LogLine& LogLine::operator<<(const char* text) {
+    append(text, std::strlen(text));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const void* pointer) {
+    char digits[24] = {'0', 'x'};
+    auto result = std::to_chars(digits + 2, digits + sizeof(digits), reinterpret_cast<uintptr_t>(pointer), 16);
+    append(digits, static_cast<size_t>(result.ptr - digits));
+    return *this;
+}
+
+void LogLine::append(const char* text, size_t n) {
+    if (!record) return;
+    size_t room = LOG_TEXT_CAPACITY - record->length;
+    if (n > room) {
+        n = room;
+        record->truncated = 1;
+    }
+    std::memcpy(record->text + record->length, text, n);
+    record->length = static_cast<uint16_t>(record->length + n);
+}
@@ -1,6 +1,5 @@
 // Script criado por Geimini A1.
 
-#include <iostream>     // For std::cout, std::cerr, std::endl
 #include <string>       // For std::string, std::stoi, std::stoul
 #include <vector>       // For std::vector
 #include <csignal>      // For signal, SIGINT, SIGTERM
@@ -15,76 +14,106 @@
 #include <cstring>      // For strlen, strncmp
 #include <memory>       // For std::unique_ptr, std::make_unique
 #include <map>          // For parsing query parameters
-#include <unordered_map> // For the new indices
-#include <unordered_set> // For efficiently finding intersections
+#include <cctype>       // For std::isdigit
+#include <cstdlib>      // For std::getenv, std::strtoul
 
 #include <zmq.hpp>      // For ZeroMQ C++ bindings (zmq::context_t, zmq::socket_t, zmq::message_t, zmq::error_t)
 #include <zmq.h>        // For ZMQ_DONTWAIT (C-style ZMQ constants)
 
 #include "network/data_receiver.h" // Your existing DataReceiver class
+#include "network/query_publisher.h" // PUB socket for continuous queries
 #include "data.h"                  // The Data struct definition
 #include "essential/AVL.h"         // Include for AVL tree
 #include "essential/LinkedList.h"  // Include for DoublyLinkedList
+#include "stats_summary.h"         // Single-pass StatsSummary for PERFORM_STATS
+#include "kernels.h"               // For the SIMD level the statistics kernels dispatch to
+#include "thread_pool.h"           // Shared workers for statistics over large windows
 #include "essential/HashTable.h"   // Include for Chaining HashTable
 #include "extra/CuckooHashTable.h" // Include for CuckooHashTable
 #include "extra/SegmentTree.h"     // Include for SegmentTree
 #include "essential/RBTree.h"      // Include for Red-Black Tree
 #include "extra/SkipList.h"        // NEW: Include for SkipList
+#include "query/QueryCursor.h"     // Server-side cursors for paginated queries
+#include "query/SortedIndex.h"     // Ordered secondary indexes for sort_by
+#include "query/RecordStore.h"     // Slot-addressed owner of the records
+#include "query/ColumnStore.h"     // Optional column-wise copy of the records for scans
+#include "query/CategoricalIndex.h" // Bitmap indexes for the categorical filters
+#include "query/QueryPlanner.h"    // Cost-based planning for QUERY_FILTERED_SORTED
+#include "query/ResultCache.h"     // LRU cache of replies, invalidated by the ingest epoch
+#include "query/Subscription.h"    // Continuous filter/stats queries evaluated per batch
+#include "query/AnomalyScorer.h"   // EWMA baselines and per-record anomaly scores at ingest
+#include "server/LatencyStats.h"   // Per-command latency histograms for STATS_SERVER
+#include "server/TimeRollup.h"     // Per-second / per-minute aggregates for ROLLUP
+#include "logger.h"                  // Asynchronous logger (LOG_INFO, LOG_DEBUG, ...)
+#include "server/ResponseFormatter.h" // to_chars formatting into pooled, zero-copy reply buffers
 
 // Global atomic boolean to signal termination for all loops
 std::atomic<bool> keep_running(true);
 
 // Constants for data cleanup (NEW)
+// Default number of records kept before the oldest are evicted; MASTER_STORE_CAPACITY overrides it
 const size_t MASTER_STORE_CAPACITY_THRESHOLD = 30000; 
 const size_t CLEANUP_BATCH_SIZE = DATA_RECEIVER_CAPACITY * 0.1; 
 
 // NEW: Constante para simular a redução da frequência do processador (R7)
 const std::chrono::microseconds PROCESSING_DELAY_PER_ITEM(50); 
 
+// Number of formatted rows per ZMQ frame when a reply is streamed as a multipart message
+const size_t STREAM_ROWS_PER_FRAME = 256;
+
+// Upper bound on the ids of one MULTI_GET request
+const size_t MAX_MULTI_GET_IDS = 65536;
+
+// How long a cached reply may be served after new batches arrived. The GUI polls these commands,
+// so a slightly old answer is preferred to recomputing it on every refresh.
+const std::chrono::milliseconds PERFORM_STATS_CACHE_TOLERANCE(1000);
+const std::chrono::milliseconds QUERY_CACHE_TOLERANCE(250);
+
+// PERFORM_STATS intervals the linked list keeps running aggregates for (the GUI defaults to 100)
+const int STATS_WINDOW_SIZES[] = {100, 1000, 10000};
+
+// Normalized rank error of the quantile sketches behind PERFORM_QUANTILES and long-interval medians
+const double QUANTILE_RANK_ERROR = 0.01;
+
+// Time rollups behind ROLLUP: one hour of per-second buckets and one day of per-minute buckets
+const size_t ROLLUP_SECONDS_KEPT = 3600;
+const size_t ROLLUP_MINUTES_KEPT = 1440;
+// Buckets a ROLLUP without from= returns
+const int64_t ROLLUP_DEFAULT_BUCKETS = 60;
+
+// Bins of a HISTOGRAM reply: the default, and the most a request may ask for
+const size_t HISTOGRAM_DEFAULT_BINS = 32;
+const size_t HISTOGRAM_MAX_BINS = 1024;
+
+// Topic of the anomaly alerts on the continuous query PUB socket
+const char* const ANOMALY_ALERT_TOPIC = "alert";
+
 // Signal handler function
 void signal_handler(int signum) {
     if (signum == SIGINT || signum == SIGTERM) {
-        std::cout << "\nInterrupt signal (" << signum << ") received. Shutting down..." << std::endl;
+        LOG_INFO("Interrupt signal (" << signum << ") received. Shutting down...");
         keep_running = false;
     }
 }
 
-// Helper function to format a Data struct into a concise string (for last 3 items display)
-std::string format_data_for_reply(const Data& data_item) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(2); // Set precision for float values
-    oss << "ID: " << data_item.id
-        << ", Dur: " << data_item.dur << "s"
-        << ", SBytes: " << data_item.sbytes
-        << ", DBytes: " << data_item.dbytes
-        << ", Rate: " << data_item.rate
-        << ", Proto: " << static_cast<int>(data_item.proto)
-        << ", Label: " << (data_item.label ? "Attack" : "Normal");
-    return oss.str();
+// Sends 'buffer' as one frame without copying it; ZMQ gives it back to the BufferPool once sent
+void send_buffer(zmq::socket_t& socket, PooledBuffer buffer, int flags) {
+    ResponseBuffer* raw = buffer.release();
+    zmq::message_t msg(raw->data(), raw->size(), BufferPool::zmqFree, raw);
+    socket.send(msg, flags);
 }
 
-// New helper function to format a Data struct into a detailed table string
-std::string format_data_as_table(const Data& data_item) {
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(4); // Use higher precision for floats
-
-    oss << "--- Data Record Details (ID: " << data_item.id << ") ---\n";
-    oss << "ID: " << data_item.id << "\n";
-    oss << "Duration (s): " << data_item.dur << "\n";
-    oss << "Rate (pkts/s): " << data_item.rate << "\n";
-    oss << "Source Load (bytes/s): " << data_item.sload << "\n";
-    oss << "Destination Load (bytes/s): " << data_item.dload << "\n";
-    oss << "Source Packets: " << data_item.spkts << "\n";
-    oss << "Dest Packets: " << data_item.dpkts << "\n";
-    oss << "Source Bytes: " << data_item.sbytes << "\n";
-    oss << "Dest Bytes: " << data_item.dbytes << "\n";
-    oss << "Label (Attack): " << (data_item.label ? "True" : "False") << "\n";
-    oss << "Protocol: " << static_cast<int>(data_item.proto) << "\n";
-    oss << "State: " << static_cast<int>(data_item.state) << "\n";
-    oss << "Service: " << static_cast<int>(data_item.service) << "\n";
-    oss << "Attack Category: " << static_cast<int>(data_item.attack_category) << "\n";
-    oss << "--------------------------------------\n";
-    return oss.str();
+// Sends 'header' followed by the rows as a multipart reply, STREAM_ROWS_PER_FRAME rows per frame,
+// so large result pages are never concatenated into a single reply.
+void send_streamed_reply(zmq::socket_t& socket, PooledBuffer header, OutputFormat format,
+                         const std::vector<const Data*>& rows, size_t first_row_number) {
+    send_buffer(socket, std::move(header), rows.empty() ? 0 : ZMQ_SNDMORE);
+    for (size_t start = 0; start < rows.size(); start += STREAM_ROWS_PER_FRAME) {
+        size_t end = std::min(rows.size(), start + STREAM_ROWS_PER_FRAME);
+        PooledBuffer frame = BufferPool::instance().acquire();
+        append_rows(*frame, format, rows.data() + start, end - start, first_row_number + start, true);
+        send_buffer(socket, std::move(frame), end < rows.size() ? ZMQ_SNDMORE : 0);
+    }
 }
 
 // Helper function to get a string representation of the data structure name
@@ -97,27 +126,35 @@ std::string get_ds_name_by_id(int ds_id) {
         case 5: return "Segment Tree";
         case 6: return "Red-Black Tree";
         case 7: return "SkipList"; 
+        case 8: return "Column Store";
         default: return "Unknown";
     }
 }
 
-// Helper function to parse query strings like "key1=val1 key2=val2" into a map
+// Helper function to parse query strings like "key1=val1 key2=val2" into a map.
+// Comparison filters keep their operator in the key: "sbytes>=1e6" -> {"sbytes>=", "1e6"},
+// "dur<0.5" -> {"dur<", "0.5"} and "proto!=6" -> {"proto!", "6"}.
 std::map<std::string, std::string> parse_query_params(const std::string& query) {
     std::map<std::string, std::string> params;
     std::stringstream ss(query);
     std::string item;
     while (ss >> item) {
-        size_t pos = item.find('=');
-        if (pos != std::string::npos) {
-            params[item.substr(0, pos)] = item.substr(pos + 1);
-        }
+        size_t pos = item.find_first_of("<>!=");
+        if (pos == std::string::npos || pos == 0) continue;
+        size_t value_pos = item.find_first_not_of("<>!=", pos);
+        std::string op = item.substr(pos, value_pos == std::string::npos ? std::string::npos : value_pos - pos);
+        std::string value = value_pos == std::string::npos ? "" : item.substr(value_pos);
+        std::string key = item.substr(0, pos);
+        if (op == "=") params[key] = value;
+        else if (op == "!=") params[key + "!"] = value;
+        else params[key + op] = value;
     }
     return params;
 }
 
 // Function to clean up old data from master_data_store and all data structures
 void cleanup_old_data(
-    std::vector<std::unique_ptr<Data>>& master_data_store,
+    RecordStore& master_data_store,
     AVL& avl_tree,
     DoublyLinkedList& doubly_linked_list,
     HashTable& hash_table,
@@ -125,19 +162,21 @@ void cleanup_old_data(
     SegmentTree& segment_tree,
     RBTree& rb_tree,
     SkipList& skip_list,
-    std::unordered_map<bool, std::vector<const Data*>>& label_index,
-    std::unordered_map<int, std::vector<const Data*>>& proto_index,
+    CategoricalIndexes& categorical_indexes,
+    SortedIndexes& sorted_indexes,
+    CursorManager& cursor_manager,
+    ColumnStore* column_store,
     size_t num_items_to_remove)
 {
-    std::cout << "[DEBUG] cleanup_old_data function called." << std::endl;
+    LOG_DEBUG("cleanup_old_data function called.");
 
     if (master_data_store.empty() || num_items_to_remove == 0) {
-        std::cout << "[INFO] Nenhuma limpeza necessária: master_data_store vazio ou num_items_to_remove é zero." << std::endl;
+        LOG_INFO("Nenhuma limpeza necessária: master_data_store vazio ou num_items_to_remove é zero.");
         return;
     }
 
     size_t actual_items_to_remove = std::min(num_items_to_remove, master_data_store.size());
-    std::cout << "[INFO] Iniciando limpeza: removendo " << actual_items_to_remove << " itens de dados mais antigos." << std::endl;
+    LOG_INFO("Iniciando limpeza: removendo " << actual_items_to_remove << " itens de dados mais antigos.");
 
     std::vector<uint32_t> ids_to_remove;
     ids_to_remove.reserve(actual_items_to_remove);
@@ -148,6 +187,10 @@ void cleanup_old_data(
         }
     }
 
+    for (size_t i = 0; i < actual_items_to_remove; ++i) {
+        sorted_indexes.remove(master_data_store[i]);
+    }
+
     for (uint32_t id : ids_to_remove) {
         avl_tree.removeById(id);
         doubly_linked_list.removeById(id);
@@ -158,36 +201,93 @@ void cleanup_old_data(
         skip_list.remove(id);
     }
 
-    master_data_store.erase(master_data_store.begin(), master_data_store.begin() + actual_items_to_remove);
-    std::cout << "[INFO] Removido " << actual_items_to_remove << " itens do master_data_store. Novo tamanho: " << master_data_store.size() << std::endl;
+    master_data_store.evictOldest(actual_items_to_remove);
+    if (column_store) column_store->evictOldest(actual_items_to_remove); // Same slots as master_data_store
+    LOG_INFO("Removido " << actual_items_to_remove << " itens do master_data_store. Novo tamanho: " << master_data_store.size());
+
+    // Evicted records are always the lowest slots, so the bitmaps only drop a prefix
+    categorical_indexes.evictBelow(master_data_store.firstSlot());
+    LOG_INFO("Índices categóricos atualizados (primeiro slot vivo: " << master_data_store.firstSlot() << ").");
 
-    label_index.clear();
-    proto_index.clear();
-    for (const auto& data_ptr_unique : master_data_store) {
-        Data* data_item = data_ptr_unique.get(); 
-        label_index[data_item->label].push_back(data_item);
-        proto_index[static_cast<int>(data_item->proto)].push_back(data_item);
+    // Cursors hold raw pointers into master_data_store, so they expire with the evicted records
+    if (cursor_manager.size() > 0) {
+        LOG_INFO("Invalidando " << cursor_manager.size() << " cursores abertos.");
+        cursor_manager.invalidateAll();
     }
-    std::cout << "[INFO] Índices 'label_index' e 'proto_index' reconstruídos." << std::endl;
 }
 
 
 int main() {
+    // Start the logger's flusher before the signal handlers can log
+    Logger::instance();
+    LOG_INFO("Statistics kernels: " << simd_level_name(active_simd_level())
+             << ", " << ThreadPool::instance().concurrency() << " threads for large windows");
+
+    size_t master_store_capacity = MASTER_STORE_CAPACITY_THRESHOLD;
+    if (const char* configured = std::getenv("MASTER_STORE_CAPACITY")) {
+        size_t parsed = std::strtoul(configured, nullptr, 10);
+        if (parsed > 0) master_store_capacity = parsed;
+    }
+    LOG_INFO("Retention window: " << master_store_capacity << " records");
+    // COLUMN_STORE=1 keeps a column-wise copy of the records (ds_id 8) for scans over many rows
+    const char* column_store_setting = std::getenv("COLUMN_STORE");
+    bool column_store_enabled = column_store_setting && std::strcmp(column_store_setting, "0") != 0;
+    LOG_INFO("Column store: " << (column_store_enabled ? "enabled" : "disabled"));
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
     // --- Instantiate Data Structures ---
     AVL avl_tree;
     DoublyLinkedList doubly_linked_list;
+    for (int window_size : STATS_WINDOW_SIZES) doubly_linked_list.trackWindow(window_size);
+    doubly_linked_list.trackQuantiles(QUANTILE_RANK_ERROR);
+    doubly_linked_list.trackOrderStatistics(); // Exact medians and percentiles over the whole retention window
+    doubly_linked_list.trackHistograms();      // HISTOGRAM over the whole retention window in O(buckets)
     HashTable hash_table;
     CuckooHashTable cuckoo_hash_table;
     SegmentTree segment_tree;
+    segment_tree.trackQuantiles(QUANTILE_RANK_ERROR);
+    segment_tree.trackOrderStatistics();
+    segment_tree.trackHistograms();
     RBTree rb_tree;
     SkipList skip_list; 
     
     // --- NEW: Instantiate Indexing Data Structures ---
-    std::unordered_map<bool, std::vector<const Data*>> label_index;
-    std::unordered_map<int, std::vector<const Data*>> proto_index; 
+    CategoricalIndexes categorical_indexes; // label, proto, state, service and attack_cat bitmaps
+
+    SortedIndexes sorted_indexes; // dur, rate, sbytes, dbytes and id, maintained on insert and evict
+
+    // --- Server-side cursors for QUERY_FILTERED_SORTED / FETCH ---
+    CursorManager cursor_manager;
+
+    // --- Reply cache for PERFORM_STATS / QUERY_FILTERED_SORTED ---
+    ResultCache result_cache;
+    result_cache.setTolerance("PERFORM_STATS", PERFORM_STATS_CACHE_TOLERANCE);
+    result_cache.setTolerance("PERFORM_QUANTILES", PERFORM_STATS_CACHE_TOLERANCE);
+    result_cache.setTolerance("GROUP_STATS", PERFORM_STATS_CACHE_TOLERANCE);
+    result_cache.setTolerance("HISTOGRAM", PERFORM_STATS_CACHE_TOLERANCE);
+    result_cache.setTolerance("QUERY_FILTERED_SORTED", QUERY_CACHE_TOLERANCE);
+    uint64_t ingested_batches = 0; // Ingest half of the cache epoch
+
+    // --- Time rollups of the ingested batches, stamped with their ingest time ---
+    TimeRollup rollup_seconds(1000, ROLLUP_SECONDS_KEPT);
+    TimeRollup rollup_minutes(60 * 1000, ROLLUP_MINUTES_KEPT);
+
+    // --- Continuous queries: evaluated once per batch and pushed to subscribers ---
+    SubscriptionManager subscription_manager;
+    QueryPublisher query_publisher;
+    query_publisher.start();
+
+    // --- Anomaly scoring of every ingested record, alerts published on the same socket ---
+    AnomalyScorer anomaly_scorer;
+    anomaly_scorer.groupBy(CategoricalField::SERVICE);
+    std::vector<AnomalyAlert> anomaly_alerts;
+
+    // --- Latency histograms per command / ds_id / phase ---
+    ServerStats server_stats({"GET_DATA", "QUERY_DATA_BY_ID", "MULTI_GET", "MULTI_GET_BIN", "REMOVE_DATA_BY_ID",
+                              "PERFORM_STATS", "PERFORM_QUANTILES", "GROUP_STATS", "ROLLUP", "HISTOGRAM", "ANOMALY_BASELINES", "QUERY_FILTERED_SORTED", "EXPLAIN", "FETCH", "CLOSE_CURSOR",
+                              "SUBSCRIBE", "UNSUBSCRIBE", "LIST_SUBSCRIPTIONS", "CACHE_STATS", "STATS_SERVER"});
+    auto last_poll = std::chrono::steady_clock::now();
     
     // --- Setup DataReceiver ---
     DataReceiver data_collector("tcp://python_publisher:5556", "data_batch", "data_batch");
@@ -198,7 +298,13 @@ int main() {
     zmq::socket_t rep_socket(rep_context, ZMQ_REP);
     rep_socket.bind("tcp://*:5558");
 
-    std::vector<std::unique_ptr<Data>> master_data_store;
+    RecordStore master_data_store;
+    QueryPlanner query_planner(master_data_store, categorical_indexes, sorted_indexes);
+    std::unique_ptr<ColumnStore> column_store;
+    if (column_store_enabled) {
+        column_store = std::make_unique<ColumnStore>();
+        query_planner.setColumnStore(column_store.get());
+    }
 
     while (keep_running.load()) {
         // NEW: Get a view of currently collected data from DataReceiver
@@ -209,9 +315,11 @@ int main() {
         // Process data in chunks as provided by DataReceiver
         size_t processed_count_in_this_cycle = 0;
         if (num_items_in_view > 0) {
+            uint32_t batch_first_slot = master_data_store.endSlot();
             for (size_t i = 0; i < num_items_in_view; ++i) {
-                master_data_store.push_back(std::make_unique<Data>(received_data_ptr[i]));
-                Data* data_to_insert = master_data_store.back().get();
+                uint32_t slot = master_data_store.append(received_data_ptr[i]);
+                const Data* data_to_insert = master_data_store.at(slot);
+                if (column_store) column_store->append(received_data_ptr[i]);
 
                 avl_tree.insert(data_to_insert);
                 doubly_linked_list.append(data_to_insert);
@@ -221,18 +329,41 @@ int main() {
                 rb_tree.insert(data_to_insert);
                 skip_list.insert(data_to_insert); 
 
-                label_index[data_to_insert->label].push_back(data_to_insert);
-                proto_index[static_cast<int>(data_to_insert->proto)].push_back(data_to_insert);
+                categorical_indexes.insert(data_to_insert, slot);
+                sorted_indexes.insert(data_to_insert, slot);
 
                 std::this_thread::sleep_for(PROCESSING_DELAY_PER_ITEM);
             }
             processed_count_in_this_cycle = num_items_in_view;
+            ++ingested_batches;
+
+            int64_t ingest_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            rollup_seconds.addBatch(received_data_ptr, num_items_in_view, ingest_ms);
+            rollup_minutes.addBatch(received_data_ptr, num_items_in_view, ingest_ms);
+
+            anomaly_alerts.clear();
+            anomaly_scorer.onBatch(received_data_ptr, num_items_in_view, anomaly_alerts);
+            for (const AnomalyAlert& alert : anomaly_alerts) query_publisher.publish(ANOMALY_ALERT_TOPIC, format_alert(alert));
+
+            // Push the batch to the continuous queries before any of it can be evicted
+            if (subscription_manager.size() > 0) {
+                std::vector<Publication> publications;
+                subscription_manager.onBatch(master_data_store, batch_first_slot, master_data_store.endSlot(), publications);
+                PooledBuffer payload = BufferPool::instance().acquire();
+                for (const Publication& publication : publications) {
+                    payload->clear();
+                    payload->append(publication.header);
+                    append_rows(*payload, OutputFormat::TEXT, publication.rows.data(), publication.rows.size(), 1, false);
+                    query_publisher.publish(publication.topic, payload->data(), payload->size());
+                }
+            }
             // Mark the processed items as consumed in DataReceiver
             data_collector.markDataAsConsumed(processed_count_in_this_cycle);
         }
 
         // Check for cleanup after processing any new data
-        if (master_data_store.size() >= MASTER_STORE_CAPACITY_THRESHOLD) {
+        if (master_data_store.size() >= master_store_capacity) {
             cleanup_old_data(
                 master_data_store,
                 avl_tree,
@@ -242,8 +373,10 @@ int main() {
                 segment_tree,
                 rb_tree,
                 skip_list,
-                label_index,
-                proto_index,
+                categorical_indexes,
+                sorted_indexes,
+                cursor_manager,
+                column_store.get(),
                 CLEANUP_BATCH_SIZE
             );
         }
@@ -252,34 +385,45 @@ int main() {
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
         
         zmq::message_t request_msg;
+        auto poll_time = std::chrono::steady_clock::now();
         if (rep_socket.recv(&request_msg, ZMQ_DONTWAIT)) {
+            auto received_time = std::chrono::steady_clock::now();
+            RequestTimer timer(server_stats, received_time, received_time - last_poll);
             std::string request_str(static_cast<char*>(request_msg.data()), request_msg.size());
             std::string reply_str;
-            std::cout << "[DEBUG] Received request: '" << request_str << "'" << std::endl;
+            PooledBuffer reply_buffer; // When set, sent zero-copy instead of reply_str
+            bool reply_sent = false; // Set when a handler already sent a (multipart) reply
+            LOG_DEBUG("Received request: '" << request_str << "'");
 
             // --- Command Handling ---
             std::stringstream ss(request_str);
             std::string command;
             ss >> command;
+            timer.setCommand(command);
+            CacheEpoch epoch{ingested_batches, master_data_store.firstSlot()};
 
             if (command == "GET_DATA") {
-                std::ostringstream oss_reply;
+                timer.enter(RequestPhase::FORMAT);
+                reply_buffer = BufferPool::instance().acquire();
                 int count = 0;
                 if (master_data_store.empty()) {
-                    oss_reply << "No data collected yet.";
+                    reply_buffer->append("No data collected yet.");
                 } else {
-                    oss_reply << "Last 3 received data records:\n";
-                    for (auto it = master_data_store.rbegin(); it != master_data_store.rend() && count < 3; ++it) {
-                        oss_reply << format_data_for_reply(*((*it).get())) << "\n";
+                    reply_buffer->append("Last 3 received data records:\n");
+                    for (size_t i = master_data_store.size(); i > 0 && count < 3; --i) {
+                        append_record_summary(*reply_buffer, *master_data_store[i - 1]);
+                        reply_buffer->append('\n');
                         count++;
                     }
                 }
-                reply_str = oss_reply.str();
             } else if (command == "QUERY_DATA_BY_ID") {
                 uint32_t id;
                 int ds_id;
                 if (ss >> id >> ds_id) {
+                    timer.setDsId(ds_id);
+                    timer.enter(RequestPhase::EXECUTE);
                     const Data* found_data = nullptr;
+                    Data column_record; // Rebuilt from the column store for ds_id 8
                     switch (ds_id) {
                         case 1: { auto node = avl_tree.queryById(id); if(node) found_data = node->data; break; }
                         case 2: found_data = doubly_linked_list.findById(id); break;
@@ -288,19 +432,108 @@ int main() {
                         case 5: found_data = segment_tree.find(id); break;
                         case 6: found_data = rb_tree.find(id); break;
                         case 7: found_data = skip_list.find(id); break; 
+                        case 8:
+                            // The id index gives the slot, the columns give the record back
+                            if (column_store) {
+                                sorted_indexes.walkRange(SortField::ID, id, id, [&](const IndexEntry& entry) {
+                                    if (column_store->read(entry.slot, column_record)) found_data = &column_record;
+                                });
+                            }
+                            break;
                     }
+                    timer.enter(RequestPhase::FORMAT);
                     if (found_data) {
-                        reply_str = "Found data in " + get_ds_name_by_id(ds_id) + ":\n" + format_data_as_table(*found_data);
+                        reply_buffer = BufferPool::instance().acquire();
+                        reply_buffer->append("Found data in " + get_ds_name_by_id(ds_id) + ":\n");
+                        append_record_table(*reply_buffer, *found_data);
                     } else {
                         reply_str = "No data with ID " + std::to_string(id) + " found in " + get_ds_name_by_id(ds_id) + ".";
                     }
                 } else {
                     reply_str = "Error: Malformed QUERY_DATA_BY_ID command.";
                 }
+            } else if (command == "MULTI_GET" || command == "MULTI_GET_BIN") {
+                // Text:   "MULTI_GET <ds_id> id1 id2 ..." -> one line per id.
+                // Binary: "MULTI_GET_BIN <ds_id> " followed by the ids as raw uint32 -> [uint32 requested]
+                //         [uint32 found][one byte per id, 1 = found][the found Data records, packed, in request order]
+                bool binary = (command == "MULTI_GET_BIN");
+                int ds_id = 0;
+                std::vector<uint32_t> ids;
+                bool well_formed = static_cast<bool>(ss >> ds_id);
+                if (well_formed && binary) {
+                    ss.get(); // Single separator before the raw ids
+                    std::streamoff offset = ss.tellg();
+                    size_t id_bytes = (offset < 0) ? 0 : request_str.size() - static_cast<size_t>(offset);
+                    well_formed = offset >= 0 && id_bytes % sizeof(uint32_t) == 0;
+                    if (well_formed) {
+                        ids.resize(id_bytes / sizeof(uint32_t));
+                        std::memcpy(ids.data(), request_str.data() + offset, id_bytes);
+                    }
+                } else if (well_formed) {
+                    uint32_t id;
+                    while (ss >> id) ids.push_back(id);
+                    well_formed = ss.eof();
+                }
+
+                std::vector<const Data*> found(ids.size(), nullptr);
+                if (!well_formed || ids.empty()) {
+                    reply_str = "Error: Malformed " + command + " command.";
+                } else if (ids.size() > MAX_MULTI_GET_IDS) {
+                    reply_str = "Error: " + command + " accepts at most " + std::to_string(MAX_MULTI_GET_IDS) + " ids.";
+                } else if (ds_id < 1 || ds_id > 7) {
+                    reply_str = "Error: Unknown data structure " + std::to_string(ds_id) + ".";
+                } else {
+                    timer.setDsId(ds_id);
+                    timer.enter(RequestPhase::EXECUTE);
+                    switch (ds_id) {
+                        case 1: avl_tree.findMany(ids.data(), ids.size(), found.data()); break;
+                        case 2: doubly_linked_list.findMany(ids.data(), ids.size(), found.data()); break;
+                        case 3: hash_table.findMany(ids.data(), ids.size(), found.data()); break;
+                        case 4: cuckoo_hash_table.findMany(ids.data(), ids.size(), found.data()); break;
+                        case 5: segment_tree.findMany(ids.data(), ids.size(), found.data()); break;
+                        case 6: rb_tree.findMany(ids.data(), ids.size(), found.data()); break;
+                        case 7: skip_list.findMany(ids.data(), ids.size(), found.data()); break;
+                    }
+                    uint32_t found_count = static_cast<uint32_t>(std::count_if(found.begin(), found.end(),
+                                                                               [](const Data* d) { return d != nullptr; }));
+                    timer.enter(RequestPhase::FORMAT);
+                    if (binary) {
+                        uint32_t requested = static_cast<uint32_t>(ids.size());
+                        reply_str.resize(2 * sizeof(uint32_t) + ids.size() + found_count * sizeof(Data));
+                        char* out = &reply_str[0];
+                        std::memcpy(out, &requested, sizeof(requested));
+                        std::memcpy(out + sizeof(uint32_t), &found_count, sizeof(found_count));
+                        char* flags = out + 2 * sizeof(uint32_t);
+                        char* records = flags + ids.size();
+                        for (size_t i = 0; i < found.size(); ++i) {
+                            flags[i] = found[i] ? 1 : 0;
+                            if (found[i]) {
+                                std::memcpy(records, found[i], sizeof(Data));
+                                records += sizeof(Data);
+                            }
+                        }
+                    } else {
+                        reply_buffer = BufferPool::instance().acquire();
+                        reply_buffer->append("Found ");
+                        reply_buffer->appendUInt(found_count);
+                        reply_buffer->append(" of ");
+                        reply_buffer->appendUInt(ids.size());
+                        reply_buffer->append(" ids in " + get_ds_name_by_id(ds_id) + ":\n");
+                        for (size_t i = 0; i < ids.size(); ++i) {
+                            reply_buffer->appendUInt(ids[i]);
+                            reply_buffer->append(": ");
+                            if (found[i]) append_record_summary(*reply_buffer, *found[i]);
+                            else reply_buffer->append("not found");
+                            reply_buffer->append('\n');
+                        }
+                    }
+                }
             } else if (command == "REMOVE_DATA_BY_ID") {
                     uint32_t id;
                     int ds_id;
                     if (ss >> id >> ds_id) {
+                        timer.setDsId(ds_id);
+                        timer.enter(RequestPhase::EXECUTE);
                         bool removed = false;
                         switch(ds_id) {
                             case 1: { avl_tree.removeById(id); removed = true; break; } 
@@ -311,7 +544,9 @@ int main() {
                             case 6: removed = rb_tree.remove(id); break;
                             case 7: removed = skip_list.remove(id); break; 
                         }
+                        timer.enter(RequestPhase::FORMAT);
                         if (removed) {
+                            result_cache.invalidateAll();
                             reply_str = "Successfully removed reference to ID " + std::to_string(id) + " from " + get_ds_name_by_id(ds_id) + ".";
                         } else {
                             reply_str = "Could not remove data with ID " + std::to_string(id) + " from " + get_ds_name_by_id(ds_id) + " (not found).";
@@ -320,128 +555,501 @@ int main() {
                         reply_str = "Error: Malformed REMOVE_DATA_BY_ID command.";
                     }
             } else if (command == "PERFORM_STATS") {
-                int feature_enum_val, interval, ds_id;
-                if (ss >> feature_enum_val >> interval >> ds_id) {
-                    StatisticFeature feature = static_cast<StatisticFeature>(feature_enum_val);
+                // "PERFORM_STATS <feature> <interval> <ds_id>"; feature is a StatisticFeature number, the name of
+                // any numeric field (e.g. sttl), or ALL to summarize every StatisticFeature in the same pass
+                std::string feature_str;
+                int interval, ds_id;
+                const NumericField* field = nullptr; // Resolved once, before the traversal
+                std::string cache_key;
+                if (ss >> feature_str >> interval >> ds_id) {
+                    bool all_features = (feature_str == "ALL");
+                    if (!all_features) {
+                        try {
+                            int feature_enum_val = std::stoi(feature_str);
+                            if (feature_enum_val >= 0 && feature_enum_val < static_cast<int>(STATISTIC_FEATURE_COUNT))
+                                field = &statistic_feature_field(static_cast<StatisticFeature>(feature_enum_val));
+                        } catch (const std::exception&) {
+                            field = find_numeric_field(feature_str);
+                        }
+                    }
+                    if (all_features || field) {
+                        cache_key = "PERFORM_STATS " + feature_str + " " + std::to_string(interval) + " " + std::to_string(ds_id);
+                        timer.setDsId(ds_id);
+                        timer.enter(RequestPhase::EXECUTE);
+                    }
+                }
+                if (!cache_key.empty() && result_cache.lookup(command, cache_key, epoch, reply_str)) {
+                    // Served from the cache
+                } else if (!cache_key.empty()) {
                     std::ostringstream oss_stats;
                     oss_stats << std::fixed << std::setprecision(4);
                     oss_stats << "Statistics for " << get_ds_name_by_id(ds_id) << " over last " << interval << " items:\n";
-                    
-                    if (ds_id == 2) { // DoublyLinkedList
-                        oss_stats << "  Average: " << doubly_linked_list.getAverage(feature, interval) << "\n";
-                        oss_stats << "  Std Dev: " << doubly_linked_list.getStdDev(feature, interval) << "\n";
-                        oss_stats << "  Median:  " << doubly_linked_list.getMedian(feature, interval) << "\n";
-                        oss_stats << "  Min:     " << doubly_linked_list.getMin(feature, interval) << "\n";
-                        oss_stats << "  Max:     " << doubly_linked_list.getMax(feature, interval) << "\n";
-                    } else if (ds_id == 5) { // SegmentTree
-                        oss_stats << "  Average: " << segment_tree.getAverage(feature, interval) << "\n";
-                        oss_stats << "  Std Dev: " << segment_tree.getStdDev(feature, interval) << "\n";
-                        oss_stats << "  Median:  " << segment_tree.getMedian(feature, interval) << "\n";
-                        oss_stats << "  Min:     " << segment_tree.getMin(feature, interval) << "\n";
-                        oss_stats << "  Max:     " << segment_tree.getMax(feature, interval) << "\n";
-                    } else {
+
+                    if (ds_id == 8 && !column_store) {
+                        oss_stats << "  The column store is disabled (start the server with COLUMN_STORE=1).";
+                    } else if (ds_id != 2 && ds_id != 5 && ds_id != 8) {
                         oss_stats << "  Statistics are not implemented for this data structure.";
+                    } else if (feature_str == "ALL") {
+                        StatsSummaryRow row = (ds_id == 2) ? doubly_linked_list.summarizeAll(interval)
+                                            : (ds_id == 5) ? segment_tree.summarizeAll(interval)
+                                                           : column_store->summarizeAll(interval);
+                        timer.enter(RequestPhase::FORMAT);
+                        oss_stats << "  " << std::left << std::setw(8) << "feature" << std::right << std::setw(16) << "average"
+                                  << std::setw(16) << "std dev" << std::setw(16) << "median" << std::setw(16) << "min"
+                                  << std::setw(16) << "max" << "\n";
+                        for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+                            const StatsSummary& summary = row[f];
+                            oss_stats << "  " << std::left << std::setw(8) << statistic_feature_name(static_cast<StatisticFeature>(f)) << std::right
+                                      << std::setw(16) << static_cast<float>(summary.mean) << std::setw(16) << static_cast<float>(summary.stddev())
+                                      << std::setw(16) << summary.median << std::setw(16) << summary.min << std::setw(16) << summary.max << "\n";
+                        }
+                    } else {
+                        // One traversal for all five statistics
+                        StatsSummary summary = (ds_id == 2) ? doubly_linked_list.summarizeField(*field, interval)
+                                             : (ds_id == 5) ? segment_tree.summarizeField(*field, interval)
+                                                            : column_store->summarizeField(*field, interval);
+                        timer.enter(RequestPhase::FORMAT);
+                        oss_stats << "  Average: " << static_cast<float>(summary.mean) << "\n";
+                        oss_stats << "  Std Dev: " << static_cast<float>(summary.stddev()) << "\n";
+                        oss_stats << "  Median:  " << summary.median << "\n";
+                        oss_stats << "  Min:     " << summary.min << "\n";
+                        oss_stats << "  Max:     " << summary.max << "\n";
                     }
                     reply_str = oss_stats.str();
+                    result_cache.store(cache_key, epoch, reply_str);
                 } else {
                     reply_str = "Error: Malformed PERFORM_STATS command.";
                 }
+            } else if (command == "PERFORM_QUANTILES") {
+                // "PERFORM_QUANTILES <feature> <interval> <q1,q2,...> <ds_id> [exact]", each q in [0, 1]
+                int feature_enum_val = -1, interval = 0, ds_id = 0;
+                std::string qs_str, mode;
+                std::vector<double> qs;
+                bool parsed = static_cast<bool>(ss >> feature_enum_val >> interval >> qs_str >> ds_id);
+                if (parsed && ss >> mode && mode != "exact") parsed = false;
+                std::istringstream qs_stream(qs_str);
+                for (std::string q_str; parsed && std::getline(qs_stream, q_str, ',');) {
+                    try {
+                        size_t used = 0;
+                        double q = std::stod(q_str, &used);
+                        if (used != q_str.size() || !(q >= 0.0 && q <= 1.0)) parsed = false;
+                        qs.push_back(q);
+                    } catch (const std::exception&) {
+                        parsed = false;
+                    }
+                }
+                if (!parsed || qs.empty() || interval <= 0 || feature_enum_val < 0 ||
+                    feature_enum_val >= static_cast<int>(STATISTIC_FEATURE_COUNT)) {
+                    reply_str = "Error: Malformed PERFORM_QUANTILES command.";
+                } else if (ds_id != 2 && ds_id != 5) {
+                    reply_str = "Quantiles are not implemented for " + get_ds_name_by_id(ds_id) + ".";
+                } else {
+                    bool exact = (mode == "exact");
+                    std::string cache_key = "PERFORM_QUANTILES " + std::to_string(feature_enum_val) + " " + std::to_string(interval) +
+                                            " " + qs_str + " " + std::to_string(ds_id) + (exact ? " exact" : "");
+                    timer.setDsId(ds_id);
+                    timer.enter(RequestPhase::EXECUTE);
+                    if (!result_cache.lookup(command, cache_key, epoch, reply_str)) {
+                        StatisticFeature feature = static_cast<StatisticFeature>(feature_enum_val);
+                        std::vector<float> values;
+                        double rank_error = 0.0;
+                        if (ds_id == 2) {
+                            values = doubly_linked_list.getQuantiles(feature, interval, qs, exact);
+                            if (!exact && !doubly_linked_list.quantilesExact(interval)) rank_error = QUANTILE_RANK_ERROR;
+                        } else {
+                            values = segment_tree.getQuantiles(feature, interval, qs, exact);
+                            if (!exact && !segment_tree.quantilesExact(interval)) rank_error = QUANTILE_RANK_ERROR;
+                        }
+                        timer.enter(RequestPhase::FORMAT);
+                        std::ostringstream oss_quantiles;
+                        oss_quantiles << std::fixed << std::setprecision(4);
+                        oss_quantiles << "Quantiles of " << statistic_feature_name(feature) << " for " << get_ds_name_by_id(ds_id)
+                                      << " over last " << interval << " items (";
+                        if (rank_error > 0.0) oss_quantiles << "sketch, rank error <= " << rank_error * 100.0 << "%):\n";
+                        else oss_quantiles << "exact):\n";
+                        for (size_t i = 0; i < qs.size(); ++i) {
+                            oss_quantiles << "  q=" << qs[i] << ": " << values[i] << "\n";
+                        }
+                        reply_str = oss_quantiles.str();
+                        result_cache.store(cache_key, epoch, reply_str);
+                    }
+                }
+            }
+            else if (command == "GROUP_STATS") {
+                // "GROUP_STATS group_by=<attack_cat|proto|service|state|label> feature=<number or field name> interval=<n> [ds_id=2|5]"
+                std::string query_str;
+                std::getline(ss, query_str);
+                std::map<std::string, std::string> params = parse_query_params(query_str);
+                CategoricalField group_by;
+                const NumericField* field = nullptr;
+                int interval = 0, ds_id = 2;
+                bool parsed = params.count("group_by") && parse_categorical_field(params["group_by"], group_by) &&
+                              params.count("feature") && params.count("interval");
+                try {
+                    if (parsed) {
+                        interval = std::stoi(params["interval"]);
+                        if (params.count("ds_id")) ds_id = std::stoi(params["ds_id"]);
+                        const std::string& feature_str = params["feature"];
+                        if (!feature_str.empty() && std::isdigit(static_cast<unsigned char>(feature_str[0]))) {
+                            int feature_enum_val = std::stoi(feature_str);
+                            if (feature_enum_val < static_cast<int>(STATISTIC_FEATURE_COUNT))
+                                field = &statistic_feature_field(static_cast<StatisticFeature>(feature_enum_val));
+                        } else {
+                            field = find_numeric_field(feature_str);
+                        }
+                    }
+                } catch (const std::exception&) {
+                    parsed = false;
+                }
+                std::string cache_key;
+                if (!parsed || !field || interval <= 0) {
+                    reply_str = "Error: Malformed GROUP_STATS command.";
+                } else if (ds_id != 2 && ds_id != 5) {
+                    reply_str = "Grouped statistics are not implemented for " + get_ds_name_by_id(ds_id) + ".";
+                } else {
+                    cache_key = normalize_request(command, params);
+                    timer.setDsId(ds_id);
+                    timer.enter(RequestPhase::EXECUTE);
+                    if (!result_cache.lookup(command, cache_key, epoch, reply_str)) {
+                        size_t group_offset = categorical_field_offset(group_by);
+                        GroupSummaries groups = (ds_id == 2) ? doubly_linked_list.summarizeByGroup(*field, group_offset, interval)
+                                                             : segment_tree.summarizeByGroup(*field, group_offset, interval);
+                        timer.enter(RequestPhase::FORMAT);
+                        std::ostringstream oss_groups;
+                        oss_groups << std::fixed << std::setprecision(4);
+                        oss_groups << "Statistics of " << field->name << " by " << categorical_field_name(group_by) << " for "
+                                   << get_ds_name_by_id(ds_id) << " over last " << interval << " items:\n";
+                        oss_groups << "  " << std::left << std::setw(8) << "value" << std::right << std::setw(10) << "count"
+                                   << std::setw(16) << "average" << std::setw(16) << "std dev" << std::setw(16) << "min"
+                                   << std::setw(16) << "max" << "\n";
+                        for (size_t value = 0; value < groups.size(); ++value) {
+                            const GroupSummary& group = groups[value];
+                            if (group.count == 0) continue;
+                            oss_groups << "  " << std::left << std::setw(8) << value << std::right << std::setw(10) << group.count
+                                       << std::setw(16) << static_cast<float>(group.mean()) << std::setw(16) << static_cast<float>(group.stddev())
+                                       << std::setw(16) << group.min << std::setw(16) << group.max << "\n";
+                        }
+                        reply_str = oss_groups.str();
+                        result_cache.store(cache_key, epoch, reply_str);
+                    }
+                }
+            }
+            else if (command == "HISTOGRAM") {
+                // "HISTOGRAM <feature> <interval> [buckets=log|linear] [n=<bins>] [ds_id=2|5]"; one "low high count" line per bin
+                std::string feature_str;
+                int interval = 0;
+                bool parsed = static_cast<bool>(ss >> feature_str >> interval) && interval > 0;
+                std::string query_str;
+                std::getline(ss, query_str);
+                std::map<std::string, std::string> params = parse_query_params(query_str);
+                int feature_index = -1;
+                for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+                    if (feature_str == statistic_feature_name(static_cast<StatisticFeature>(f)) || feature_str == std::to_string(f))
+                        feature_index = static_cast<int>(f);
+                }
+                HistogramScale scale = HistogramScale::LOG;
+                if (params.count("buckets") && params["buckets"] == "linear") scale = HistogramScale::LINEAR;
+                else if (params.count("buckets") && params["buckets"] != "log") parsed = false;
+                size_t bins = HISTOGRAM_DEFAULT_BINS;
+                int ds_id = 2;
+                try {
+                    if (params.count("n")) bins = std::stoul(params["n"]);
+                    if (params.count("ds_id")) ds_id = std::stoi(params["ds_id"]);
+                } catch (const std::exception&) {
+                    parsed = false;
+                }
+                if (!parsed || feature_index < 0 || bins == 0 || bins > HISTOGRAM_MAX_BINS) {
+                    reply_str = "Error: Malformed HISTOGRAM command.";
+                } else if (ds_id != 2 && ds_id != 5) {
+                    reply_str = "Histograms are not implemented for " + get_ds_name_by_id(ds_id) + ".";
+                } else {
+                    std::string cache_key = "HISTOGRAM " + std::to_string(feature_index) + " " + std::to_string(interval) + " " +
+                                            std::to_string(static_cast<int>(scale)) + " " + std::to_string(bins) + " " + std::to_string(ds_id);
+                    timer.setDsId(ds_id);
+                    timer.enter(RequestPhase::EXECUTE);
+                    if (!result_cache.lookup(command, cache_key, epoch, reply_str)) {
+                        StatisticFeature feature = static_cast<StatisticFeature>(feature_index);
+                        std::vector<HistogramBin> histogram = (ds_id == 2) ? doubly_linked_list.getHistogram(feature, interval, scale, bins)
+                                                                           : segment_tree.getHistogram(feature, interval, scale, bins);
+                        timer.enter(RequestPhase::FORMAT);
+                        std::ostringstream oss_histogram;
+                        oss_histogram << std::setprecision(6);
+                        oss_histogram << "Histogram of " << statistic_feature_name(feature) << " for " << get_ds_name_by_id(ds_id)
+                                      << " over last " << interval << " items (" << (scale == HistogramScale::LOG ? "log" : "linear")
+                                      << ", " << histogram.size() << " bins):\n";
+                        for (const HistogramBin& bin : histogram) {
+                            oss_histogram << "  " << bin.low << " " << bin.high << " " << bin.count << "\n";
+                        }
+                        reply_str = oss_histogram.str();
+                        result_cache.store(cache_key, epoch, reply_str);
+                    }
+                }
+            }
+            else if (command == "ANOMALY_BASELINES") {
+                // "ANOMALY_BASELINES [group=<value of the grouping field>]": the EWMA baselines records are scored against
+                std::string query_str;
+                std::getline(ss, query_str);
+                std::map<std::string, std::string> params = parse_query_params(query_str);
+                int group = -1;
+                try {
+                    if (params.count("group")) group = std::stoi(params["group"]);
+                } catch (const std::exception&) {
+                    group = 256;
+                }
+                if (group > 255 || (params.count("group") && group < 0) || (group >= 0 && !anomaly_scorer.grouped())) {
+                    reply_str = "Error: Malformed ANOMALY_BASELINES command.";
+                } else {
+                    timer.enter(RequestPhase::EXECUTE);
+                    const FeatureBaselines& baselines = group >= 0 ? anomaly_scorer.groupBaselines(static_cast<uint8_t>(group))
+                                                                   : anomaly_scorer.baselines();
+                    timer.enter(RequestPhase::FORMAT);
+                    std::ostringstream oss_baselines;
+                    oss_baselines << std::fixed << std::setprecision(4);
+                    oss_baselines << "Anomaly baselines (EWMA of log1p(value), alpha " << anomaly_scorer.alpha() << ", alert at |z| >= "
+                                  << anomaly_scorer.threshold() << ")";
+                    if (group >= 0) oss_baselines << " for " << categorical_field_name(anomaly_scorer.groupField()) << "=" << group;
+                    oss_baselines << "; " << anomaly_scorer.scoredCount() << " records scored, " << anomaly_scorer.alertCount() << " alerts:\n";
+                    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+                        oss_baselines << "  " << std::left << std::setw(8) << statistic_feature_name(static_cast<StatisticFeature>(f)) << std::right
+                                      << std::setw(12) << baselines[f].count << std::setw(16) << baselines[f].mean
+                                      << std::setw(16) << baselines[f].stdDev() << "\n";
+                    }
+                    reply_str = oss_baselines.str();
+                }
             }
-            else if (command == "QUERY_FILTERED_SORTED") {
-                size_t prefix_len = command.length() + 1;
-                std::map<std::string, std::string> params;
-                if (request_str.length() > prefix_len) {
-                    params = parse_query_params(request_str.substr(prefix_len));
+            else if (command == "ROLLUP") {
+                // "ROLLUP resolution=<second|minute> feature=<number or name> [from=<unix ms>] [to=<unix ms>]";
+                // one line per non-empty bucket: start, count, feature statistics, label and attack category counts
+                std::string query_str;
+                std::getline(ss, query_str);
+                std::map<std::string, std::string> params = parse_query_params(query_str);
+                const TimeRollup* rollup = nullptr;
+                if (params["resolution"] == "second") rollup = &rollup_seconds;
+                else if (params["resolution"] == "minute") rollup = &rollup_minutes;
+                int feature_index = -1;
+                for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+                    if (params["feature"] == statistic_feature_name(static_cast<StatisticFeature>(f)) || params["feature"] == std::to_string(f))
+                        feature_index = static_cast<int>(f);
                 }
+                int64_t to_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                int64_t from_ms = 0;
+                bool parsed = rollup && feature_index >= 0;
+                try {
+                    if (parsed && params.count("to")) to_ms = std::stoll(params["to"]);
+                    if (parsed) from_ms = params.count("from") ? std::stoll(params["from"]) : to_ms - ROLLUP_DEFAULT_BUCKETS * rollup->resolutionMs();
+                } catch (const std::exception&) {
+                    parsed = false;
+                }
+                if (!parsed) {
+                    reply_str = "Error: Malformed ROLLUP command.";
+                } else {
+                    timer.enter(RequestPhase::EXECUTE);
+                    std::vector<const RollupBucket*> buckets = rollup->series(from_ms, to_ms);
+                    timer.enter(RequestPhase::FORMAT);
+                    std::ostringstream oss_rollup;
+                    oss_rollup << std::fixed << std::setprecision(4);
+                    oss_rollup << "Rollup of " << statistic_feature_name(static_cast<StatisticFeature>(feature_index)) << " per "
+                               << params["resolution"] << ", " << buckets.size() << " buckets:\n";
+                    oss_rollup << "  start_ms count average std_dev min max normal attack attack_cat_counts\n";
+                    for (const RollupBucket* bucket : buckets) {
+                        const RollupFeature& feature = bucket->features[feature_index];
+                        oss_rollup << "  " << bucket->startMs(rollup->resolutionMs()) << " " << bucket->count << " "
+                                   << static_cast<float>(feature.mean(bucket->count)) << " " << static_cast<float>(feature.stddev(bucket->count))
+                                   << " " << feature.min << " " << feature.max << " " << bucket->labels[0] << " " << bucket->labels[1] << " ";
+                        for (size_t c = 0; c < ATTACK_CATEGORY_COUNT; ++c) oss_rollup << (c ? "," : "") << bucket->attack_categories[c];
+                        oss_rollup << "\n";
+                    }
+                    reply_str = oss_rollup.str();
+                }
+            }
+            else if (command == "QUERY_FILTERED_SORTED" || command == "EXPLAIN") {
+                // "EXPLAIN QUERY_FILTERED_SORTED ..." runs the planned query and replies with the plan instead of the rows
+                bool explain = (command == "EXPLAIN");
+                std::string target = command;
+                if (explain) ss >> target;
+                std::string query_str;
+                std::getline(ss, query_str);
+                std::map<std::string, std::string> params = parse_query_params(query_str);
+
+                QueryRequest query;
+                std::string query_error;
+                OutputFormat format = OutputFormat::TEXT;
+                // Replies that open a cursor or are streamed are never cached, nor are EXPLAIN timings
+                std::string cache_key;
+                if (target != "QUERY_FILTERED_SORTED") {
+                    reply_str = "Error: EXPLAIN only supports QUERY_FILTERED_SORTED.";
+                } else if (!parse_query_request(params, query, query_error)) {
+                    reply_str = "Error: " + query_error;
+                } else if (params.count("format") && !parse_output_format(params["format"], format)) {
+                    reply_str = "Error: Unknown format '" + params["format"] + "' (expected text, json or csv).";
+                } else if (!explain && !query.want_cursor && !query.stream &&
+                           result_cache.lookup(command, cache_key = normalize_request(command, params), epoch, reply_str)) {
+                    // Served from the cache
+                } else {
+                    timer.enter(RequestPhase::EXECUTE);
+                    auto plan_start = std::chrono::steady_clock::now();
+                    QueryPlan plan = query_planner.plan(query);
+                    QueryExecution execution;
+                    execution.plan_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - plan_start).count();
+                    PartialOrder order = query_planner.execute(plan, execution);
 
-                // Filtering
-                std::vector<const Data*> candidate_list;
-                bool is_first_filter = true;
+                    std::vector<const Data*> page;
+                    order.next(query.page_size, page);
+
+                    // Formatting reply
+                    timer.enter(RequestPhase::FORMAT);
+                    if (explain) {
+                        reply_str = query_planner.explain(plan, execution);
+                    } else {
+                        PageInfo page_info{execution.total_matches, 1, 0, 0};
+                        std::string text_header = "Found " + std::to_string(execution.total_matches) + " matching records. Displaying top results:\n";
+                        if (query.want_cursor && order.remaining() > 0) {
+                            page_info.remaining = order.remaining();
+                            page_info.cursor_id = cursor_manager.open(std::move(order), page.size());
+                            text_header += "Cursor: " + std::to_string(page_info.cursor_id) + " (" + std::to_string(page_info.remaining) +
+                                           " more records, use FETCH " + std::to_string(page_info.cursor_id) + " <n>)\n";
+                        }
+                        text_header += "-----------------------------------------------------------------\n";
 
-                if (params.count("label")) {
-                    bool required_label = (params["label"] == "true");
-                    if (label_index.count(required_label)) {
-                        candidate_list = label_index[required_label];
+                        PooledBuffer reply = BufferPool::instance().acquire();
+                        append_page_header(*reply, format, page_info, text_header, query.stream);
+                        if (query.stream) {
+                            send_streamed_reply(rep_socket, std::move(reply), format, page, 1);
+                            reply_sent = true;
+                        } else {
+                            append_rows(*reply, format, page.data(), page.size(), 1, false);
+                            append_page_footer(*reply, format, false);
+                            if (!cache_key.empty()) result_cache.store(cache_key, epoch, reply->str());
+                            reply_buffer = std::move(reply);
+                        }
                     }
-                    is_first_filter = false;
                 }
-                
-                if (params.count("proto")) {
-                    try {
-                        int required_proto = std::stoi(params["proto"]);
-                        if (proto_index.count(required_proto)) {
-                            if(is_first_filter) {
-                                candidate_list = proto_index[required_proto];
-                            } else {
-                                std::unordered_set<const Data*> current_candidates(candidate_list.begin(), candidate_list.end());
-                                std::vector<const Data*> proto_candidates = proto_index[required_proto];
-                                std::vector<const Data*> intersection;
-                                
-                                for(const auto& data_ptr : proto_candidates) {
-                                    if(current_candidates.count(data_ptr)) {
-                                        intersection.push_back(data_ptr);
-                                    }
-                                }
-                                candidate_list = intersection;
-                            }
+            } else if (command == "FETCH") {
+                uint32_t cursor_id;
+                int n; // Signed, so that "-1" is rejected rather than wrapped to a huge count
+                // "FETCH <cursor> <n> [stream] [text|json|csv]"
+                std::string option;
+                bool stream = false, options_ok = true;
+                OutputFormat format = OutputFormat::TEXT;
+                bool well_formed = (ss >> cursor_id >> n) && n > 0;
+                while (well_formed && options_ok && ss >> option) {
+                    if (option == "stream") stream = true;
+                    else options_ok = parse_output_format(option, format);
+                }
+                if (!options_ok) {
+                    reply_str = "Error: Unknown FETCH option '" + option + "' (expected stream, text, json or csv).";
+                } else if (well_formed) {
+                    std::vector<const Data*> page;
+                    size_t first_row_number = 0, remaining = 0;
+                    timer.enter(RequestPhase::EXECUTE);
+                    bool fetched = cursor_manager.fetch(cursor_id, static_cast<size_t>(n), page, first_row_number, remaining);
+                    timer.enter(RequestPhase::FORMAT);
+                    if (fetched) {
+                        std::string text_header = "Cursor " + std::to_string(cursor_id) + ": rows " + std::to_string(first_row_number) + "-" +
+                                                  std::to_string(first_row_number + page.size() - 1) + ", " + std::to_string(remaining) +
+                                                  " remaining" + (remaining == 0 ? " (cursor closed)" : "") + ".\n";
+                        size_t cursor_rows = first_row_number - 1 + page.size() + remaining;
+                        PageInfo page_info{cursor_rows, first_row_number, remaining, remaining == 0 ? 0 : cursor_id};
+                        PooledBuffer reply = BufferPool::instance().acquire();
+                        append_page_header(*reply, format, page_info, text_header, stream);
+                        if (stream) {
+                            send_streamed_reply(rep_socket, std::move(reply), format, page, first_row_number);
+                            reply_sent = true;
                         } else {
-                            candidate_list.clear();
+                            append_rows(*reply, format, page.data(), page.size(), first_row_number, false);
+                            append_page_footer(*reply, format, false);
+                            reply_buffer = std::move(reply);
                         }
-                    } catch (const std::exception& e) { /* ignore invalid proto */ }
-                    is_first_filter = false;
+                    } else {
+                        reply_str = "Error: Cursor " + std::to_string(cursor_id) + " not found or expired.";
+                    }
+                } else {
+                    reply_str = "Error: Malformed FETCH command.";
                 }
-
-                if(is_first_filter) {
-                    candidate_list.reserve(master_data_store.size());
-                    for(const auto& ptr : master_data_store) {
-                        candidate_list.push_back(ptr.get());
+            } else if (command == "CLOSE_CURSOR") {
+                uint32_t cursor_id;
+                if (ss >> cursor_id) {
+                    reply_str = cursor_manager.close(cursor_id)
+                        ? "Cursor " + std::to_string(cursor_id) + " closed."
+                        : "Error: Cursor " + std::to_string(cursor_id) + " not found or expired.";
+                } else {
+                    reply_str = "Error: Malformed CLOSE_CURSOR command.";
+                }
+            } else if (command == "SUBSCRIBE") {
+                // "SUBSCRIBE FILTER <filters> [limit=n]" or "SUBSCRIBE STATS field=<f> <filters>"
+                std::string kind_str, params_str;
+                ss >> kind_str;
+                std::getline(ss, params_str);
+                if (kind_str != "FILTER" && kind_str != "STATS") {
+                    reply_str = "Error: Malformed SUBSCRIBE command (expected FILTER or STATS).";
+                } else {
+                    std::string subscribe_error;
+                    SubscriptionKind kind = (kind_str == "FILTER") ? SubscriptionKind::FILTER : SubscriptionKind::STATS;
+                    uint32_t subscription_id = subscription_manager.subscribe(kind, parse_query_params(params_str), subscribe_error);
+                    if (subscription_id == 0) {
+                        reply_str = "Error: " + subscribe_error;
+                    } else {
+                        reply_str = "Subscribed: topic '" + subscription_manager.find(subscription_id)->topic + "' on " +
+                                    query_publisher.address() + " (UNSUBSCRIBE " + std::to_string(subscription_id) + " to stop).";
                     }
                 }
-                
-                // Sorting
-                std::string sort_by = params.count("sort_by") ? params["sort_by"] : "id";
-                std::string sort_order = params.count("sort_order") ? params["sort_order"] : "asc";
-
-                std::sort(candidate_list.begin(), candidate_list.end(), 
-                    [&](const Data* a, const Data* b) {
-                        bool is_asc = (sort_order == "asc");
-                        if (sort_by == "dur") return is_asc ? (a->dur < b->dur) : (a->dur > b->dur);
-                        if (sort_by == "rate") return is_asc ? (a->rate < b->rate) : (a->rate > b->rate);
-                        if (sort_by == "sbytes") return is_asc ? (a->sbytes < b->sbytes) : (a->sbytes > b->sbytes);
-                        if (sort_by == "dbytes") return is_asc ? (a->dbytes < b->dbytes) : (a->dbytes > b->dbytes);
-                        return is_asc ? (a->id < b->id) : (a->id > b->id);
-                    });
-
-                // Formatting reply
-                std::ostringstream oss_reply;
-                oss_reply << "Found " << candidate_list.size() << " matching records. Displaying top results:\n";
-                oss_reply << "-----------------------------------------------------------------\n";
-                
-                int limit = params.count("limit") ? std::stoi(params["limit"]) : 20;
-                for(int i = 0; i < std::min((int)candidate_list.size(), limit); ++i) {
-                    oss_reply << (i + 1) << ". " << format_data_for_reply(*candidate_list[i]) << "\n";
+            } else if (command == "UNSUBSCRIBE") {
+                uint32_t subscription_id;
+                if (ss >> subscription_id) {
+                    reply_str = subscription_manager.unsubscribe(subscription_id)
+                        ? "Subscription " + std::to_string(subscription_id) + " removed."
+                        : "Error: Subscription " + std::to_string(subscription_id) + " not found.";
+                } else {
+                    reply_str = "Error: Malformed UNSUBSCRIBE command.";
                 }
-                reply_str = oss_reply.str();
-
+            } else if (command == "LIST_SUBSCRIPTIONS") {
+                reply_str = subscription_manager.describe();
+                reply_str += "  Published: " + std::to_string(query_publisher.publishedCount()) +
+                             ", dropped: " + std::to_string(query_publisher.droppedCount()) + "\n";
+            } else if (command == "STATS_SERVER") {
+                std::string option;
+                ss >> option;
+                if (option == "RESET") {
+                    server_stats.reset();
+                    reply_str = "Server latency histograms reset.";
+                } else {
+                    timer.enter(RequestPhase::FORMAT);
+                    reply_str = server_stats.describe();
+                }
+            } else if (command == "CACHE_STATS") {
+                reply_str = result_cache.describe();
             } else {
                 reply_str = "Error: Unknown command '" + command + "' or invalid format.";
             }
 
-            std::cout << "[DEBUG] Sending reply: '" << reply_str.substr(0, 200) << (reply_str.length() > 200 ? "..." : "") << "'" << std::endl;
-            zmq::message_t reply_msg(reply_str.data(), reply_str.size());
-            rep_socket.send(reply_msg, 0);
+            if (reply_buffer) {
+                LOG_DEBUG("Sending reply: '" << std::string(reply_buffer->data(), std::min<size_t>(reply_buffer->size(), 200))
+                          << (reply_buffer->size() > 200 ? "..." : "") << "'");
+                send_buffer(rep_socket, std::move(reply_buffer), 0);
+            } else if (!reply_sent) {
+                LOG_DEBUG("Sending reply: '" << reply_str.substr(0, 200) << (reply_str.length() > 200 ? "..." : "") << "'");
+                zmq::message_t reply_msg(reply_str.data(), reply_str.size());
+                rep_socket.send(reply_msg, 0);
+            } else {
+                LOG_DEBUG("Sent streamed multipart reply.");
+            }
+            timer.finish();
         }
 
+        last_poll = poll_time;
+
         // Add a small sleep to prevent busy-waiting if no data/requests are present
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
-    std::cout << "Main loop terminated. Shutting down server." << std::endl;
+    LOG_INFO("Main loop terminated. Shutting down server.");
     data_collector.stop();
     data_collector.join();
     rep_socket.close();
     rep_context.close();
-    std::cout << "Server shutdown complete." << std::endl;
+    LOG_INFO("Server shutdown complete.");
+    Logger::instance().stop();
 
     return 0;
 }
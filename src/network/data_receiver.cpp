@@ -1,8 +1,9 @@
 // Criado por GEMINI 2.5 Pro AI
 // DataReceiver.cpp
 #include "network/data_receiver.h"
-#include <iostream>
+#include "logger.h"
 #include <iomanip>   // For std::hex, std::setw, std::setfill
+#include <sstream>   // For std::ostringstream (hex preview)
 #include <algorithm> // For std::min
 #include <cstring>   // For strlen, strncmp
 #include <cctype>    // For isprint
@@ -38,38 +39,38 @@ DataReceiver::~DataReceiver() {
                 try {
                     subscriber_socket_.setsockopt(ZMQ_UNSUBSCRIBE, zmq_topic_filter_.c_str(), zmq_topic_filter_.length());
                 } catch (const zmq::error_t& e) {
-                     std::cerr << "[DataReceiver] Ignoring error during ZMQ_UNSUBSCRIBE: " << e.what() << std::endl;
+                     LOG_WARN("[DataReceiver] Ignoring error during ZMQ_UNSUBSCRIBE: " << e.what());
                 }
             } else {
                  try {
                     subscriber_socket_.setsockopt(ZMQ_UNSUBSCRIBE, "", 0);
                  } catch (const zmq::error_t& e) {
-                     std::cerr << "[DataReceiver] Ignoring error during ZMQ_UNSUBSCRIBE (empty topic): " << e.what() << std::endl;
+                     LOG_WARN("[DataReceiver] Ignoring error during ZMQ_UNSUBSCRIBE (empty topic): " << e.what());
                  }
             }
         }
     } catch (const zmq::error_t& e) {
-        std::cerr << "[DataReceiver] Exception during ZMQ cleanup: " << e.what() << std::endl;
+        LOG_ERROR("[DataReceiver] Exception during ZMQ cleanup: " << e.what());
     } catch (const std::exception& e) {
-        std::cerr << "[DataReceiver] Standard exception during cleanup: " << e.what() << std::endl;
+        LOG_ERROR("[DataReceiver] Standard exception during cleanup: " << e.what());
     } catch (...) {
-        std::cerr << "[DataReceiver] Unknown exception during cleanup." << std::endl;
+        LOG_ERROR("[DataReceiver] Unknown exception during cleanup.");
     }
 }
 
 // Starts the receiving loop
 bool DataReceiver::start() {
     if (running_.load()) {
-        std::cout << "[DataReceiver] Already running." << std::endl;
+        LOG_INFO("[DataReceiver] Already running.");
         return true;
     }
 
     try {
-        std::cout << "[DataReceiver] Connecting to " << publisher_address_ << "..." << std::endl;
+        LOG_INFO("[DataReceiver] Connecting to " << publisher_address_ << "...");
         subscriber_socket_.connect(publisher_address_);
-        std::cout << "[DataReceiver] Connected." << std::endl;
+        LOG_INFO("[DataReceiver] Connected.");
 
-        std::cout << "[DataReceiver] Setting TCP Keepalive options..." << std::endl;
+        LOG_INFO("[DataReceiver] Setting TCP Keepalive options...");
         int keepalive = 1;
         int keepalive_idle_sec = 60;
         int keepalive_interval_sec = 5;
@@ -79,44 +80,43 @@ bool DataReceiver::start() {
         subscriber_socket_.setsockopt(ZMQ_TCP_KEEPALIVE_IDLE, &keepalive_idle_sec, sizeof(keepalive_idle_sec));
         subscriber_socket_.setsockopt(ZMQ_TCP_KEEPALIVE_INTVL, &keepalive_interval_sec, sizeof(keepalive_interval_sec));
         subscriber_socket_.setsockopt(ZMQ_TCP_KEEPALIVE_CNT, &keepalive_count, sizeof(keepalive_count));
-        std::cout << "[DataReceiver] TCP Keepalive options set." << std::endl;
+        LOG_INFO("[DataReceiver] TCP Keepalive options set.");
 
 
-        std::cout << "[DataReceiver] Subscribing with ZMQ filter: '" << (zmq_topic_filter_.empty() ? "<ALL MESSAGES>" : zmq_topic_filter_) << "'" << std::endl;
+        LOG_INFO("[DataReceiver] Subscribing with ZMQ filter: '" << (zmq_topic_filter_.empty() ? "<ALL MESSAGES>" : zmq_topic_filter_) << "'");
         subscriber_socket_.setsockopt(ZMQ_SUBSCRIBE, zmq_topic_filter_.c_str(), zmq_topic_filter_.length());
         
 
-        std::cout << "[DataReceiver] Allowing 1 second for subscription to establish..." << std::endl;
+        LOG_INFO("[DataReceiver] Allowing 1 second for subscription to establish...");
         std::this_thread::sleep_for(std::chrono::seconds(1));
-        std::cout << "[DataReceiver] Subscription delay complete." << std::endl;
+        LOG_INFO("[DataReceiver] Subscription delay complete.");
 
         successfully_started_ = true;
     } catch (const zmq::error_t& e) {
-        std::cerr << "[DataReceiver] Failed to setup ZeroMQ subscriber: " << e.what() << std::endl;
+        LOG_ERROR("[DataReceiver] Failed to setup ZeroMQ subscriber: " << e.what());
         successfully_started_ = false;
         return false;
     }
 
     running_ = true;
     receiver_thread_ = std::thread(&DataReceiver::receiveLoop, this);
-    std::cout << "[DataReceiver] Started. ZMQ Topic Filter: '"
+    LOG_INFO("[DataReceiver] Started. ZMQ Topic Filter: '"
               << (zmq_topic_filter_.empty() ? "<NONE - expecting prefix in payload>" : zmq_topic_filter_) << "'. "
               << "Internal Payload Prefix Check: '"
-              << (data_prefix_to_process_.empty() ? "<NONE - any payload>" : data_prefix_to_process_) << "' (only used if ZMQ filter is empty)."
-              << std::endl;
+              << (data_prefix_to_process_.empty() ? "<NONE - any payload>" : data_prefix_to_process_) << "' (only used if ZMQ filter is empty).");
     return true;
 }
 
 // Stops the receiving loop
 void DataReceiver::stop() {
     if (running_.load()) {
-        std::cout << "[DataReceiver] Stopping DataReceiver..." << std::endl;
+        LOG_INFO("[DataReceiver] Stopping DataReceiver...");
         running_ = false;
         try {
              context_.close(); 
         } catch (const zmq::error_t& e) {
             if (e.num() != ETERM) { 
-                 std::cerr << "[DataReceiver::stop] Error closing context: " << e.what() << std::endl;
+                 LOG_ERROR("[DataReceiver::stop] Error closing context: " << e.what());
             }
         }
     }
@@ -126,7 +126,7 @@ void DataReceiver::stop() {
 void DataReceiver::join() {
     if (receiver_thread_.joinable()) {
         receiver_thread_.join();
-        std::cout << "[DataReceiver] Thread joined." << std::endl;
+        LOG_INFO("[DataReceiver] Thread joined.");
     }
 }
 
@@ -154,8 +154,8 @@ std::pair<const Data*, size_t> DataReceiver::getCollectedDataView() const {
 void DataReceiver::markDataAsConsumed(size_t count) {
     std::lock_guard<std::mutex> lock(buffer_mutex_);
     if (count > data_ready_.load()) {
-        std::cerr << "[DataReceiver ERROR] Attempted to consume more data than available. Consuming all " 
-                  << data_ready_.load() << " available items." << std::endl;
+        LOG_ERROR("[DataReceiver ERROR] Attempted to consume more data than available. Consuming all " 
+                  << data_ready_.load() << " available items.");
         count = data_ready_.load(); // Cap count to available data
     }
     head_ = (head_ + count) % DATA_RECEIVER_CAPACITY;
@@ -173,7 +173,7 @@ bool DataReceiver::isRunning() const {
 
 // Main receiving loop
 void DataReceiver::receiveLoop() {
-    std::cout << "[DataReceiver::receiveLoop] Loop started. Waiting for messages (blocking)..." << std::endl;
+    LOG_INFO("[DataReceiver::receiveLoop] Loop started. Waiting for messages (blocking)...");
     while (running_.load()) {
         zmq::message_t received_message; 
         bool recv_ok = false;
@@ -182,15 +182,15 @@ void DataReceiver::receiveLoop() {
             recv_ok = subscriber_socket_.recv(&received_message); 
         } catch (const zmq::error_t& e) {
             if (e.num() == ETERM ) { 
-                std::cerr << "[DataReceiver::receiveLoop] ZeroMQ context terminated, shutting down." << std::endl;
+                LOG_WARN("[DataReceiver::receiveLoop] ZeroMQ context terminated, shutting down.");
                 running_ = false; 
                 break; 
             } else if (e.num() == EINTR) { 
-                 std::cerr << "[DataReceiver::receiveLoop] Blocking recv interrupted (EINTR). Continuing." << std::endl;
+                 LOG_WARN("[DataReceiver::receiveLoop] Blocking recv interrupted (EINTR). Continuing.");
                  recv_ok = false; 
             }
             else {
-                std::cerr << "[DataReceiver::receiveLoop] Error during recv: " << e.what() << " (ZMQ errno: " << e.num() << ")" << std::endl;
+                LOG_ERROR("[DataReceiver::receiveLoop] Error during recv: " << e.what() << " (ZMQ errno: " << e.num() << ")");
                 recv_ok = false;
                 if(running_.load()) { 
                     std::this_thread::sleep_for(std::chrono::milliseconds(100));
@@ -241,7 +241,7 @@ void DataReceiver::receiveLoop() {
 
             if (is_valid_payload && payload_to_process_ptr) {
                 if (sizeof(Data) == 0) {
-                    std::cerr << "[DataReceiver] Error: sizeof(Data) is 0. Ensure 'data.h' is correct." << std::endl;
+                    LOG_ERROR("[DataReceiver] Error: sizeof(Data) is 0. Ensure 'data.h' is correct.");
                 } else if (payload_to_process_size > 0 && payload_to_process_size % sizeof(Data) == 0) {
                     size_t num_structs_in_payload = payload_to_process_size / sizeof(Data);
                     std::lock_guard<std::mutex> lock(buffer_mutex_); 
@@ -254,11 +254,11 @@ void DataReceiver::receiveLoop() {
                     size_t structs_to_copy = std::min(num_structs_in_payload, total_free_slots);
 
                     if (structs_to_copy == 0 && num_structs_in_payload > 0) {
-                         std::cerr << "[DataReceiver] Warning: Buffer FULL. Dropping "
-                                   << num_structs_in_payload << " structs (tail: " << tail_.load() << ", head: " << head_.load() << ", data_ready: " << data_ready_.load() << ")." << std::endl;
+                         LOG_WARN("[DataReceiver] Warning: Buffer FULL. Dropping "
+                                   << num_structs_in_payload << " structs (tail: " << tail_.load() << ", head: " << head_.load() << ", data_ready: " << data_ready_.load() << ").");
                     } else if (structs_to_copy < num_structs_in_payload) {
-                         std::cerr << "[DataReceiver] Warning: Buffer NEARLY FULL. Dropping "
-                                   << (num_structs_in_payload - structs_to_copy) << " structs (tail: " << tail_.load() << ", head: " << head_.load() << ", data_ready: " << data_ready_.load() << ")." << std::endl;
+                         LOG_WARN("[DataReceiver] Warning: Buffer NEARLY FULL. Dropping "
+                                   << (num_structs_in_payload - structs_to_copy) << " structs (tail: " << tail_.load() << ", head: " << head_.load() << ", data_ready: " << data_ready_.load() << ").");
                     }
 
                     if (structs_to_copy > 0) { 
@@ -270,22 +270,22 @@ void DataReceiver::receiveLoop() {
                         data_ready_ += structs_to_copy;
                     }
                 } else if (payload_to_process_size != 0) { 
-                    std::cerr << "[DataReceiver] Error: Received data payload size (" << payload_to_process_size
-                              << ") is not a multiple of Data struct size (" << sizeof(Data) << "). Corrupted or mismatched." << std::endl;
+                    LOG_ERROR("[DataReceiver] Error: Received data payload size (" << payload_to_process_size
+                              << ") is not a multiple of Data struct size (" << sizeof(Data) << "). Corrupted or mismatched.");
                 }
             }
         } else if (recv_ok && received_message.size() == 0) {
              // std::cout << "[DEBUG DataReceiver] Received empty ZMQ message part (size 0)." << std::endl;
         }
     }
-    std::cout << "[DataReceiver::receiveLoop] Loop finished." << std::endl;
+    LOG_INFO("[DataReceiver::receiveLoop] Loop finished.");
 }
 
 // Helper function to print message content for debugging
 void DataReceiver::print_message_details(const zmq::message_t& msg, const std::string& context_msg) {
-    std::cout << context_msg << " - Size: " << msg.size() << " bytes." << std::endl;
+    LOG_DEBUG(context_msg << " - Size: " << msg.size() << " bytes.");
     if (msg.size() == 0) {
-        std::cout << "  Message is empty." << std::endl;
+        LOG_DEBUG("  Message is empty.");
         return;
     }
 
@@ -302,15 +302,14 @@ void DataReceiver::print_message_details(const zmq::message_t& msg, const std::s
         }
     }
 
-    std::cout << "  Preview (first " << preview_len << " bytes, as hex): ";
+    std::ostringstream hex_preview;
     const unsigned char* msg_byte_ptr = static_cast<const unsigned char*>(msg.data());
     for (size_t i = 0; i < preview_len; ++i) {
-        std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(msg_byte_ptr[i]) << " ";
+        hex_preview << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(msg_byte_ptr[i]) << " ";
     }
-    std::cout << std::dec << (msg.size() > preview_len ? "..." : "") << std::endl;
+    LOG_DEBUG("  Preview (first " << preview_len << " bytes, as hex): " << hex_preview.str() << (msg.size() > preview_len ? "..." : ""));
 
     if (is_any_printable && !preview_str_printable.empty()) {
-        std::cout << "  Printable Preview: \"" << preview_str_printable << (msg.size() > preview_len && preview_str_printable.length() == preview_len ? "..." : "") << "\"" << std::endl;
+        LOG_DEBUG("  Printable Preview: \"" << preview_str_printable << (msg.size() > preview_len && preview_str_printable.length() == preview_len ? "..." : "") << "\"");
     }
 }
-
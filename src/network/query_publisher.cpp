@@ -0,0 +1,59 @@
+#include "network/query_publisher.h"
+#include "logger.h"
+#include <zmq.h> // Include C API for ZMQ_ constants like ZMQ_SNDMORE
+
+QueryPublisher::QueryPublisher(const std::string& bind_address)
+    : context_(1),
+      publisher_socket_(context_, ZMQ_PUB),
+      bind_address_(bind_address),
+      started_(false),
+      published_(0),
+      dropped_(0) {
+}
+
+QueryPublisher::~QueryPublisher() {
+    try {
+        publisher_socket_.close();
+        context_.close();
+    } catch (const zmq::error_t& e) {
+        LOG_ERROR("[QueryPublisher] Exception during ZMQ cleanup: " << e.what());
+    }
+}
+
+bool QueryPublisher::start() {
+    try {
+        int send_hwm = 1000;
+        int linger_ms = 0;
+        publisher_socket_.setsockopt(ZMQ_SNDHWM, &send_hwm, sizeof(send_hwm));
+        publisher_socket_.setsockopt(ZMQ_LINGER, &linger_ms, sizeof(linger_ms));
+        publisher_socket_.bind(bind_address_);
+        started_ = true;
+        LOG_INFO("[QueryPublisher] Publishing continuous queries on " << bind_address_);
+    } catch (const zmq::error_t& e) {
+        LOG_ERROR("[QueryPublisher] Failed to bind " << bind_address_ << ": " << e.what());
+        started_ = false;
+    }
+    return started_;
+}
+
+bool QueryPublisher::publish(const std::string& topic, const std::string& payload) {
+    return publish(topic, payload.data(), payload.size());
+}
+
+bool QueryPublisher::publish(const std::string& topic, const char* payload, size_t size) {
+    if (!started_) return false;
+    try {
+        zmq::message_t topic_msg(topic.data(), topic.size());
+        zmq::message_t payload_msg(payload, size);
+        // PUB sockets drop instead of blocking once the HWM is reached, but ZMQ_DONTWAIT makes it explicit
+        if (publisher_socket_.send(topic_msg, ZMQ_SNDMORE | ZMQ_DONTWAIT) &&
+            publisher_socket_.send(payload_msg, ZMQ_DONTWAIT)) {
+            ++published_;
+            return true;
+        }
+    } catch (const zmq::error_t& e) {
+        LOG_ERROR("[QueryPublisher] Error publishing on '" << topic << "': " << e.what());
+    }
+    ++dropped_;
+    return false;
+}
@@ -0,0 +1,92 @@
+#include "query/AnomalyScorer.h"
+#include <algorithm> // For std::max
+#include <cmath>     // For std::log1p, std::sqrt, std::abs, std::isfinite
+#include <sstream>   // For std::ostringstream
+#include "data_fields.h"
+#include "stats_summary.h" // For statistic_feature_name
+
+void EwmaBaseline::update(double value, double alpha) {
+    if (count++ == 0) {
+        mean = value;
+        variance = 0.0;
+        return;
+    }
+    double diff = value - mean;
+    double increment = alpha * diff;
+    mean += increment;
+    variance = (1.0 - alpha) * (variance + diff * increment);
+}
+
+double EwmaBaseline::stdDev() const {
+    return std::sqrt(std::max(0.0, variance));
+}
+
+AnomalyScorer::AnomalyScorer(double alpha, double threshold)
+    : smoothing(alpha > 0.0 && alpha < 1.0 ? alpha : DEFAULT_ALPHA),
+      alert_threshold(threshold),
+      warmup_count(static_cast<uint64_t>(std::ceil(1.0 / smoothing))),
+      groups{} {}
+
+void AnomalyScorer::groupBy(CategoricalField field) {
+    is_grouped = true;
+    group_field = field;
+    group_offset = categorical_field_offset(field);
+    groups.fill(FeatureBaselines{});
+}
+
+bool AnomalyScorer::score(const Data& record, AnomalyAlert& alert) {
+    uint8_t group = is_grouped ? read_field<uint8_t>(&record, group_offset) : 0;
+    FeatureBaselines& own = groups[group];
+    const FeatureBaselines& reference = (is_grouped && own[0].count >= warmup_count) ? own : global;
+    bool warm = global[0].count >= warmup_count;
+
+    double best = 0.0;
+    size_t best_feature = 0;
+    const StatisticFeatureValues raw = statistic_feature_values(&record);
+    double values[STATISTIC_FEATURE_COUNT];
+    bool finite[STATISTIC_FEATURE_COUNT];
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        // A NaN or infinite value would make the baseline NaN for good: the feature sits the record out
+        finite[f] = std::isfinite(raw[f]);
+        if (!finite[f]) continue;
+        values[f] = std::log1p(std::max(raw[f], 0.0f));
+        // Floor on the deviation, so that a feature that has been constant so far does not
+        // turn every small change into an infinite score
+        double stddev = std::max(reference[f].stdDev(), 1e-3);
+        double z = std::abs(values[f] - reference[f].mean) / stddev;
+        if (z > best) {
+            best = z;
+            best_feature = f;
+        }
+    }
+    // The alert reports the baseline the record was scored against: 'reference' points into the
+    // baselines that the update below folds the record into
+    bool raised = warm && best >= alert_threshold;
+    if (raised) {
+        StatisticFeature feature = static_cast<StatisticFeature>(best_feature);
+        alert = AnomalyAlert{record.id, best, feature, raw[best_feature], reference[best_feature].mean, reference[best_feature].stdDev(), group};
+        ++alerted;
+    }
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        if (!finite[f]) continue;
+        global[f].update(values[f], smoothing);
+        if (is_grouped) own[f].update(values[f], smoothing);
+    }
+    ++scored;
+    return raised;
+}
+
+void AnomalyScorer::onBatch(const Data* records, size_t n, std::vector<AnomalyAlert>& alerts) {
+    AnomalyAlert alert;
+    for (size_t i = 0; i < n; ++i) {
+        if (score(records[i], alert)) alerts.push_back(alert);
+    }
+}
+
+std::string format_alert(const AnomalyAlert& alert) {
+    std::ostringstream oss;
+    oss << "id=" << alert.id << " score=" << alert.score << " feature=" << statistic_feature_name(alert.feature)
+        << " value=" << alert.value << " expected_log1p=" << alert.expected << " stddev_log1p=" << alert.stddev
+        << " group=" << static_cast<int>(alert.group);
+    return oss.str();
+}
@@ -0,0 +1,329 @@
+#include "query/Bitmap.h"
+#include <algorithm> // For std::lower_bound, std::set_intersection, std::set_union, std::set_difference
+#include <iterator>  // For std::back_inserter
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Word-parallel kernels over two BITSET_WORDS-long bitsets. Returns the cardinality of the result.
+uint32_t bitset_op_and(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= words; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(va, vb));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= words; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(va, vb));
+    }
+#endif
+    for (; i < words; ++i) out[i] = a[i] & b[i];
+
+    uint32_t card = 0;
+    for (i = 0; i < words; ++i) card += static_cast<uint32_t>(__builtin_popcountll(out[i]));
+    return card;
+}
+
+uint32_t bitset_op_or(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= words; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_or_si256(va, vb));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= words; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(va, vb));
+    }
+#endif
+    for (; i < words; ++i) out[i] = a[i] | b[i];
+
+    uint32_t card = 0;
+    for (i = 0; i < words; ++i) card += static_cast<uint32_t>(__builtin_popcountll(out[i]));
+    return card;
+}
+
+uint32_t bitset_op_andnot(const uint64_t* a, const uint64_t* b, uint64_t* out, size_t words) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= words; i += 4) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        // _mm256_andnot_si256 computes (~first) & second
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_andnot_si256(vb, va));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= words; i += 2) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_andnot_si128(vb, va));
+    }
+#endif
+    for (; i < words; ++i) out[i] = a[i] & ~b[i];
+
+    uint32_t card = 0;
+    for (i = 0; i < words; ++i) card += static_cast<uint32_t>(__builtin_popcountll(out[i]));
+    return card;
+}
+
+} // namespace
+
+bool Bitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) return (bits[low >> 6] >> (low & 63)) & 1ULL;
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void Bitmap::Container::toBitset() {
+    if (isBitset()) return;
+    bits.assign(BITSET_WORDS, 0);
+    for (uint16_t low : array) bits[low >> 6] |= 1ULL << (low & 63);
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void Bitmap::Container::normalize() {
+    if (isBitset() && cardinality <= ARRAY_MAX_CARDINALITY) {
+        array.clear();
+        array.reserve(cardinality);
+        for (size_t w = 0; w < BITSET_WORDS; ++w) {
+            uint64_t word = bits[w];
+            while (word) {
+                array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+                word &= word - 1;
+            }
+        }
+        bits.clear();
+        bits.shrink_to_fit();
+    } else if (!isBitset() && cardinality > ARRAY_MAX_CARDINALITY) {
+        toBitset();
+    }
+}
+
+Bitmap::Container* Bitmap::findContainer(uint16_t key) {
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return (it != containers.end() && it->key == key) ? &*it : nullptr;
+}
+
+const Bitmap::Container* Bitmap::findContainer(uint16_t key) const {
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return (it != containers.end() && it->key == key) ? &*it : nullptr;
+}
+
+void Bitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+
+    // Slots are appended in increasing order, so the common case is the last container
+    auto it = (!containers.empty() && containers.back().key == key)
+        ? containers.end() - 1
+        : std::lower_bound(containers.begin(), containers.end(), key,
+                           [](const Container& c, uint16_t k) { return c.key < k; });
+    if (it == containers.end() || it->key != key) {
+        Container c;
+        c.key = key;
+        it = containers.insert(it, std::move(c));
+    }
+
+    Container& c = *it;
+    if (c.isBitset()) {
+        uint64_t mask = 1ULL << (low & 63);
+        if (!(c.bits[low >> 6] & mask)) {
+            c.bits[low >> 6] |= mask;
+            c.cardinality++;
+        }
+        return;
+    }
+    auto pos = (c.array.empty() || c.array.back() < low)
+        ? c.array.end()
+        : std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low) return;
+    c.array.insert(pos, low);
+    c.cardinality++;
+    c.normalize();
+}
+
+bool Bitmap::remove(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+    Container* c = findContainer(key);
+    if (!c || !c->contains(low)) return false;
+
+    if (c->isBitset()) {
+        c->bits[low >> 6] &= ~(1ULL << (low & 63));
+    } else {
+        c->array.erase(std::lower_bound(c->array.begin(), c->array.end(), low));
+    }
+    c->cardinality--;
+    if (c->cardinality == 0) {
+        containers.erase(containers.begin() + (c - containers.data()));
+    } else {
+        c->normalize();
+    }
+    return true;
+}
+
+bool Bitmap::contains(uint32_t value) const {
+    const Container* c = findContainer(static_cast<uint16_t>(value >> 16));
+    return c && c->contains(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+void Bitmap::removeBelow(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    uint16_t low = static_cast<uint16_t>(value & 0xFFFF);
+
+    auto first_kept = std::lower_bound(containers.begin(), containers.end(), key,
+                                       [](const Container& c, uint16_t k) { return c.key < k; });
+    containers.erase(containers.begin(), first_kept);
+    if (containers.empty() || containers.front().key != key || low == 0) return;
+
+    Container& c = containers.front();
+    if (c.isBitset()) {
+        size_t full_words = low >> 6;
+        std::fill(c.bits.begin(), c.bits.begin() + full_words, 0ULL);
+        if (low & 63) c.bits[full_words] &= ~((1ULL << (low & 63)) - 1);
+        c.cardinality = 0;
+        for (uint64_t word : c.bits) c.cardinality += static_cast<uint32_t>(__builtin_popcountll(word));
+    } else {
+        c.array.erase(c.array.begin(), std::lower_bound(c.array.begin(), c.array.end(), low));
+        c.cardinality = static_cast<uint32_t>(c.array.size());
+    }
+    if (c.cardinality == 0) containers.erase(containers.begin());
+    else c.normalize();
+}
+
+size_t Bitmap::cardinality() const {
+    size_t total = 0;
+    for (const Container& c : containers) total += c.cardinality;
+    return total;
+}
+
+Bitmap Bitmap::range(uint32_t begin, uint32_t end) {
+    Bitmap result;
+    while (begin < end) {
+        Container c;
+        c.key = static_cast<uint16_t>(begin >> 16);
+        uint32_t container_end = std::min<uint64_t>(end, (static_cast<uint64_t>(c.key) + 1) << 16);
+        uint32_t from = begin & 0xFFFF;
+        uint32_t to = from + (container_end - begin); // exclusive, may be 65536
+        c.cardinality = to - from;
+        if (c.cardinality <= ARRAY_MAX_CARDINALITY) {
+            c.array.reserve(c.cardinality);
+            for (uint32_t v = from; v < to; ++v) c.array.push_back(static_cast<uint16_t>(v));
+        } else {
+            c.bits.assign(BITSET_WORDS, 0);
+            for (uint32_t v = from; v < to; ++v) c.bits[v >> 6] |= 1ULL << (v & 63);
+        }
+        result.containers.push_back(std::move(c));
+        begin = container_end;
+    }
+    return result;
+}
+
+Bitmap::Container Bitmap::combine(const Container& a, const Container& b, Op op) {
+    Container out;
+    out.key = a.key;
+
+    if (!a.isBitset() && !b.isBitset()) {
+        // Sparse containers: sorted merges
+        if (op == Op::AND) {
+            std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        } else if (op == Op::OR) {
+            std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        } else {
+            std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        }
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    } else if (op == Op::AND && (!a.isBitset() || !b.isBitset())) {
+        // Sparse AND dense: probe the bitset for every offset of the array
+        const Container& sparse = a.isBitset() ? b : a;
+        const Container& dense = a.isBitset() ? a : b;
+        for (uint16_t low : sparse.array)
+            if ((dense.bits[low >> 6] >> (low & 63)) & 1ULL) out.array.push_back(low);
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    } else if (op == Op::ANDNOT && !a.isBitset()) {
+        for (uint16_t low : a.array)
+            if (!((b.bits[low >> 6] >> (low & 63)) & 1ULL)) out.array.push_back(low);
+        out.cardinality = static_cast<uint32_t>(out.array.size());
+    } else {
+        // At least one dense side: run the word-parallel kernel over bitsets. Bitset sides are
+        // read in place; only an array side is widened, into a scratch bitset.
+        std::vector<uint64_t> widened;
+        auto words = [&widened](const Container& c) -> const uint64_t* {
+            if (c.isBitset()) return c.bits.data();
+            widened.assign(BITSET_WORDS, 0);
+            for (uint16_t low : c.array) widened[low >> 6] |= 1ULL << (low & 63);
+            return widened.data();
+        };
+        const uint64_t* wa = words(a);
+        const uint64_t* wb = words(b);
+        out.bits.assign(BITSET_WORDS, 0);
+        if (op == Op::AND) out.cardinality = bitset_op_and(wa, wb, out.bits.data(), BITSET_WORDS);
+        else if (op == Op::OR) out.cardinality = bitset_op_or(wa, wb, out.bits.data(), BITSET_WORDS);
+        else out.cardinality = bitset_op_andnot(wa, wb, out.bits.data(), BITSET_WORDS);
+    }
+    out.normalize();
+    return out;
+}
+
+Bitmap Bitmap::intersect(const Bitmap& other) const {
+    Bitmap result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() && j < other.containers.size()) {
+        if (containers[i].key < other.containers[j].key) ++i;
+        else if (containers[i].key > other.containers[j].key) ++j;
+        else {
+            Container c = combine(containers[i++], other.containers[j++], Op::AND);
+            if (c.cardinality > 0) result.containers.push_back(std::move(c));
+        }
+    }
+    return result;
+}
+
+Bitmap Bitmap::unite(const Bitmap& other) const {
+    Bitmap result;
+    size_t i = 0, j = 0;
+    while (i < containers.size() || j < other.containers.size()) {
+        if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key)) {
+            result.containers.push_back(containers[i++]);
+        } else if (i == containers.size() || containers[i].key > other.containers[j].key) {
+            result.containers.push_back(other.containers[j++]);
+        } else {
+            result.containers.push_back(combine(containers[i++], other.containers[j++], Op::OR));
+        }
+    }
+    return result;
+}
+
+Bitmap Bitmap::subtract(const Bitmap& other) const {
+    Bitmap result;
+    size_t j = 0;
+    for (const Container& c : containers) {
+        while (j < other.containers.size() && other.containers[j].key < c.key) ++j;
+        if (j < other.containers.size() && other.containers[j].key == c.key) {
+            Container diff = combine(c, other.containers[j], Op::ANDNOT);
+            if (diff.cardinality > 0) result.containers.push_back(std::move(diff));
+        } else {
+            result.containers.push_back(c);
+        }
+    }
+    return result;
+}
+
+size_t Bitmap::getMemoryUsage() const {
+    size_t total = containers.capacity() * sizeof(Container);
+    for (const Container& c : containers)
+        total += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+    return total;
+}
@@ -0,0 +1,165 @@
+#include "query/CategoricalIndex.h"
+#include <cstddef>   // For offsetof
+#include <sstream>   // For splitting comma-separated values
+#include <stdexcept> // For std::out_of_range
+
+bool parse_categorical_field(const std::string& name, CategoricalField& field) {
+    if (name == "label") field = CategoricalField::LABEL;
+    else if (name == "proto") field = CategoricalField::PROTO;
+    else if (name == "state") field = CategoricalField::STATE;
+    else if (name == "service") field = CategoricalField::SERVICE;
+    else if (name == "attack_cat" || name == "attack_category") field = CategoricalField::ATTACK_CAT;
+    else return false;
+    return true;
+}
+
+const char* categorical_field_name(CategoricalField field) {
+    switch (field) {
+        case CategoricalField::LABEL: return "label";
+        case CategoricalField::PROTO: return "proto";
+        case CategoricalField::STATE: return "state";
+        case CategoricalField::SERVICE: return "service";
+        case CategoricalField::ATTACK_CAT: return "attack_cat";
+        default: return "unknown";
+    }
+}
+
+uint8_t categorical_value(const Data* d, CategoricalField field) {
+    switch (field) {
+        case CategoricalField::LABEL: return d->label ? 1 : 0;
+        case CategoricalField::PROTO: return static_cast<uint8_t>(d->proto);
+        case CategoricalField::STATE: return static_cast<uint8_t>(d->state);
+        case CategoricalField::SERVICE: return static_cast<uint8_t>(d->service);
+        case CategoricalField::ATTACK_CAT: return static_cast<uint8_t>(d->attack_category);
+        default: return 0;
+    }
+}
+
+static_assert(sizeof(bool) == 1 && sizeof(Protocolo) == 1 && sizeof(State) == 1 &&
+              sizeof(Servico) == 1 && sizeof(Attack_cat) == 1, "categorical fields are one byte wide");
+
+size_t categorical_field_offset(CategoricalField field) {
+    switch (field) {
+        case CategoricalField::LABEL: return offsetof(Data, label);
+        case CategoricalField::PROTO: return offsetof(Data, proto);
+        case CategoricalField::STATE: return offsetof(Data, state);
+        case CategoricalField::SERVICE: return offsetof(Data, service);
+        default: return offsetof(Data, attack_category);
+    }
+}
+
+bool predicate_matches(const Data* d, const CategoricalPredicate& predicate) {
+    uint8_t value = categorical_value(d, predicate.field);
+    bool listed = false;
+    for (uint8_t v : predicate.values) {
+        if (v == value) {
+            listed = true;
+            break;
+        }
+    }
+    return listed != predicate.negated;
+}
+
+bool parse_categorical_predicates(const std::map<std::string, std::string>& params,
+                                  std::vector<CategoricalPredicate>& predicates, std::string& error) {
+    for (const auto& param : params) {
+        std::string name = param.first;
+        bool negated = !name.empty() && name.back() == '!';
+        if (negated) name.pop_back();
+
+        CategoricalPredicate predicate;
+        if (!parse_categorical_field(name, predicate.field)) continue; // Not a categorical filter
+        predicate.negated = negated;
+
+        std::stringstream values(param.second);
+        std::string value;
+        while (std::getline(values, value, ',')) {
+            if (predicate.field == CategoricalField::LABEL) {
+                // Same rule as before: anything but "true"/"1" means a normal connection
+                predicate.values.push_back((value == "true" || value == "1") ? 1 : 0);
+                continue;
+            }
+            try {
+                int parsed = std::stoi(value);
+                if (parsed < 0 || parsed > 255) throw std::out_of_range(value);
+                predicate.values.push_back(static_cast<uint8_t>(parsed));
+            } catch (const std::exception&) {
+                error = "Invalid value '" + value + "' for filter '" + name + "'.";
+                return false;
+            }
+        }
+        if (predicate.values.empty()) {
+            error = "Missing value for filter '" + name + "'.";
+            return false;
+        }
+        predicates.push_back(predicate);
+    }
+    return true;
+}
+
+void CategoricalIndexes::insert(const Data* d, uint32_t slot) {
+    if (!d) return;
+    for (size_t f = 0; f < CATEGORICAL_FIELD_COUNT; ++f) {
+        CategoricalField field = static_cast<CategoricalField>(f);
+        uint8_t value = categorical_value(d, field);
+        bitmaps[f][value].add(slot);
+        counts[f][value]++;
+    }
+}
+
+void CategoricalIndexes::evictBelow(uint32_t first_live_slot) {
+    for (size_t f = 0; f < CATEGORICAL_FIELD_COUNT; ++f) {
+        for (size_t v = 0; v < 256; ++v) {
+            if (counts[f][v] == 0) continue;
+            bitmaps[f][v].removeBelow(first_live_slot);
+            counts[f][v] = static_cast<uint32_t>(bitmaps[f][v].cardinality());
+        }
+    }
+}
+
+void CategoricalIndexes::clear() {
+    for (auto& field_bitmaps : bitmaps)
+        for (Bitmap& bitmap : field_bitmaps) bitmap.clear();
+    for (auto& field_counts : counts) field_counts.fill(0);
+}
+
+const Bitmap& CategoricalIndexes::lookup(CategoricalField field, uint8_t value) const {
+    return bitmaps[static_cast<size_t>(field)][value];
+}
+
+Bitmap CategoricalIndexes::valuesOf(const CategoricalPredicate& predicate) const {
+    if (predicate.values.size() == 1) return lookup(predicate.field, predicate.values[0]);
+    Bitmap result;
+    for (uint8_t value : predicate.values) result = result.unite(lookup(predicate.field, value));
+    return result;
+}
+
+Bitmap CategoricalIndexes::evaluate(const std::vector<CategoricalPredicate>& predicates,
+                                    uint32_t first_slot, uint32_t end_slot) const {
+    // Positive predicates first: they shrink the result, so the ANDNOTs run over fewer containers
+    Bitmap result;
+    bool has_result = false;
+    for (const CategoricalPredicate& predicate : predicates) {
+        if (predicate.negated) continue;
+        Bitmap matches = valuesOf(predicate);
+        result = has_result ? result.intersect(matches) : std::move(matches);
+        has_result = true;
+        if (result.empty()) return result; // Nothing left for the remaining predicates to filter
+    }
+    for (const CategoricalPredicate& predicate : predicates) {
+        if (!predicate.negated) continue;
+        if (!has_result) {
+            result = Bitmap::range(first_slot, end_slot);
+            has_result = true;
+        }
+        result = result.subtract(valuesOf(predicate));
+    }
+    return has_result ? result : Bitmap::range(first_slot, end_slot);
+}
+
+size_t CategoricalIndexes::getMemoryUsage() const {
+    size_t total = 0;
+    for (const auto& field_bitmaps : bitmaps)
+        for (const Bitmap& bitmap : field_bitmaps) total += sizeof(Bitmap) + bitmap.getMemoryUsage();
+    return total;
+}
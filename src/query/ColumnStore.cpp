@@ -0,0 +1,211 @@
+#include "query/ColumnStore.h"
+#include <algorithm> // For std::max, std::min
+#include <cstdlib>   // For std::aligned_alloc, std::free
+#include <cstring>   // For memcpy
+#include <new>       // For std::bad_alloc
+#include <type_traits> // For std::is_same
+#include "thread_pool.h"
+
+namespace {
+
+constexpr size_t field_width(FieldType type) {
+    return type == FieldType::UINT8 ? 1 : type == FieldType::UINT16 ? 2 : 4;
+}
+
+constexpr size_t numeric_field_bytes() {
+    size_t bytes = 0;
+    for (const NumericField& field : NUMERIC_FIELDS) bytes += field_width(field.type);
+    return bytes;
+}
+
+// Members of Data that are not numeric fields, one byte each
+const size_t BYTE_MEMBERS[COLUMN_COUNT - NUMERIC_FIELD_COUNT] = {
+    offsetof(Data, is_ftp_login), offsetof(Data, is_sm_ips_ports), offsetof(Data, label), offsetof(Data, proto),
+    offsetof(Data, state), offsetof(Data, attack_category), offsetof(Data, service),
+};
+
+static_assert(numeric_field_bytes() + (COLUMN_COUNT - NUMERIC_FIELD_COUNT) == sizeof(Data),
+              "every byte of Data must belong to a column");
+
+// Index of 'field' in NUMERIC_FIELDS, which is also its column
+size_t column_index(const NumericField& field) {
+    return static_cast<size_t>(&field - NUMERIC_FIELDS);
+}
+
+// Narrows 'selection' (row indexes into 'values') to the rows inside the range; with 'all', starts
+// from every row of [0, count). Returns the number of survivors.
+template <typename T>
+size_t filter_column(const T* values, const RangePredicate& range, uint16_t* selection, size_t count, bool all) {
+    const double low = range.low, high = range.high;
+    size_t kept = 0;
+    for (size_t j = 0; j < count; ++j) {
+        uint16_t row = all ? static_cast<uint16_t>(j) : selection[j];
+        double value = values[row];
+        selection[kept] = row;
+        kept += (value >= low && value <= high) ? 1 : 0;
+    }
+    return kept;
+}
+
+} // namespace
+
+void ColumnStore::FreeAligned::operator()(unsigned char* block) const {
+    std::free(block);
+}
+
+ColumnStore::Layout::Layout() : block_bytes(0) {
+    for (size_t c = 0; c < COLUMN_COUNT; ++c) {
+        bool numeric = c < NUMERIC_FIELD_COUNT;
+        data_offset[c] = numeric ? NUMERIC_FIELDS[c].offset : BYTE_MEMBERS[c - NUMERIC_FIELD_COUNT];
+        width[c] = numeric ? field_width(NUMERIC_FIELDS[c].type) : 1;
+        column_offset[c] = block_bytes;
+        size_t bytes = width[c] * COLUMN_BLOCK_ROWS;
+        block_bytes += (bytes + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+    }
+}
+
+const ColumnStore::Layout& ColumnStore::layout() {
+    static const Layout instance;
+    return instance;
+}
+
+uint32_t ColumnStore::append(const Data& record) {
+    const Layout& l = layout();
+    uint32_t slot = end_slot;
+    size_t block = slot / COLUMN_BLOCK_ROWS;
+    if (blocks.empty()) first_block = block;
+    if (block - first_block == blocks.size()) {
+        void* memory = std::aligned_alloc(COLUMN_ALIGNMENT, l.block_bytes);
+        if (!memory) throw std::bad_alloc();
+        blocks.emplace_back(static_cast<unsigned char*>(memory));
+    }
+    unsigned char* base = blocks[block - first_block].get();
+    size_t row = slot % COLUMN_BLOCK_ROWS;
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(&record);
+    for (size_t c = 0; c < COLUMN_COUNT; ++c)
+        memcpy(base + l.column_offset[c] + row * l.width[c], source + l.data_offset[c], l.width[c]);
+    ++end_slot;
+    return slot;
+}
+
+size_t ColumnStore::evictOldest(size_t n) {
+    n = std::min(n, size());
+    first_slot += static_cast<uint32_t>(n);
+    // A block goes once its last row is evicted
+    while (!blocks.empty() && (first_block + 1) * COLUMN_BLOCK_ROWS <= first_slot) {
+        blocks.pop_front();
+        ++first_block;
+    }
+    return n;
+}
+
+bool ColumnStore::read(uint32_t slot, Data& out) const {
+    if (slot < first_slot || slot >= end_slot) return false;
+    const Layout& l = layout();
+    const unsigned char* base = blocks[slot / COLUMN_BLOCK_ROWS - first_block].get();
+    size_t row = slot % COLUMN_BLOCK_ROWS;
+    unsigned char* target = reinterpret_cast<unsigned char*>(&out);
+    for (size_t c = 0; c < COLUMN_COUNT; ++c)
+        memcpy(target + l.data_offset[c], base + l.column_offset[c] + row * l.width[c], l.width[c]);
+    return true;
+}
+
+Moments ColumnStore::moments(const NumericField& field, int interval_count) const {
+    return visit_field_type(field.type, [&](auto tag) {
+        using T = decltype(tag);
+        struct Run {
+            const T* values;
+            size_t n;
+        };
+        std::vector<Run> runs;
+        scan<T>(column_index(field), windowBegin(interval_count), end_slot, [&](const T* values, size_t n, uint32_t) {
+            runs.push_back({values, n});
+        });
+
+        size_t chunks = chunk_count(runs.size(), std::max<size_t>(1, PARALLEL_MIN_CHUNK / COLUMN_BLOCK_ROWS));
+        std::vector<Moments> partial(chunks);
+        parallel_chunks(runs.size(), chunks, [&](size_t chunk, size_t begin, size_t end) {
+            std::vector<float> scratch; // Integer columns are widened one block at a time
+            for (size_t r = begin; r < end; ++r) {
+                const float* values;
+                if constexpr (std::is_same<T, float>::value) {
+                    values = runs[r].values;
+                } else {
+                    scratch.resize(runs[r].n);
+                    for (size_t i = 0; i < runs[r].n; ++i) scratch[i] = static_cast<float>(runs[r].values[i]);
+                    values = scratch.data();
+                }
+                partial[chunk].merge(compute_moments(values, runs[r].n));
+            }
+        });
+        Moments total;
+        for (const Moments& m : partial) total.merge(m);
+        return total;
+    });
+}
+
+StatsSummary ColumnStore::summarize(const NumericField& field, int interval_count, std::vector<float>& scratch) const {
+    StatsSummary summary;
+    Moments m = moments(field, interval_count);
+    summary.count = m.count;
+    if (m.count == 0) return summary;
+    summary.mean = m.mean;
+    summary.variance = m.variance();
+    summary.min = m.min;
+    summary.max = m.max;
+
+    scratch.resize(m.count);
+    float* out = scratch.data();
+    visit_field_type(field.type, [&](auto tag) {
+        using T = decltype(tag);
+        scan<T>(column_index(field), windowBegin(interval_count), end_slot, [&](const T* values, size_t n, uint32_t) {
+            for (size_t i = 0; i < n; ++i) *out++ = static_cast<float>(values[i]);
+        });
+    });
+    summary.median = select_median(scratch.data(), m.count);
+    return summary;
+}
+
+StatsSummary ColumnStore::summarizeField(const NumericField& field, int interval_count) const {
+    std::vector<float> scratch;
+    return summarize(field, interval_count, scratch);
+}
+
+StatsSummaryRow ColumnStore::summarizeAll(int interval_count) const {
+    StatsSummaryRow row;
+    std::vector<float> scratch;
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f)
+        row[f] = summarize(statistic_feature_field(static_cast<StatisticFeature>(f)), interval_count, scratch);
+    return row;
+}
+
+Bitmap ColumnStore::select(const std::vector<RangePredicate>& ranges, size_t& rows_examined) const {
+    Bitmap result;
+    uint16_t selection[COLUMN_BLOCK_ROWS];
+    static_assert(COLUMN_BLOCK_ROWS <= 65536, "selection vectors index a block with uint16_t");
+    for (uint32_t begin = first_slot; begin < end_slot;) {
+        size_t block = begin / COLUMN_BLOCK_ROWS;
+        uint32_t run_end = static_cast<uint32_t>(std::min<size_t>(end_slot, (block + 1) * COLUMN_BLOCK_ROWS));
+        size_t first_row = begin - block * COLUMN_BLOCK_ROWS;
+        size_t count = run_end - begin;
+        const unsigned char* base = blocks[block - first_block].get();
+
+        bool all = true;
+        for (const RangePredicate& range : ranges) {
+            if (count == 0) break;
+            visit_field_type(range.field->type, [&](auto tag) {
+                using T = decltype(tag);
+                count = filter_column(column<T>(base, column_index(*range.field)) + first_row, range, selection, count, all);
+            });
+            all = false;
+        }
+        for (size_t i = 0; i < count; ++i) result.add(begin + (all ? static_cast<uint32_t>(i) : selection[i]));
+        rows_examined += run_end - begin;
+        begin = run_end;
+    }
+    return result;
+}
+
+size_t ColumnStore::getMemoryUsage() const {
+    return sizeof(*this) + blocks.size() * (layout().block_bytes + sizeof(Block));
+}
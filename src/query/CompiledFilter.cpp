@@ -0,0 +1,163 @@
+#include "query/CompiledFilter.h"
+#include <algorithm> // For std::max, std::min
+#include <cmath>     // For std::ceil, std::floor, std::nextafter
+#include <limits>    // For std::numeric_limits
+
+namespace {
+
+// Smallest float >= value and largest float <= value, so that comparing the float field against
+// them gives the same answer as comparing its double promotion against 'value'.
+float float_at_least(double value) {
+    float f = static_cast<float>(value);
+    if (static_cast<double>(f) < value) f = std::nextafter(f, std::numeric_limits<float>::infinity());
+    return f;
+}
+
+float float_at_most(double value) {
+    float f = static_cast<float>(value);
+    if (static_cast<double>(f) > value) f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    return f;
+}
+
+uint32_t type_max(FieldType type) {
+    switch (type) {
+        case FieldType::UINT8: return std::numeric_limits<uint8_t>::max();
+        case FieldType::UINT16: return std::numeric_limits<uint16_t>::max();
+        default: return std::numeric_limits<uint32_t>::max();
+    }
+}
+
+// Gathers the field of the selected rows into a contiguous array, then compacts the selection
+// without branches: every row is written and the output cursor only advances on a match.
+template <typename T, typename Bound>
+size_t select_range(const Data* const* rows, uint16_t* selection, size_t count, size_t offset, Bound low, Bound high) {
+    T values[FILTER_BLOCK_SIZE];
+    for (size_t i = 0; i < count; ++i) values[i] = read_field<T>(rows[selection[i]], offset);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        selection[kept] = selection[i];
+        kept += (values[i] >= low) & (values[i] <= high);
+    }
+    return kept;
+}
+
+size_t select_members(const Data* const* rows, uint16_t* selection, size_t count, size_t offset, const uint64_t* members) {
+    uint8_t values[FILTER_BLOCK_SIZE];
+    for (size_t i = 0; i < count; ++i) values[i] = read_field<uint8_t>(rows[selection[i]], offset);
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        selection[kept] = selection[i];
+        kept += (members[values[i] >> 6] >> (values[i] & 63)) & 1;
+    }
+    return kept;
+}
+
+} // namespace
+
+CompiledFilter::CompiledFilter(const std::vector<CategoricalPredicate>& predicates, const std::vector<RangePredicate>& ranges) {
+    for (const CategoricalPredicate& predicate : predicates) {
+        FilterTerm term;
+        term.offset = categorical_field_offset(predicate.field);
+        term.type = FieldType::UINT8;
+        term.membership = true;
+        uint64_t listed[4] = {0, 0, 0, 0};
+        for (uint8_t value : predicate.values) listed[value >> 6] |= uint64_t(1) << (value & 63);
+        for (int w = 0; w < 4; ++w) term.members[w] = predicate.negated ? ~listed[w] : listed[w];
+        terms.push_back(term);
+    }
+
+    for (const RangePredicate& range : ranges) {
+        FilterTerm term;
+        term.offset = range.field->offset;
+        term.type = range.field->type;
+        term.membership = false;
+        if (term.type == FieldType::FLOAT) {
+            term.float_low = float_at_least(range.low);
+            term.float_high = float_at_most(range.high);
+        } else {
+            double low = std::ceil(std::max(range.low, 0.0));
+            double high = std::floor(std::min(range.high, static_cast<double>(type_max(term.type))));
+            if (low > high) {
+                term.int_low = 1; // Empty range
+                term.int_high = 0;
+            } else {
+                term.int_low = static_cast<uint32_t>(low);
+                term.int_high = static_cast<uint32_t>(high);
+            }
+        }
+        terms.push_back(term);
+    }
+}
+
+bool CompiledFilter::matches(const Data* d) const {
+    uint16_t selection = 0;
+    return filterBlock(&d, &selection, 1) == 1;
+}
+
+size_t CompiledFilter::filterBlock(const Data* const* rows, uint16_t* selection, size_t count) const {
+    for (const FilterTerm& term : terms) {
+        if (count == 0) break;
+        if (term.membership) {
+            count = select_members(rows, selection, count, term.offset, term.members);
+            continue;
+        }
+        switch (term.type) {
+            case FieldType::FLOAT:
+                count = select_range<float>(rows, selection, count, term.offset, term.float_low, term.float_high);
+                break;
+            case FieldType::UINT8:
+                count = select_range<uint8_t>(rows, selection, count, term.offset, term.int_low, term.int_high);
+                break;
+            case FieldType::UINT16:
+                count = select_range<uint16_t>(rows, selection, count, term.offset, term.int_low, term.int_high);
+                break;
+            default:
+                count = select_range<uint32_t>(rows, selection, count, term.offset, term.int_low, term.int_high);
+                break;
+        }
+    }
+    return count;
+}
+
+Bitmap CompiledFilter::evaluate(const RecordStore& store, size_t& rows_examined) const {
+    Bitmap result;
+    const Data* rows[FILTER_BLOCK_SIZE];
+    uint16_t selection[FILTER_BLOCK_SIZE];
+    for (size_t begin = 0; begin < store.size(); begin += FILTER_BLOCK_SIZE) {
+        size_t count = std::min(FILTER_BLOCK_SIZE, store.size() - begin);
+        for (size_t i = 0; i < count; ++i) {
+            rows[i] = store[begin + i];
+            selection[i] = static_cast<uint16_t>(i);
+        }
+        size_t kept = filterBlock(rows, selection, count);
+        uint32_t first_slot = store.firstSlot() + static_cast<uint32_t>(begin);
+        for (size_t i = 0; i < kept; ++i) result.add(first_slot + selection[i]);
+    }
+    rows_examined += store.size();
+    return result;
+}
+
+Bitmap CompiledFilter::evaluate(const RecordStore& store, const Bitmap& candidates, size_t& rows_examined) const {
+    Bitmap result;
+    const Data* rows[FILTER_BLOCK_SIZE];
+    uint32_t slots[FILTER_BLOCK_SIZE];
+    uint16_t selection[FILTER_BLOCK_SIZE];
+    size_t count = 0;
+
+    auto flush = [&]() {
+        for (size_t i = 0; i < count; ++i) selection[i] = static_cast<uint16_t>(i);
+        size_t kept = filterBlock(rows, selection, count);
+        for (size_t i = 0; i < kept; ++i) result.add(slots[selection[i]]);
+        rows_examined += count;
+        count = 0;
+    };
+    candidates.forEach([&](uint32_t slot) {
+        const Data* d = store.at(slot);
+        if (!d) return;
+        rows[count] = d;
+        slots[count] = slot;
+        if (++count == FILTER_BLOCK_SIZE) flush();
+    });
+    if (count > 0) flush();
+    return result;
+}
@@ -0,0 +1,85 @@
+#include "query/QueryCursor.h"
+#include <algorithm> // For std::make_heap, std::pop_heap, std::min_element
+#include <utility>   // For std::move
+
+PartialOrder::PartialOrder(std::vector<const Data*> rows, Comparator less)
+    : heap(std::move(rows)), less(std::move(less)) {
+    total_rows = heap.size();
+    // std heaps keep the "largest" element on top, so invert the comparator
+    // to have the next row in 'less' order at heap.front().
+    std::make_heap(heap.begin(), heap.end(), [this](const Data* a, const Data* b) { return this->less(b, a); });
+}
+
+PartialOrder PartialOrder::presorted(std::vector<const Data*> ordered_rows) {
+    PartialOrder order;
+    order.heap = std::move(ordered_rows);
+    order.total_rows = order.heap.size();
+    return order;
+}
+
+size_t PartialOrder::next(size_t n, std::vector<const Data*>& out) {
+    if (!less) {
+        size_t taken = std::min(n, heap.size() - position);
+        out.insert(out.end(), heap.begin() + position, heap.begin() + position + taken);
+        position += taken;
+        return taken;
+    }
+
+    auto heap_cmp = [this](const Data* a, const Data* b) { return less(b, a); };
+    size_t taken = 0;
+    while (taken < n && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), heap_cmp);
+        out.push_back(heap.back());
+        heap.pop_back();
+        ++taken;
+    }
+    return taken;
+}
+
+CursorManager::CursorManager(size_t max_cursors, std::chrono::seconds ttl)
+    : max_cursors(max_cursors), ttl(ttl) {}
+
+uint32_t CursorManager::open(PartialOrder order, size_t delivered) {
+    expireIdle();
+    if (cursors.size() >= max_cursors) {
+        // Evict the least recently used cursor to stay within the limit
+        auto lru = std::min_element(cursors.begin(), cursors.end(), [](const auto& a, const auto& b) {
+            return a.second.last_access < b.second.last_access;
+        });
+        cursors.erase(lru);
+    }
+    uint32_t id = next_id++;
+    cursors.emplace(id, Cursor{std::move(order), delivered, std::chrono::steady_clock::now()});
+    return id;
+}
+
+bool CursorManager::fetch(uint32_t cursor_id, size_t n, std::vector<const Data*>& out,
+                          size_t& first_row_number, size_t& remaining) {
+    expireIdle();
+    auto it = cursors.find(cursor_id);
+    if (it == cursors.end()) return false;
+
+    Cursor& cursor = it->second;
+    first_row_number = cursor.delivered + 1;
+    cursor.delivered += cursor.order.next(n, out);
+    cursor.last_access = std::chrono::steady_clock::now();
+    remaining = cursor.order.remaining();
+    if (remaining == 0) cursors.erase(it);
+    return true;
+}
+
+bool CursorManager::close(uint32_t cursor_id) {
+    return cursors.erase(cursor_id) > 0;
+}
+
+void CursorManager::expireIdle() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = cursors.begin(); it != cursors.end();) {
+        if (now - it->second.last_access > ttl) it = cursors.erase(it);
+        else ++it;
+    }
+}
+
+void CursorManager::invalidateAll() {
+    cursors.clear();
+}
@@ -0,0 +1,277 @@
+#include "query/QueryPlanner.h"
+#include "kernels.h" // For count_in_range
+#include <algorithm> // For std::stable_sort, std::min, std::max
+#include <chrono>    // For timing plan and execution
+#include <cmath>     // For std::log2, std::nextafter
+#include <iomanip>   // For std::setprecision
+#include <limits>    // For std::numeric_limits
+#include <sstream>   // For std::ostringstream
+
+namespace {
+
+// The closed float interval holding the same floats as [range.low, range.high]
+void float_bounds(const RangePredicate& range, float& low, float& high) {
+    low = static_cast<float>(range.low);
+    high = static_cast<float>(range.high);
+    if (low < range.low) low = std::nextafter(low, std::numeric_limits<float>::infinity());
+    if (high > range.high) high = std::nextafter(high, -std::numeric_limits<float>::infinity());
+}
+
+// Rough per-row costs (~ns) used to compare access paths. They only need to be right relative to each other.
+const double BITMAP_COST_PER_ROW = 0.05;   // Word-parallel container ops
+const double MATERIALIZE_COST_PER_ROW = 1.0; // Slot -> record pointer
+const double HEAP_COST_PER_ROW = 2.0;       // make_heap, ~2 comparisons per row
+const double SCAN_COST_PER_ROW = 3.0;       // Index iteration + record dereference + predicate check
+const double RANGE_INDEX_COST_PER_ROW = 2.0; // Range walk over a sorted index, per entry in range
+const double RANGE_SCAN_COST_PER_ROW = 0.5;  // Compiled block filter, per row it is applied to
+
+// Rows sampled to estimate the selectivity of a range without an index
+const size_t SELECTIVITY_SAMPLE_ROWS = 2048;
+
+double elapsed_us(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+bool parse_query_request(const std::map<std::string, std::string>& params, QueryRequest& request, std::string& error) {
+    if (!parse_categorical_predicates(params, request.predicates, error)) return false;
+    if (!parse_range_predicates(params, request.ranges, error)) return false;
+
+    auto param = [&](const char* key) -> const std::string* {
+        auto it = params.find(key);
+        return it == params.end() ? nullptr : &it->second;
+    };
+    if (auto v = param("sort_by")) request.sort_field = parse_sort_field(*v);
+    if (auto v = param("sort_order")) request.ascending = (*v == "asc");
+    if (auto v = param("limit")) {
+        try {
+            request.page_size = static_cast<size_t>(std::max(std::stoi(*v), 0));
+        } catch (const std::exception&) {
+            error = "Invalid limit '" + *v + "'.";
+            return false;
+        }
+    }
+    if (auto v = param("cursor")) request.want_cursor = (*v == "true");
+    if (auto v = param("stream")) request.stream = (*v == "true");
+    return true;
+}
+
+const char* access_path_name(AccessPath path) {
+    switch (path) {
+        case AccessPath::INDEX_WALK: return "INDEX_WALK";
+        case AccessPath::INDEX_INTERSECT: return "INDEX_INTERSECT";
+        case AccessPath::ORDERED_SCAN: return "ORDERED_SCAN";
+        default: return "UNKNOWN";
+    }
+}
+
+QueryPlanner::QueryPlanner(const RecordStore& store, const CategoricalIndexes& categorical, const SortedIndexes& sorted)
+    : store(store), categorical(categorical), sorted(sorted) {}
+
+QueryPlan QueryPlanner::plan(const QueryRequest& request) const {
+    QueryPlan plan;
+    plan.request = request;
+    plan.live_rows = store.size();
+    if (request.predicates.empty() && request.ranges.empty()) {
+        plan.path = AccessPath::INDEX_WALK;
+        plan.estimated_matches = plan.live_rows;
+        return plan;
+    }
+
+    // Selectivity of each predicate from the cardinality counters; independence is assumed when combining them
+    double combined_selectivity = 1.0;
+    double bitmap_rows = 0.0;
+    double range_cost = 0.0;
+    double candidate_selectivity = 1.0; // Of the bitmap-evaluated predicates, i.e. what the residual filter sees
+    bool has_bitmaps = !request.predicates.empty();
+    for (const RangePredicate& range : request.ranges) {
+        RangeEstimate estimate{range, Bitmap(), 0.0, range_has_index(range), 0, 0};
+        if (estimate.indexed) {
+            estimate.matches = evaluate_range(range, store, sorted, estimate.rows_examined);
+            estimate.estimated_rows = estimate.matches.cardinality();
+            estimate.selectivity = plan.live_rows ? static_cast<double>(estimate.estimated_rows) / plan.live_rows : 0.0;
+            bitmap_rows += static_cast<double>(estimate.estimated_rows);
+            range_cost += estimate.rows_examined * RANGE_INDEX_COST_PER_ROW;
+            candidate_selectivity *= estimate.selectivity;
+            has_bitmaps = true;
+        } else {
+            // Evenly spaced sample of the store, gathered into one column and counted by the range kernel
+            size_t stride = std::max<size_t>(1, plan.live_rows / SELECTIVITY_SAMPLE_ROWS);
+            std::vector<const Data*> sample;
+            for (size_t i = 0; i < plan.live_rows; i += stride) sample.push_back(store[i]);
+            std::vector<float> values(sample.size());
+            gather_field(sample.data(), sample.size(), *range.field, values.data());
+            float low, high;
+            float_bounds(range, low, high);
+            size_t hits = count_in_range(values.data(), values.size(), low, high);
+            estimate.rows_examined = sample.size();
+            estimate.selectivity = estimate.rows_examined ? static_cast<double>(hits) / estimate.rows_examined : 0.0;
+            estimate.estimated_rows = static_cast<size_t>(estimate.selectivity * plan.live_rows);
+        }
+        combined_selectivity *= estimate.selectivity;
+        plan.ranges.push_back(std::move(estimate));
+    }
+    std::sort(plan.ranges.begin(), plan.ranges.end(),
+              [](const RangeEstimate& a, const RangeEstimate& b) { return a.selectivity < b.selectivity; });
+
+    for (const CategoricalPredicate& predicate : request.predicates) {
+        size_t listed = 0;
+        for (uint8_t value : predicate.values) listed += categorical.count(predicate.field, value);
+        listed = std::min(listed, plan.live_rows);
+        size_t rows = predicate.negated ? plan.live_rows - listed : listed;
+        double selectivity = plan.live_rows ? static_cast<double>(rows) / plan.live_rows : 0.0;
+        plan.predicates.push_back({predicate, rows, selectivity});
+        combined_selectivity *= selectivity;
+        candidate_selectivity *= selectivity;
+        bitmap_rows += static_cast<double>(listed);
+    }
+    // Most selective first: it drives the intersection (and the scan rejects most rows on its first check)
+    std::stable_sort(plan.predicates.begin(), plan.predicates.end(),
+                     [](const PredicateEstimate& a, const PredicateEstimate& b) { return a.estimated_rows < b.estimated_rows; });
+    plan.estimated_matches = static_cast<size_t>(combined_selectivity * plan.live_rows);
+
+    // Compile the filters once, in evaluation order (most selective first)
+    std::vector<CategoricalPredicate> ordered_predicates;
+    for (const PredicateEstimate& estimate : plan.predicates) ordered_predicates.push_back(estimate.predicate);
+    std::vector<RangePredicate> ordered_ranges, unindexed;
+    for (const RangeEstimate& estimate : plan.ranges) {
+        ordered_ranges.push_back(estimate.predicate);
+        if (!estimate.indexed) unindexed.push_back(estimate.predicate);
+    }
+    plan.residual = CompiledFilter({}, unindexed);
+    plan.row_filter = CompiledFilter(ordered_predicates, ordered_ranges);
+    if (!plan.residual.empty()) {
+        double filtered_rows = has_bitmaps ? candidate_selectivity * plan.live_rows : static_cast<double>(plan.live_rows);
+        range_cost += filtered_rows * RANGE_SCAN_COST_PER_ROW;
+    }
+
+    double estimated = static_cast<double>(std::max<size_t>(plan.estimated_matches, 1));
+    double page = static_cast<double>(std::min(request.page_size, plan.estimated_matches));
+    // Both paths evaluate the bitmaps and the residual filter for the exact match count
+    double bitmap_cost = bitmap_rows * BITMAP_COST_PER_ROW + range_cost;
+
+    plan.intersect_cost = bitmap_cost
+        + estimated * (MATERIALIZE_COST_PER_ROW + HEAP_COST_PER_ROW)
+        + page * std::log2(estimated + 1.0);
+
+    // Without a cursor the scan stops after one page, which takes ~page/selectivity index entries
+    double rows_visited = static_cast<double>(plan.live_rows);
+    if (!request.want_cursor && combined_selectivity > 0.0)
+        rows_visited = std::min(rows_visited, (static_cast<double>(request.page_size) + 1.0) / combined_selectivity);
+    plan.ordered_scan_cost = bitmap_cost + rows_visited * SCAN_COST_PER_ROW;
+
+    plan.path = plan.ordered_scan_cost < plan.intersect_cost ? AccessPath::ORDERED_SCAN : AccessPath::INDEX_INTERSECT;
+    return plan;
+}
+
+PartialOrder QueryPlanner::execute(const QueryPlan& plan, QueryExecution& execution) const {
+    auto start = std::chrono::steady_clock::now();
+    const QueryRequest& request = plan.request;
+    PartialOrder order = PartialOrder::presorted({});
+
+    if (plan.path == AccessPath::INDEX_WALK) {
+        // Without a cursor only the first page is walked; with one, the whole walk is kept for FETCH
+        size_t wanted = request.want_cursor ? sorted.size() : std::min(request.page_size, sorted.size());
+        std::vector<const Data*> ordered;
+        ordered.reserve(wanted);
+        if (wanted > 0) {
+            sorted.walk(request.sort_field, request.ascending, [&](const Data* d) {
+                ordered.push_back(d);
+                return ordered.size() < wanted;
+            });
+        }
+        execution.total_matches = sorted.size();
+        execution.rows_examined = ordered.size();
+        order = PartialOrder::presorted(std::move(ordered));
+    } else {
+        std::vector<CategoricalPredicate> ordered_predicates;
+        for (const PredicateEstimate& estimate : plan.predicates) ordered_predicates.push_back(estimate.predicate);
+
+        // Indexed range bitmaps were built by plan(); intersect them with the categorical result,
+        // most selective first, then run the compiled residual filter over what is left
+        Bitmap matches;
+        bool has_matches = false;
+        if (!ordered_predicates.empty()) {
+            matches = categorical.evaluate(ordered_predicates, store.firstSlot(), store.endSlot());
+            has_matches = true;
+        }
+        for (const RangeEstimate& range : plan.ranges) {
+            if (!range.indexed) continue;
+            matches = has_matches ? matches.intersect(range.matches) : range.matches;
+            has_matches = true;
+        }
+        if (!plan.residual.empty() && !has_matches && columns) {
+            std::vector<RangePredicate> unindexed; // Already most selective first
+            for (const RangeEstimate& range : plan.ranges)
+                if (!range.indexed) unindexed.push_back(range.predicate);
+            matches = columns->select(unindexed, execution.rows_examined);
+        } else if (!plan.residual.empty()) {
+            matches = has_matches ? plan.residual.evaluate(store, matches, execution.rows_examined)
+                                  : plan.residual.evaluate(store, execution.rows_examined);
+        }
+        execution.total_matches = matches.cardinality();
+
+        if (plan.path == AccessPath::INDEX_INTERSECT) {
+            std::vector<const Data*> candidates;
+            candidates.reserve(execution.total_matches);
+            matches.forEach([&](uint32_t slot) { candidates.push_back(store.at(slot)); });
+            execution.rows_examined += candidates.size();
+            order = PartialOrder(std::move(candidates), make_sort_comparator(request.sort_field, request.ascending));
+        } else {
+            size_t wanted = request.want_cursor ? execution.total_matches : std::min(request.page_size, execution.total_matches);
+            std::vector<const Data*> ordered;
+            ordered.reserve(wanted);
+            if (wanted > 0) {
+                sorted.walk(request.sort_field, request.ascending, [&](const Data* d) {
+                    execution.rows_examined++;
+                    if (!plan.row_filter.matches(d)) return true;
+                    ordered.push_back(d);
+                    return ordered.size() < wanted;
+                });
+            }
+            order = PartialOrder::presorted(std::move(ordered));
+        }
+    }
+    execution.execute_us = elapsed_us(start);
+    return order;
+}
+
+std::string QueryPlanner::explain(const QueryPlan& plan, const QueryExecution& execution) const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "Plan for QUERY_FILTERED_SORTED over " << plan.live_rows << " live records:\n";
+    if (plan.predicates.empty() && plan.ranges.empty()) {
+        oss << "  Predicates: none\n";
+    } else {
+        oss << "  Predicates (evaluation order):\n";
+        for (size_t i = 0; i < plan.predicates.size(); ++i) {
+            const PredicateEstimate& estimate = plan.predicates[i];
+            oss << "    " << (i + 1) << ". " << categorical_field_name(estimate.predicate.field)
+                << (estimate.predicate.negated ? "!=" : "=");
+            for (size_t v = 0; v < estimate.predicate.values.size(); ++v)
+                oss << (v ? "," : "") << static_cast<int>(estimate.predicate.values[v]);
+            oss << "  est. rows " << estimate.estimated_rows
+                << " (selectivity " << std::setprecision(4) << estimate.selectivity << std::setprecision(1) << ")"
+                << (i == 0 ? "  [driving]" : "") << "\n";
+        }
+        for (const RangeEstimate& range : plan.ranges) {
+            oss << "    range " << describe_range(range.predicate) << (range.indexed ? "  rows " : "  est. rows ")
+                << range.estimated_rows << " (selectivity " << std::setprecision(4) << range.selectivity
+                << std::setprecision(1) << ") via "
+                << (range.indexed ? "sorted index, " : "compiled block filter, sampled ")
+                << range.rows_examined << " rows\n";
+        }
+    }
+    oss << "  Sort: " << sort_field_name(plan.request.sort_field) << (plan.request.ascending ? " asc" : " desc")
+        << ", page " << plan.request.page_size << (plan.request.want_cursor ? ", cursor" : "") << "\n";
+    oss << "  Estimated matches: " << plan.estimated_matches << "\n";
+    oss << "  Access path: " << access_path_name(plan.path);
+    if (plan.path != AccessPath::INDEX_WALK) {
+        oss << " (cost INDEX_INTERSECT " << plan.intersect_cost << ", ORDERED_SCAN " << plan.ordered_scan_cost << ")";
+    }
+    oss << "\n";
+    oss << "  Actual: " << execution.total_matches << " matches, " << execution.rows_examined << " rows examined, "
+        << "plan " << execution.plan_us << " us, execute " << execution.execute_us << " us\n";
+    return oss.str();
+}
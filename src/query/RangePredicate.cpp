@@ -0,0 +1,117 @@
+#include "query/RangePredicate.h"
+#include "query/CompiledFilter.h"
+#include <algorithm> // For std::max, std::min, std::sort
+#include <cmath>     // For std::nextafter
+#include <limits>    // For std::numeric_limits
+#include <sstream>   // For std::ostringstream
+
+namespace {
+
+const double INF = std::numeric_limits<double>::infinity();
+
+// Parses a constant in the precision of the field, so "dur=0.1" matches the float 0.1f.
+bool parse_constant(const NumericField& field, const std::string& text, double& value) {
+    try {
+        size_t used = 0;
+        value = std::stod(text, &used);
+        if (used != text.size()) return false;
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (field.type == FieldType::FLOAT) value = static_cast<float>(value);
+    return true;
+}
+
+} // namespace
+
+bool parse_range_predicates(const std::map<std::string, std::string>& params,
+                            std::vector<RangePredicate>& predicates, std::string& error) {
+    for (const auto& param : params) {
+        std::string name = param.first;
+        std::string op = "=";
+        for (const char* candidate : {">=", "<=", ">", "<", "!"}) {
+            std::string suffix = candidate;
+            if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                op = suffix;
+                name.erase(name.size() - suffix.size());
+                break;
+            }
+        }
+        const NumericField* field = find_numeric_field(name);
+        if (!field) continue; // Not a numeric filter
+        if (op == "!") {
+            error = "Operator != is only supported on categorical fields, not on '" + name + "'.";
+            return false;
+        }
+
+        double low = -INF, high = INF;
+        const std::string& value = param.second;
+        bool ok = true;
+        if (op == "=") {
+            size_t dots = value.find("..");
+            if (dots == std::string::npos) {
+                ok = parse_constant(*field, value, low);
+                high = low;
+            } else {
+                ok = parse_constant(*field, value.substr(0, dots), low) && parse_constant(*field, value.substr(dots + 2), high);
+            }
+        } else {
+            double x;
+            ok = parse_constant(*field, value, x);
+            if (op == ">=") low = x;
+            else if (op == ">") low = std::nextafter(x, INF);
+            else if (op == "<=") high = x;
+            else high = std::nextafter(x, -INF);
+        }
+        if (!ok) {
+            error = "Invalid value '" + value + "' for filter '" + name + "'.";
+            return false;
+        }
+
+        // Several terms on the same field (dur>0.1 dur<0.5) narrow a single range
+        auto existing = std::find_if(predicates.begin(), predicates.end(),
+                                     [field](const RangePredicate& p) { return p.field == field; });
+        if (existing != predicates.end()) {
+            existing->low = std::max(existing->low, low);
+            existing->high = std::min(existing->high, high);
+        } else {
+            predicates.push_back({field, low, high});
+        }
+    }
+    return true;
+}
+
+bool range_matches(const Data* d, const RangePredicate& predicate) {
+    double value = read_numeric_field(d, *predicate.field);
+    return value >= predicate.low && value <= predicate.high;
+}
+
+std::string describe_range(const RangePredicate& predicate) {
+    std::ostringstream oss;
+    oss << predicate.field->name << " in [" << predicate.low << ", " << predicate.high << "]";
+    return oss.str();
+}
+
+bool range_has_index(const RangePredicate& predicate) {
+    SortField field;
+    return find_sort_field(predicate.field->name, field);
+}
+
+Bitmap evaluate_range(const RangePredicate& predicate, const RecordStore& store,
+                      const SortedIndexes& sorted, size_t& rows_examined) {
+    std::vector<uint32_t> slots;
+    SortField sort_field;
+    if (find_sort_field(predicate.field->name, sort_field)) {
+        sorted.walkRange(sort_field, predicate.low, predicate.high, [&](const IndexEntry& entry) {
+            slots.push_back(entry.slot);
+        });
+        rows_examined += slots.size();
+        std::sort(slots.begin(), slots.end()); // Index order is by value; bitmaps are built in slot order
+    } else if (predicate.low <= predicate.high) {
+        return CompiledFilter({}, {predicate}).evaluate(store, rows_examined);
+    }
+
+    Bitmap result;
+    for (uint32_t slot : slots) result.add(slot);
+    return result;
+}
@@ -0,0 +1,19 @@
+#include "query/RecordStore.h"
+#include <algorithm> // For std::min
+
+uint32_t RecordStore::append(const Data& record) {
+    records.push_back(std::make_unique<Data>(record));
+    return endSlot() - 1;
+}
+
+size_t RecordStore::evictOldest(size_t n) {
+    n = std::min(n, records.size());
+    records.erase(records.begin(), records.begin() + n);
+    first_slot += static_cast<uint32_t>(n);
+    return n;
+}
+
+const Data* RecordStore::at(uint32_t slot) const {
+    if (slot < first_slot || slot >= endSlot()) return nullptr;
+    return records[slot - first_slot].get();
+}
@@ -0,0 +1,95 @@
+#include "query/ResultCache.h"
+#include <iterator> // For std::prev
+#include <sstream>  // For std::ostringstream
+
+ResultCache::ResultCache(size_t max_entries, size_t max_bytes)
+    : max_entries(max_entries), max_bytes(max_bytes) {}
+
+void ResultCache::setTolerance(const std::string& command, std::chrono::milliseconds max_age) {
+    tolerances[command] = max_age;
+}
+
+bool ResultCache::lookup(const std::string& command, const std::string& key, const CacheEpoch& epoch,
+                         std::string& reply, Clock::time_point now) {
+    auto found = index.find(key);
+    if (found == index.end()) {
+        ++counters.misses;
+        return false;
+    }
+
+    auto it = found->second;
+    bool fresh = it->epoch == epoch;
+    if (!fresh) {
+        auto tolerance = tolerances.find(command);
+        bool tolerated = tolerance != tolerances.end() && now - it->computed_at <= tolerance->second;
+        if (!tolerated) {
+            erase(it);
+            ++counters.invalidations;
+            ++counters.misses;
+            return false;
+        }
+    }
+
+    lru.splice(lru.begin(), lru, it);
+    reply = it->reply;
+    ++(fresh ? counters.hits : counters.stale_hits);
+    return true;
+}
+
+void ResultCache::store(const std::string& key, const CacheEpoch& epoch, const std::string& reply,
+                        Clock::time_point now) {
+    if (max_entries == 0 || reply.size() > max_bytes) return;
+
+    auto found = index.find(key);
+    if (found != index.end()) erase(found->second);
+
+    lru.push_front(Entry{key, reply, epoch, now});
+    index[key] = lru.begin();
+    total_bytes += key.size() + reply.size();
+
+    while (index.size() > max_entries || total_bytes > max_bytes) {
+        erase(std::prev(lru.end()));
+        ++counters.evictions;
+    }
+}
+
+void ResultCache::invalidateAll() {
+    counters.invalidations += index.size();
+    lru.clear();
+    index.clear();
+    total_bytes = 0;
+}
+
+void ResultCache::erase(std::list<Entry>::iterator it) {
+    total_bytes -= it->key.size() + it->reply.size();
+    index.erase(it->key);
+    lru.erase(it);
+}
+
+std::string ResultCache::describe() const {
+    uint64_t lookups = counters.hits + counters.stale_hits + counters.misses;
+    std::ostringstream oss;
+    oss << "Result cache: " << index.size() << "/" << max_entries << " entries, "
+        << total_bytes << "/" << max_bytes << " bytes\n";
+    oss << "  Hits:          " << counters.hits << "\n";
+    oss << "  Stale hits:    " << counters.stale_hits << "\n";
+    oss << "  Misses:        " << counters.misses << "\n";
+    oss << "  Hit rate:      " << (lookups ? 100.0 * (counters.hits + counters.stale_hits) / lookups : 0.0) << "%\n";
+    oss << "  Invalidations: " << counters.invalidations << "\n";
+    oss << "  Evictions:     " << counters.evictions << "\n";
+    for (const auto& tolerance : tolerances) {
+        oss << "  Tolerance " << tolerance.first << ": " << tolerance.second.count() << " ms\n";
+    }
+    return oss.str();
+}
+
+std::string normalize_request(const std::string& command, const std::map<std::string, std::string>& params) {
+    std::string key = command;
+    for (const auto& param : params) {
+        key += ' ';
+        key += param.first;
+        key += '=';
+        key += param.second;
+    }
+    return key;
+}
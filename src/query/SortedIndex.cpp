@@ -0,0 +1,72 @@
+#include "query/SortedIndex.h"
+
+SortField parse_sort_field(const std::string& name) {
+    SortField field;
+    return find_sort_field(name, field) ? field : SortField::ID;
+}
+
+bool find_sort_field(const std::string& name, SortField& field) {
+    if (name == "id") field = SortField::ID;
+    else if (name == "dur") field = SortField::DUR;
+    else if (name == "rate") field = SortField::RATE;
+    else if (name == "sbytes") field = SortField::SBYTES;
+    else if (name == "dbytes") field = SortField::DBYTES;
+    else return false;
+    return true;
+}
+
+const char* sort_field_name(SortField field) {
+    switch (field) {
+        case SortField::DUR: return "dur";
+        case SortField::RATE: return "rate";
+        case SortField::SBYTES: return "sbytes";
+        case SortField::DBYTES: return "dbytes";
+        default: return "id";
+    }
+}
+
+PartialOrder::Comparator make_sort_comparator(SortField field, bool ascending) {
+    return make_field_comparator(*find_numeric_field(sort_field_name(field)), ascending);
+}
+
+PartialOrder::Comparator make_field_comparator(const NumericField& field, bool ascending) {
+    return visit_field_type(field.type, [&](auto tag) -> PartialOrder::Comparator {
+        using T = decltype(tag);
+        const size_t offset = field.offset;
+        if (ascending) return [offset](const Data* a, const Data* b) { return read_field<T>(a, offset) < read_field<T>(b, offset); };
+        return [offset](const Data* a, const Data* b) { return read_field<T>(a, offset) > read_field<T>(b, offset); };
+    });
+}
+
+SortedIndexes::SortedIndexes()
+    : by_id([](const Data* d) -> uint32_t { return d->id; }),
+      by_dur([](const Data* d) -> float { return d->dur; }),
+      by_rate([](const Data* d) -> float { return d->rate; }),
+      by_sbytes([](const Data* d) -> uint32_t { return d->sbytes; }),
+      by_dbytes([](const Data* d) -> uint32_t { return d->dbytes; }) {}
+
+void SortedIndexes::insert(const Data* d, uint32_t slot) {
+    if (!d) return;
+    by_id.insert(d, slot);
+    by_dur.insert(d, slot);
+    by_rate.insert(d, slot);
+    by_sbytes.insert(d, slot);
+    by_dbytes.insert(d, slot);
+}
+
+void SortedIndexes::remove(const Data* d) {
+    if (!d) return;
+    by_id.remove(d);
+    by_dur.remove(d);
+    by_rate.remove(d);
+    by_sbytes.remove(d);
+    by_dbytes.remove(d);
+}
+
+void SortedIndexes::clear() {
+    by_id.clear();
+    by_dur.clear();
+    by_rate.clear();
+    by_sbytes.clear();
+    by_dbytes.clear();
+}
@@ -0,0 +1,131 @@
+#include "query/Subscription.h"
+#include <algorithm> // For std::max, std::min
+#include <cmath>     // For std::sqrt
+#include <iomanip>   // For std::fixed, std::setprecision
+#include <sstream>   // For std::ostringstream
+
+void RunningStats::add(double value) {
+    ++count;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+double RunningStats::stdDev() const {
+    return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
+}
+
+SubscriptionManager::SubscriptionManager(size_t max_subscriptions, const std::string& topic_prefix)
+    : max_subscriptions(max_subscriptions), topic_prefix(topic_prefix) {}
+
+uint32_t SubscriptionManager::subscribe(SubscriptionKind kind, const std::map<std::string, std::string>& params,
+                                        std::string& error) {
+    if (subscriptions.size() >= max_subscriptions) {
+        error = "Too many subscriptions (max " + std::to_string(max_subscriptions) + ").";
+        return 0;
+    }
+
+    Subscription sub;
+    sub.kind = kind;
+    sub.max_rows = 100;
+    sub.field = nullptr;
+    if (!parse_categorical_predicates(params, sub.predicates, error)) return 0;
+    if (!parse_range_predicates(params, sub.ranges, error)) return 0;
+
+    auto limit = params.find("limit");
+    if (limit != params.end()) {
+        try {
+            sub.max_rows = static_cast<size_t>(std::max(std::stoi(limit->second), 0));
+        } catch (const std::exception&) {
+            error = "Invalid limit '" + limit->second + "'.";
+            return 0;
+        }
+    }
+    if (kind == SubscriptionKind::STATS) {
+        auto field = params.find("field");
+        if (field == params.end() || !(sub.field = find_numeric_field(field->second))) {
+            error = "STATS subscriptions need field=<numeric field>.";
+            return 0;
+        }
+    }
+
+    uint32_t id = next_id++;
+    sub.id = id;
+    // SUB sockets filter on topic prefixes: the trailing dot keeps "sub.1." from matching "sub.10."
+    sub.topic = topic_prefix + std::to_string(id) + ".";
+    subscriptions.emplace(id, std::move(sub));
+    return id;
+}
+
+bool SubscriptionManager::unsubscribe(uint32_t id) {
+    return subscriptions.erase(id) > 0;
+}
+
+const Subscription* SubscriptionManager::find(uint32_t id) const {
+    auto it = subscriptions.find(id);
+    return it == subscriptions.end() ? nullptr : &it->second;
+}
+
+void SubscriptionManager::onBatch(const RecordStore& store, uint32_t first_slot, uint32_t end_slot,
+                                  std::vector<Publication>& out) {
+    first_slot = std::max(first_slot, store.firstSlot());
+    end_slot = std::min(end_slot, store.endSlot());
+    if (first_slot >= end_slot) return;
+
+    for (auto& entry : subscriptions) {
+        Subscription& sub = entry.second;
+        Publication publication;
+        size_t matches = 0;
+        for (uint32_t slot = first_slot; slot < end_slot; ++slot) {
+            const Data* d = store.at(slot);
+            bool ok = true;
+            for (const CategoricalPredicate& predicate : sub.predicates) {
+                if (!predicate_matches(d, predicate)) { ok = false; break; }
+            }
+            for (size_t i = 0; ok && i < sub.ranges.size(); ++i) ok = range_matches(d, sub.ranges[i]);
+            if (!ok) continue;
+
+            ++matches;
+            if (sub.kind == SubscriptionKind::STATS) {
+                sub.stats.add(read_numeric_field(d, *sub.field));
+            } else if (publication.rows.size() < sub.max_rows) {
+                publication.rows.push_back(d);
+            }
+        }
+        if (matches == 0) continue; // Nothing new for this subscriber
+
+        std::ostringstream header;
+        if (sub.kind == SubscriptionKind::FILTER) {
+            header << "Subscription " << sub.id << ": " << matches << " new matching records"
+                   << (matches > publication.rows.size() ? " (truncated to " + std::to_string(publication.rows.size()) + ")" : "")
+                   << ".\n";
+        } else {
+            header << std::fixed << std::setprecision(4);
+            header << "Subscription " << sub.id << ": " << sub.field->name << " over " << sub.stats.count
+                   << " records (+" << matches << ")\n";
+            header << "  Average: " << sub.stats.mean << "\n";
+            header << "  Std Dev: " << sub.stats.stdDev() << "\n";
+            header << "  Min:     " << sub.stats.min << "\n";
+            header << "  Max:     " << sub.stats.max << "\n";
+        }
+        publication.topic = sub.topic;
+        publication.header = header.str();
+        ++sub.published;
+        out.push_back(std::move(publication));
+    }
+}
+
+std::string SubscriptionManager::describe() const {
+    std::ostringstream oss;
+    oss << "Subscriptions: " << subscriptions.size() << "/" << max_subscriptions << "\n";
+    for (const auto& entry : subscriptions) {
+        const Subscription& sub = entry.second;
+        oss << "  " << sub.topic << "  " << (sub.kind == SubscriptionKind::FILTER ? "FILTER" : "STATS");
+        if (sub.field) oss << " " << sub.field->name;
+        oss << "  " << sub.predicates.size() << " categorical / " << sub.ranges.size() << " range filters, "
+            << sub.published << " messages published\n";
+    }
+    return oss.str();
+}
@@ -0,0 +1,149 @@
+#include "server/LatencyStats.h"
+#include <algorithm> // For std::min
+#include <iomanip>   // For std::setw, std::setprecision
+#include <sstream>   // For std::ostringstream
+
+size_t LatencyHistogram::bucketOf(uint64_t nanoseconds) {
+    if (nanoseconds < 2 * SUB_BUCKETS) return static_cast<size_t>(nanoseconds);
+    unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(nanoseconds));
+    if (exponent >= MAX_EXPONENT) return BUCKET_COUNT - 1;
+    unsigned shift = exponent - SUB_BUCKET_BITS;
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + static_cast<size_t>((nanoseconds >> shift) - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketLow(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) return bucket;
+    unsigned shift = static_cast<unsigned>((bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS) + 1;
+    uint64_t sub = (bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return sub << shift;
+}
+
+uint64_t LatencyHistogram::bucketHigh(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) return bucket;
+    unsigned shift = static_cast<unsigned>((bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS) + 1;
+    return bucketLow(bucket) + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    buckets[bucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t seen = maximum.load(std::memory_order_relaxed);
+    while (nanoseconds > seen && !maximum.compare_exchange_weak(seen, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    // Rank of the wanted sample, 1-based; concurrent recordings may make the buckets run past 'n'
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(n) + 0.5);
+    rank = std::min<uint64_t>(std::max<uint64_t>(rank, 1), n);
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(max(), (bucketLow(b) + bucketHigh(b)) / 2);
+    }
+    return max();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+const char* request_phase_name(RequestPhase phase) {
+    switch (phase) {
+        case RequestPhase::QUEUE_WAIT: return "queue";
+        case RequestPhase::PARSE: return "parse";
+        case RequestPhase::EXECUTE: return "execute";
+        case RequestPhase::FORMAT: return "format";
+        default: return "total";
+    }
+}
+
+ServerStats::ServerStats(const std::vector<std::string>& commands)
+    : commands(commands) {
+    this->commands.push_back("OTHER");
+    histograms.reset(new LatencyHistogram[this->commands.size() * (MAX_DS_ID + 1) * REQUEST_PHASE_COUNT]);
+}
+
+size_t ServerStats::commandIndex(const std::string& command) const {
+    for (size_t i = 0; i + 1 < commands.size(); ++i)
+        if (commands[i] == command) return i;
+    return commands.size() - 1;
+}
+
+LatencyHistogram& ServerStats::histogram(size_t command, int ds_id, RequestPhase phase) const {
+    if (ds_id < 0 || ds_id > MAX_DS_ID) ds_id = 0;
+    return histograms[(command * (MAX_DS_ID + 1) + ds_id) * REQUEST_PHASE_COUNT + static_cast<size_t>(phase)];
+}
+
+void ServerStats::record(const std::string& command, int ds_id, RequestPhase phase, uint64_t nanoseconds) {
+    histogram(commandIndex(command), ds_id, phase).record(nanoseconds);
+}
+
+const LatencyHistogram* ServerStats::find(const std::string& command, int ds_id, RequestPhase phase) const {
+    return &histogram(commandIndex(command), ds_id, phase);
+}
+
+std::string ServerStats::describe() const {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << "Server latency (us):\n";
+    oss << std::left << std::setw(28) << "  command [ds]" << std::setw(9) << "phase" << std::right
+        << std::setw(9) << "count" << std::setw(11) << "p50" << std::setw(11) << "p90" << std::setw(11) << "p99"
+        << std::setw(11) << "p999" << std::setw(11) << "max" << "\n";
+    bool any = false;
+    for (size_t c = 0; c < commands.size(); ++c) {
+        for (int ds = 0; ds <= MAX_DS_ID; ++ds) {
+            if (histogram(c, ds, RequestPhase::TOTAL).count() == 0) continue;
+            any = true;
+            std::string series = "  " + commands[c] + (ds ? " [" + std::to_string(ds) + "]" : "");
+            for (size_t p = 0; p < REQUEST_PHASE_COUNT; ++p) {
+                const LatencyHistogram& h = histogram(c, ds, static_cast<RequestPhase>(p));
+                oss << std::left << std::setw(28) << (p == 0 ? series : "") << std::setw(9)
+                    << request_phase_name(static_cast<RequestPhase>(p)) << std::right << std::setw(9) << h.count();
+                for (double q : {0.5, 0.9, 0.99, 0.999}) oss << std::setw(11) << h.percentile(q) / 1000.0;
+                oss << std::setw(11) << h.max() / 1000.0 << "\n";
+            }
+        }
+    }
+    if (!any) oss << "  No requests recorded yet.\n";
+    return oss.str();
+}
+
+void ServerStats::reset() {
+    for (size_t i = 0; i < commands.size() * (MAX_DS_ID + 1) * REQUEST_PHASE_COUNT; ++i) histograms[i].reset();
+}
+
+RequestTimer::RequestTimer(ServerStats& stats, Clock::time_point received, Clock::duration queue_wait)
+    : stats(stats), received(received), phase_start(received) {
+    elapsed[static_cast<size_t>(RequestPhase::QUEUE_WAIT)] =
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(queue_wait).count());
+}
+
+void RequestTimer::enter(RequestPhase next) {
+    Clock::time_point now = Clock::now();
+    elapsed[static_cast<size_t>(phase)] += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_start).count());
+    phase = next;
+    phase_start = now;
+}
+
+void RequestTimer::finish() {
+    if (finished) return;
+    finished = true;
+    enter(RequestPhase::TOTAL);
+    elapsed[static_cast<size_t>(RequestPhase::TOTAL)] = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(phase_start - received).count());
+    for (size_t p = 0; p < REQUEST_PHASE_COUNT; ++p)
+        stats.record(command, ds_id, static_cast<RequestPhase>(p), elapsed[p]);
+}
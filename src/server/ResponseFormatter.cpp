@@ -0,0 +1,258 @@
+#include "server/ResponseFormatter.h"
+#include <algorithm> // For std::max
+#include <charconv>  // For std::to_chars
+#include <cmath>     // For std::isfinite
+#include <cstring>   // For std::memcpy, std::strlen
+
+ResponseBuffer::ResponseBuffer(size_t initial_capacity)
+    : storage(new char[std::max<size_t>(initial_capacity, 64)]), allocated(std::max<size_t>(initial_capacity, 64)) {}
+
+char* ResponseBuffer::reserve(size_t n) {
+    if (length + n > allocated) {
+        size_t grown = std::max(allocated * 2, length + n);
+        std::unique_ptr<char[]> bigger(new char[grown]);
+        std::memcpy(bigger.get(), storage.get(), length);
+        storage = std::move(bigger);
+        allocated = grown;
+    }
+    return storage.get() + length;
+}
+
+void ResponseBuffer::append(const char* text, size_t n) {
+    std::memcpy(reserve(n), text, n);
+    length += n;
+}
+
+void ResponseBuffer::append(const char* text) {
+    append(text, std::strlen(text));
+}
+
+void ResponseBuffer::append(char c) {
+    *reserve(1) = c;
+    ++length;
+}
+
+void ResponseBuffer::appendUInt(uint64_t value) {
+    char* out = reserve(20);
+    length = std::to_chars(out, out + 20, value).ptr - storage.get();
+}
+
+void ResponseBuffer::appendFixed(double value, int precision) {
+    // 309 integer digits for the largest double, plus sign, point and decimals
+    const size_t room = 320 + static_cast<size_t>(precision);
+    char* out = reserve(room);
+    auto result = std::to_chars(out, out + room, value, std::chars_format::fixed, precision);
+    length = result.ptr - storage.get();
+}
+
+BufferPool& BufferPool::instance() {
+    static BufferPool pool;
+    return pool;
+}
+
+void PooledBufferDeleter::operator()(ResponseBuffer* buffer) const {
+    BufferPool::instance().release(buffer);
+}
+
+PooledBuffer BufferPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_buffers.empty()) {
+            PooledBuffer buffer(free_buffers.back().release());
+            free_buffers.pop_back();
+            buffer->clear();
+            return buffer;
+        }
+    }
+    return PooledBuffer(new ResponseBuffer());
+}
+
+void BufferPool::release(ResponseBuffer* buffer) {
+    std::unique_ptr<ResponseBuffer> owned(buffer);
+    if (!owned || owned->capacity() > MAX_POOLED_CAPACITY) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_buffers.size() < MAX_IDLE_BUFFERS) free_buffers.push_back(std::move(owned));
+}
+
+void BufferPool::zmqFree(void* /*data*/, void* hint) {
+    instance().release(static_cast<ResponseBuffer*>(hint));
+}
+
+size_t BufferPool::idle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return free_buffers.size();
+}
+
+bool parse_output_format(const std::string& name, OutputFormat& format) {
+    if (name == "text") format = OutputFormat::TEXT;
+    else if (name == "json") format = OutputFormat::JSON;
+    else if (name == "csv") format = OutputFormat::CSV;
+    else return false;
+    return true;
+}
+
+void append_record_summary(ResponseBuffer& out, const Data& d) {
+    out.append("ID: ");
+    out.appendUInt(d.id);
+    out.append(", Dur: ");
+    out.appendFixed(d.dur, 2);
+    out.append("s, SBytes: ");
+    out.appendUInt(d.sbytes);
+    out.append(", DBytes: ");
+    out.appendUInt(d.dbytes);
+    out.append(", Rate: ");
+    out.appendFixed(d.rate, 2);
+    out.append(", Proto: ");
+    out.appendUInt(static_cast<uint8_t>(d.proto));
+    out.append(d.label ? ", Label: Attack" : ", Label: Normal");
+}
+
+void append_record_table(ResponseBuffer& out, const Data& d) {
+    auto line_f = [&out](const char* name, float value) {
+        out.append(name);
+        out.appendFixed(value, 4);
+        out.append('\n');
+    };
+    auto line_u = [&out](const char* name, uint64_t value) {
+        out.append(name);
+        out.appendUInt(value);
+        out.append('\n');
+    };
+    out.append("--- Data Record Details (ID: ");
+    out.appendUInt(d.id);
+    out.append(") ---\n");
+    line_u("ID: ", d.id);
+    line_f("Duration (s): ", d.dur);
+    line_f("Rate (pkts/s): ", d.rate);
+    line_f("Source Load (bytes/s): ", d.sload);
+    line_f("Destination Load (bytes/s): ", d.dload);
+    line_u("Source Packets: ", d.spkts);
+    line_u("Dest Packets: ", d.dpkts);
+    line_u("Source Bytes: ", d.sbytes);
+    line_u("Dest Bytes: ", d.dbytes);
+    out.append(d.label ? "Label (Attack): True\n" : "Label (Attack): False\n");
+    line_u("Protocol: ", static_cast<uint8_t>(d.proto));
+    line_u("State: ", static_cast<uint8_t>(d.state));
+    line_u("Service: ", static_cast<uint8_t>(d.service));
+    line_u("Attack Category: ", static_cast<uint8_t>(d.attack_category));
+    out.append("--------------------------------------\n");
+}
+
+namespace {
+
+// JSON has no NaN or Infinity literals
+void append_json_number(ResponseBuffer& out, float value) {
+    if (std::isfinite(value)) out.appendFixed(value, 6);
+    else out.append("null");
+}
+
+void append_json_row(ResponseBuffer& out, size_t row_number, const Data& d) {
+    out.append("{\"row\":");
+    out.appendUInt(row_number);
+    out.append(",\"id\":");
+    out.appendUInt(d.id);
+    out.append(",\"dur\":");
+    append_json_number(out, d.dur);
+    out.append(",\"rate\":");
+    append_json_number(out, d.rate);
+    out.append(",\"sbytes\":");
+    out.appendUInt(d.sbytes);
+    out.append(",\"dbytes\":");
+    out.appendUInt(d.dbytes);
+    out.append(",\"proto\":");
+    out.appendUInt(static_cast<uint8_t>(d.proto));
+    out.append(",\"state\":");
+    out.appendUInt(static_cast<uint8_t>(d.state));
+    out.append(",\"service\":");
+    out.appendUInt(static_cast<uint8_t>(d.service));
+    out.append(",\"attack_cat\":");
+    out.appendUInt(static_cast<uint8_t>(d.attack_category));
+    out.append(d.label ? ",\"label\":true}" : ",\"label\":false}");
+}
+
+void append_csv_row(ResponseBuffer& out, size_t row_number, const Data& d) {
+    out.appendUInt(row_number);
+    out.append(',');
+    out.appendUInt(d.id);
+    out.append(',');
+    out.appendFixed(d.dur, 6);
+    out.append(',');
+    out.appendFixed(d.rate, 6);
+    out.append(',');
+    out.appendUInt(d.sbytes);
+    out.append(',');
+    out.appendUInt(d.dbytes);
+    out.append(',');
+    out.appendUInt(static_cast<uint8_t>(d.proto));
+    out.append(',');
+    out.appendUInt(static_cast<uint8_t>(d.state));
+    out.append(',');
+    out.appendUInt(static_cast<uint8_t>(d.service));
+    out.append(',');
+    out.appendUInt(static_cast<uint8_t>(d.attack_category));
+    out.append(d.label ? ",1\n" : ",0\n");
+}
+
+} // namespace
+
+void append_page_header(ResponseBuffer& out, OutputFormat format, const PageInfo& page,
+                        const std::string& text_header, bool streamed) {
+    switch (format) {
+        case OutputFormat::TEXT:
+            out.append(text_header);
+            break;
+        case OutputFormat::JSON:
+            out.append("{\"matches\":");
+            out.appendUInt(page.matches);
+            out.append(",\"first_row\":");
+            out.appendUInt(page.first_row_number);
+            out.append(",\"remaining\":");
+            out.appendUInt(page.remaining);
+            if (page.cursor_id != 0) {
+                out.append(",\"cursor\":");
+                out.appendUInt(page.cursor_id);
+            }
+            out.append(streamed ? "}" : ",\"rows\":[");
+            break;
+        case OutputFormat::CSV:
+            out.append("# matches=");
+            out.appendUInt(page.matches);
+            out.append(" first_row=");
+            out.appendUInt(page.first_row_number);
+            out.append(" remaining=");
+            out.appendUInt(page.remaining);
+            if (page.cursor_id != 0) {
+                out.append(" cursor=");
+                out.appendUInt(page.cursor_id);
+            }
+            out.append("\nrow,id,dur,rate,sbytes,dbytes,proto,state,service,attack_cat,label\n");
+            break;
+    }
+}
+
+void append_rows(ResponseBuffer& out, OutputFormat format, const Data* const* rows, size_t count,
+                 size_t first_row_number, bool standalone) {
+    if (format == OutputFormat::JSON && standalone) out.append('[');
+    for (size_t i = 0; i < count; ++i) {
+        switch (format) {
+            case OutputFormat::TEXT:
+                out.appendUInt(first_row_number + i);
+                out.append(". ");
+                append_record_summary(out, *rows[i]);
+                out.append('\n');
+                break;
+            case OutputFormat::JSON:
+                if (i > 0) out.append(',');
+                append_json_row(out, first_row_number + i, *rows[i]);
+                break;
+            case OutputFormat::CSV:
+                append_csv_row(out, first_row_number + i, *rows[i]);
+                break;
+        }
+    }
+    if (format == OutputFormat::JSON && standalone) out.append(']');
+}
+
+void append_page_footer(ResponseBuffer& out, OutputFormat format, bool streamed) {
+    if (format == OutputFormat::JSON && !streamed) out.append("]}");
+}
@@ -0,0 +1,58 @@
+#include "server/TimeRollup.h"
+#include <algorithm>       // For std::max, std::min
+#include "data_fields.h"   // For statistic_feature_field
+#include "kernels.h"       // For reduce_field
+
+double RollupFeature::variance(uint64_t count) const {
+    if (count == 0) return 0.0;
+    double centered_mean = sum / count;
+    return std::max(0.0, sum_squares / count - centered_mean * centered_mean);
+}
+
+TimeRollup::TimeRollup(int64_t resolution_ms, size_t capacity)
+    : resolution_ms(std::max<int64_t>(resolution_ms, 1)), ring(std::max<size_t>(capacity, 1)) {}
+
+void TimeRollup::addBatch(const Data* records, size_t n, int64_t timestamp_ms) {
+    if (n == 0 || timestamp_ms < 0) return;
+    int64_t index = timestamp_ms / resolution_ms;
+    if (latest_index >= 0 && index <= latest_index - static_cast<int64_t>(ring.size())) return; // Already recycled
+    latest_index = std::max(latest_index, index);
+
+    RollupBucket& bucket = ring[static_cast<size_t>(index % static_cast<int64_t>(ring.size()))];
+    if (bucket.index != index) {
+        bucket = RollupBucket();
+        bucket.index = index;
+    }
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        const NumericField& field = statistic_feature_field(static_cast<StatisticFeature>(f));
+        RollupFeature& feature = bucket.features[f];
+        if (bucket.count == 0) {
+            feature.shift = static_cast<float>(read_numeric_field(records, field));
+            feature.min = feature.max = feature.shift;
+        }
+        // The whole batch falls into this bucket, so it is reduced in one strided pass
+        Reduction r = reduce_field(records, n, field.offset, field.type, feature.shift);
+        feature.sum += r.sum;
+        feature.sum_squares += r.sum_squares;
+        feature.min = std::min(feature.min, r.min);
+        feature.max = std::max(feature.max, r.max);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        ++bucket.labels[records[i].label ? 1 : 0];
+        size_t category = static_cast<size_t>(records[i].attack_category);
+        if (category < ATTACK_CATEGORY_COUNT) ++bucket.attack_categories[category];
+    }
+    bucket.count += n;
+}
+
+std::vector<const RollupBucket*> TimeRollup::series(int64_t from_ms, int64_t to_ms) const {
+    std::vector<const RollupBucket*> buckets;
+    if (latest_index < 0 || to_ms < from_ms) return buckets;
+    int64_t first = std::max<int64_t>(std::max<int64_t>(from_ms, 0) / resolution_ms, latest_index - static_cast<int64_t>(ring.size()) + 1);
+    int64_t last = std::min(to_ms / resolution_ms, latest_index);
+    for (int64_t index = std::max<int64_t>(first, 0); index <= last; ++index) {
+        const RollupBucket& bucket = ring[static_cast<size_t>(index % static_cast<int64_t>(ring.size()))];
+        if (bucket.index == index && bucket.count > 0) buckets.push_back(&bucket);
+    }
+    return buckets;
+}
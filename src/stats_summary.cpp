@@ -0,0 +1,78 @@
+#include "stats_summary.h"
+#include "kernels.h"     // For reduce
+#include "thread_pool.h" // For parallel_chunks
+#include <algorithm> // For std::nth_element, std::max_element
+
+const char* statistic_feature_name(StatisticFeature feature) {
+    if (static_cast<size_t>(feature) >= STATISTIC_FEATURE_COUNT) return "unknown";
+    return statistic_feature_field(feature).name;
+}
+
+void Moments::merge(const Moments& other) {
+    if (other.count == 0) return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    double total = static_cast<double>(count + other.count);
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+    count += other.count;
+}
+
+Moments compute_moments(const float* values, size_t n) {
+    size_t chunks = chunk_count(n);
+    std::vector<Moments> partial(chunks);
+    parallel_chunks(n, chunks, [&](size_t chunk, size_t begin, size_t end) {
+        if (begin == end) return;
+        size_t length = end - begin;
+        // A first pass for the mean, min and max, a second one shifted by the mean for M2
+        Reduction first = reduce(values + begin, length, values[begin]);
+        Moments& m = partial[chunk];
+        m.count = length;
+        m.mean = values[begin] + first.sum / length;
+        m.min = first.min;
+        m.max = first.max;
+        Reduction centered = reduce(values + begin, length, static_cast<float>(m.mean));
+        m.m2 = std::max(0.0, centered.sum_squares - centered.sum * centered.sum / length);
+    });
+    Moments total;
+    for (const Moments& m : partial) total.merge(m);
+    return total;
+}
+
+void SummaryBuilder::addField(const Data* const* rows, size_t n, const NumericField& field) {
+    size_t start = values.size();
+    values.resize(start + n);
+    float* out = values.data() + start;
+    parallel_chunks(n, chunk_count(n), [&](size_t, size_t begin, size_t end) {
+        gather_field(rows + begin, end - begin, field, out + begin);
+    });
+}
+
+StatsSummary SummaryBuilder::finish() {
+    StatsSummary summary;
+    summary.count = values.size();
+    if (values.empty()) return summary;
+    Moments moments = compute_moments(values.data(), values.size());
+    summary.mean = moments.mean;
+    summary.variance = moments.variance();
+    summary.min = moments.min;
+    summary.max = moments.max;
+
+    summary.median = select_median(values.data(), values.size());
+    return summary;
+}
+
+float select_median(float* values, size_t n) {
+    if (n == 0) return 0.0f;
+    size_t mid = n / 2;
+    std::nth_element(values, values + mid, values + n);
+    float upper = values[mid];
+    if (n % 2 != 0) return upper;
+    float lower = *std::max_element(values, values + mid);
+    return (lower + upper) / 2.0f;
+}
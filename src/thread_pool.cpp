@@ -0,0 +1,102 @@
+#include "thread_pool.h"
+#include <atomic>
+#include <cmath>   // For std::ceil
+#include <cstdlib> // For std::getenv, std::strtoul, std::strtod
+#include <fstream> // For the cgroup CPU quota
+#include <memory>  // For std::shared_ptr
+#include <string>
+
+namespace {
+
+// Hardware threads, capped by the cgroup CPU quota rounded up (docker's --cpus / deploy.resources.limits.cpus):
+// cgroup v2 cpu.max ("<quota> <period>" or "max <period>"), else cgroup v1 cfs_quota_us (-1 without a quota).
+size_t available_cpus() {
+    size_t cpus = std::max(std::thread::hardware_concurrency(), 1u);
+    double quota = 0.0, period = 0.0;
+    std::string v2_quota;
+    std::ifstream cpu_max("/sys/fs/cgroup/cpu.max");
+    if (cpu_max >> v2_quota >> period) {
+        if (v2_quota != "max") quota = std::strtod(v2_quota.c_str(), nullptr);
+    } else {
+        std::ifstream cfs_quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us"), cfs_period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if (!(cfs_quota >> quota && cfs_period >> period)) quota = 0.0;
+    }
+    if (quota > 0.0 && period > 0.0) cpus = std::min(cpus, static_cast<size_t>(std::max(1.0, std::ceil(quota / period))));
+    return cpus;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t worker_count) {
+    for (size_t i = 0; i < worker_count; ++i) workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool([] {
+        size_t threads = available_cpus();
+        if (const char* configured = std::getenv("STATS_THREADS")) threads = std::strtoul(configured, nullptr, 10);
+        return threads > 1 ? threads - 1 : size_t(0);
+    }());
+    return pool;
+}
+
+void ThreadPool::work() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return; // Stopping
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::run(size_t tasks, const std::function<void(size_t)>& fn) {
+    if (tasks == 0) return;
+    // Shared with the queued helpers, which may only get to run after every index is done
+    struct Job {
+        std::atomic<size_t> next{0};
+        size_t finished = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto job = std::make_shared<Job>();
+    size_t total = tasks;
+    const std::function<void(size_t)>* body = &fn;
+    auto drain = [job, total, body] {
+        size_t completed = 0;
+        for (size_t i; (i = job->next.fetch_add(1)) < total;) {
+            (*body)(i);
+            ++completed;
+        }
+        if (completed == 0) return; // 'body' may already be gone
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->finished += completed;
+        if (job->finished == total) job->done.notify_all();
+    };
+
+    size_t helpers = std::min(workers.size(), tasks - 1);
+    if (helpers > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < helpers; ++i) queue.push_back(drain);
+        }
+        if (helpers == 1) available.notify_one();
+        else available.notify_all();
+    }
+    drain();
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->done.wait(lock, [&] { return job->finished == total; });
+}
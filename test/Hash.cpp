@@ -1,4 +1,5 @@
 #include "essential/HashTable.h" // Corrected include path
+#include "extra/CuckooHashTable.h"
 #include <cassert>
 #include <iostream>
 #include <string>
@@ -110,11 +111,43 @@ void testCollisions() {
     std::cout << "--- Test: HashTable Collisions PASSED ---\n\n";
 }
 
+void testFindMany() {
+    std::cout << "--- Test: Batched findMany (HashTable, CuckooHashTable) ---\n";
+    const int N = 500;
+    HashTable ht(101);
+    CuckooHashTable cuckoo(101);
+    std::vector<Data*> records;
+    for (int i = 0; i < N; ++i) {
+        records.push_back(new Data(i * 3 + 1, (float)i, (float)i, (float)i, (float)i, (float)i, (float)i, (float)i, (float)i, (float)i, (float)i, (float)i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, false, false, false, Protocolo::TCP, State::FIN, Attack_cat::NORMAL, Servico::HTTP));
+        ht.insert(records.back());
+        cuckoo.insert(records.back());
+    }
+
+    // Hits, misses and duplicates, more than one prefetch group
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 3 * N; i += 2) ids.push_back(i);
+    ids.push_back(4);
+    std::vector<const Data*> from_ht(ids.size()), from_cuckoo(ids.size());
+    ht.findMany(ids.data(), ids.size(), from_ht.data());
+    cuckoo.findMany(ids.data(), ids.size(), from_cuckoo.data());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        assert(from_ht[i] == ht.find(ids[i]));
+        assert(from_cuckoo[i] == cuckoo.search(ids[i]));
+        assert(from_ht[i] == nullptr || from_ht[i]->id == ids[i]);
+    }
+    std::cout << "findMany matches find for " << ids.size() << " ids.\n";
+
+    ht.clear();
+    for (Data* d : records) delete d;
+    std::cout << "--- Test: Batched findMany PASSED ---\n\n";
+}
+
 int main() {
     std::cout << "Running HashTable tests...\n\n";
     testBasic();
     testManyElements();
     testCollisions();
+    testFindMany();
     std::cout << "All HashTable tests passed!\n";
     return 0;
 }
@@ -69,6 +69,15 @@ int main() {
     assert(not_found_data == nullptr);
     std::cout << "Did not find element with non-existent ID 99. OK." << std::endl;
 
+    // Batched lookup must agree with find, including misses
+    std::vector<uint32_t> keys = {5, 99, 1, 15, 0, 8, 8, 12, 16, 3, 7, 2, 14, 9, 11, 6, 13, 4, 10};
+    std::vector<const Data*> found_many(keys.size());
+    rb_tree.findMany(keys.data(), keys.size(), found_many.data());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        assert(found_many[i] == rb_tree.find(keys[i]));
+    }
+    std::cout << "findMany agrees with find for " << keys.size() << " keys. OK." << std::endl;
+
     // --- 5. Removal Test ---
     std::cout << "\n[Step 5] Removing elements..." << std::endl;
     // Remove an existing element (e.g., ID 7)
@@ -1,6 +1,7 @@
 #include "essential/AVL.h"
 #include <iostream>
 #include <vector>
+#include <cassert>
 
 std::vector<Data> create_sample_data_for_testing() {
     std::vector<Data> samples;
@@ -224,6 +225,17 @@ int main(){
     }
 
 
+    // Batched lookup of existing and missing ids
+    uint32_t ids[] = {1001, 1002, 4242};
+    const Data* found[3];
+    tree->findMany(ids, 3, found);
+    for (int i = 0; i < 3; ++i) {
+        const AVL::Node_AVL* expected = tree->queryById(ids[i]);
+        assert(found[i] == (expected ? expected->data : nullptr));
+    }
+    assert(found[0] && found[0]->id == 1001 && found[2] == nullptr);
+    std::cout << "findMany agrees with queryById." << std::endl;
+
     tree->removeById(1002);
     tree->printAsciiTree();
 
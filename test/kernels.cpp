@@ -0,0 +1,102 @@
+#include "kernels.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+bool close(double a, double b, double relative) {
+    return std::abs(a - b) <= relative * std::max(1.0, std::max(std::abs(a), std::abs(b)));
+}
+
+void assert_same(const Reduction& a, const Reduction& b) {
+    assert(a.count == b.count);
+    assert(a.min == b.min && a.max == b.max);
+    assert(close(a.sum, b.sum, 1e-9) && close(a.sum_squares, b.sum_squares, 1e-9));
+}
+
+void testEveryLevelMatchesScalar() {
+    std::cout << "--- Test: vector kernels agree with the scalar ones ---\n";
+    std::cout << "Detected " << simd_level_name(detected_simd_level()) << ".\n";
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> uniform(-1000.0f, 1000.0f);
+
+    std::vector<Data> records(1001);
+    std::vector<float> dur_column;
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].dur = uniform(rng);
+        records[i].spkts = static_cast<uint16_t>(rng());
+        records[i].sbytes = static_cast<uint32_t>(rng()); // Often above 2^31
+        records[i].sttl = static_cast<uint8_t>(rng());
+        dur_column.push_back(records[i].dur);
+    }
+
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+        for (size_t n : {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 100, 1001}) {
+            std::vector<float> values(n);
+            for (float& v : values) v = uniform(rng);
+            values.resize(n);
+
+            set_simd_level(SimdLevel::SCALAR);
+            Reduction expected = reduce(values.data(), n, 3.0f);
+            size_t expected_count = count_in_range(values.data(), n, -100.0f, 250.0f);
+            std::vector<uint64_t> expected_bins(13, 0);
+            histogram(values.data(), n, -500.0f, 500.0f, expected_bins.data(), expected_bins.size());
+            Reduction expected_fields[4] = {
+                reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, dur), FieldType::FLOAT, 1.0f),
+                reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, spkts), FieldType::UINT16),
+                reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, sbytes), FieldType::UINT32),
+                reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, sttl), FieldType::UINT8),
+            };
+
+            set_simd_level(level);
+            assert_same(reduce(values.data(), n, 3.0f), expected);
+            assert(count_in_range(values.data(), n, -100.0f, 250.0f) == expected_count);
+            std::vector<uint64_t> bins(13, 0);
+            histogram(values.data(), n, -500.0f, 500.0f, bins.data(), bins.size());
+            assert(bins == expected_bins);
+            assert_same(reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, dur), FieldType::FLOAT, 1.0f), expected_fields[0]);
+            assert_same(reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, spkts), FieldType::UINT16), expected_fields[1]);
+            assert_same(reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, sbytes), FieldType::UINT32), expected_fields[2]);
+            assert_same(reduce_field(records.data(), std::min(n, records.size()), offsetof(Data, sttl), FieldType::UINT8), expected_fields[3]);
+        }
+    }
+
+    // The strided and the contiguous forms see the same values
+    set_simd_level(detected_simd_level());
+    assert_same(reduce_field(records.data(), records.size(), offsetof(Data, dur), FieldType::FLOAT), reduce(dur_column.data(), dur_column.size()));
+    std::cout << "--- Test: vector kernels agree with the scalar ones PASSED ---\n\n";
+}
+
+void testKernelResults() {
+    std::cout << "--- Test: kernel results ---\n";
+    std::vector<float> values = {5.0f, 1.0f, 9.0f, 3.0f, 7.0f, 2.0f, 8.0f, 4.0f, 6.0f, 10.0f};
+    Reduction r = reduce(values.data(), values.size());
+    assert(r.count == 10 && r.sum == 55.0 && r.sum_squares == 385.0 && r.min == 1.0f && r.max == 10.0f);
+    Reduction shifted = reduce(values.data(), values.size(), 5.5f);
+    assert(shifted.sum == 0.0 && shifted.sum_squares == 82.5);
+    assert(count_in_range(values.data(), values.size(), 3.0f, 6.0f) == 4);
+
+    // [0, 10] in 5 bins of width 2; 10 itself lands in the last one, -1 and 11 are skipped
+    values.push_back(-1.0f);
+    values.push_back(11.0f);
+    values.push_back(0.0f);
+    std::vector<uint64_t> bins(5, 0);
+    histogram(values.data(), values.size(), 0.0f, 10.0f, bins.data(), bins.size());
+    assert((bins == std::vector<uint64_t>{2, 2, 2, 2, 3}));
+    histogram(values.data(), values.size(), 3.0f, 3.0f, bins.data(), bins.size()); // Empty range: no-op
+    assert(bins[0] == 2);
+
+    Reduction empty = reduce(values.data(), 0);
+    assert(empty.count == 0 && empty.min == 0.0f && empty.max == 0.0f);
+    std::cout << "--- Test: kernel results PASSED ---\n\n";
+}
+
+int main() {
+    std::cout << "Running kernel tests...\n\n";
+    testEveryLevelMatchesScalar();
+    testKernelResults();
+    std::cout << "All kernel tests passed!\n";
+    return 0;
+}
@@ -1,6 +1,10 @@
 #include "essential/LinkedList.h"
 #include <iostream>
 #include <vector>
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <algorithm>
 
 std::vector<Data> create_sample_data_for_testing() {
     std::vector<Data> samples;
@@ -205,7 +209,111 @@ std::vector<Data> create_sample_data_for_testing() {
     return samples;
 }
 
+// Statistics over the last 'interval' items computed directly, for comparison with the windows
+struct Expected { double mean, stddev; float min, max; };
+Expected brute_force(const std::vector<const Data*>& order, StatisticFeature feature, size_t interval) {
+    size_t n = std::min(interval, order.size());
+    std::vector<double> values;
+    for (size_t i = order.size() - n; i < order.size(); ++i) {
+        switch (feature) {
+            case StatisticFeature::DUR: values.push_back(order[i]->dur); break;
+            case StatisticFeature::SBYTES: values.push_back(static_cast<float>(order[i]->sbytes)); break;
+            default: values.push_back(static_cast<float>(order[i]->spkts)); break;
+        }
+    }
+    Expected e{0, 0, 0, 0};
+    if (values.empty()) return e;
+    for (double v : values) e.mean += v;
+    e.mean /= values.size();
+    for (double v : values) e.stddev += (v - e.mean) * (v - e.mean);
+    e.stddev = std::sqrt(e.stddev / values.size());
+    e.min = static_cast<float>(*std::min_element(values.begin(), values.end()));
+    e.max = static_cast<float>(*std::max_element(values.begin(), values.end()));
+    return e;
+}
+
+void testSlidingWindows() {
+    std::cout << "--- Test: sliding window statistics ---" << std::endl;
+    std::mt19937 rng(5);
+    std::vector<Data> records(6000);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].id = static_cast<uint32_t>(i + 1);
+        records[i].dur = std::uniform_real_distribution<float>(0.0f, 100.0f)(rng);
+        records[i].sbytes = 1000000000u + rng() % 100000; // Large values with a small spread
+        records[i].spkts = static_cast<uint16_t>(rng() % 50);
+    }
+
+    DoublyLinkedList list;
+    list.trackWindow(100);
+    list.trackWindow(1000);
+    list.trackOrderStatistics();
+    std::vector<const Data*> order; // Mirror of the list, oldest first
+    size_t next = 0;
+    const StatisticFeature features[] = {StatisticFeature::DUR, StatisticFeature::SBYTES, StatisticFeature::SPKTS};
+
+    auto check = [&](int interval) {
+        for (StatisticFeature feature : features) {
+            Expected e = brute_force(order, feature, static_cast<size_t>(interval));
+            double tolerance = 1e-4 * std::max(1.0, std::fabs(e.mean));
+            assert(std::fabs(list.getAverage(feature, interval) - e.mean) <= tolerance);
+            assert(std::fabs(list.getStdDev(feature, interval) - e.stddev) <= 1e-3 * std::max(1.0, e.stddev));
+            assert(list.getMin(feature, interval) == e.min);
+            assert(list.getMax(feature, interval) == e.max);
+
+            // Tracked windows and the whole list read the summary from the running aggregates
+            // and order statistics, other intervals gather it; both match the brute force
+            StatsSummary summary = list.summarize(feature, interval);
+            assert(summary.count == std::min(static_cast<size_t>(interval), order.size()));
+            assert(std::fabs(summary.mean - e.mean) <= tolerance);
+            assert(std::fabs(summary.stddev() - e.stddev) <= 1e-3 * std::max(1.0, e.stddev));
+            assert(summary.min == e.min && summary.max == e.max);
+            assert(summary.median == list.getMedian(feature, interval));
+            assert(list.summarizeAll(interval)[static_cast<size_t>(feature)].median == summary.median);
+        }
+    };
+
+    for (int step = 0; step < 5000; ++step) {
+        int action = static_cast<int>(rng() % 10);
+        if (action < 6 || order.empty()) {
+            list.append(&records[next]);
+            order.push_back(&records[next]);
+            next = (next + 1) % records.size();
+            if (next == 0) break;
+        } else if (action < 8) {
+            // Eviction of the oldest item, as cleanup_old_data does
+            list.removeById(order.front()->id);
+            order.erase(order.begin());
+        } else {
+            // Removal from anywhere (REMOVE_DATA_BY_ID)
+            size_t victim = rng() % order.size();
+            list.removeById(order[victim]->id);
+            order.erase(order.begin() + victim);
+        }
+        if (step % 50 == 0) {
+            check(100);
+            check(1000);
+            check(static_cast<int>(order.size()) + 10); // Covers the whole list
+            check(37);                                  // Untracked: the collecting path
+
+            // The single-pass summary agrees with the individual statistics
+            StatsSummaryRow row = list.summarizeAll(250);
+            for (StatisticFeature feature : features) {
+                StatsSummary summary = list.summarize(feature, 250);
+                Expected e = brute_force(order, feature, 250);
+                assert(summary.count == std::min<size_t>(250, order.size()));
+                assert(std::fabs(summary.mean - e.mean) <= 1e-6 * std::max(1.0, std::fabs(e.mean)));
+                assert(summary.min == e.min && summary.max == e.max);
+                assert(summary.median == list.getMedian(feature, 250));
+                assert(row[static_cast<size_t>(feature)].median == summary.median);
+            }
+        }
+    }
+    std::cout << "--- Test: sliding window statistics PASSED ---" << std::endl;
+}
+
 int main(){
+    testSlidingWindows();
+
     std::vector<Data> test_data = create_sample_data_for_testing();
 
     DoublyLinkedList* list = new DoublyLinkedList();
@@ -215,6 +323,16 @@ int main(){
     }
 
     list->print();
+    // Batched lookup of existing and missing ids
+    uint32_t ids[] = {1003, 1001, 4242};
+    const Data* found[3];
+    list->findMany(ids, 3, found);
+    for (int i = 0; i < 3; ++i) {
+        assert(found[i] == list->findById(ids[i]));
+    }
+    assert(found[0] && found[0]->id == 1003 && found[2] == nullptr);
+    std::cout << "findMany agrees with findById." << std::endl;
+
     list->removeById(1003);
     list->print();
     delete list;
@@ -0,0 +1,134 @@
+#include "logger.h"
+#include <iostream>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads back everything written to 'file'
+std::string read_all(FILE* file) {
+    std::fflush(file);
+    std::rewind(file);
+    std::string content;
+    char chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file)) > 0) content.append(chunk, n);
+    return content;
+}
+
+std::vector<std::string> lines_of(const std::string& text) {
+    std::vector<std::string> lines;
+    size_t start = 0;
+    for (size_t end; (end = text.find('\n', start)) != std::string::npos; start = end + 1) {
+        lines.push_back(text.substr(start, end - start));
+    }
+    return lines;
+}
+
+void testTextSink() {
+    std::cout << "--- Test: Logger text sink ---\n";
+    FILE* out = std::tmpfile();
+    FILE* err = std::tmpfile();
+    {
+        Logger logger(64, out, err);
+        logger.setLevel(LogLevel::INFO);
+        { LogLine line(logger, LogLevel::INFO); line << "count=" << 42 << " ratio=" << 0.5 << " ok=" << true << " c=" << 'x'; }
+        { LogLine line(logger, LogLevel::ERROR); line << std::string("failed: ") << static_cast<uint8_t>(7); }
+        assert(!logger.enabled(LogLevel::DEBUG) && logger.enabled(LogLevel::WARN));
+        { LogLine line(logger, LogLevel::INFO); line << std::string(500, 'a'); } // Truncated
+        logger.flush();
+        assert(logger.written() == 3 && logger.dropped() == 0);
+    }
+
+    std::vector<std::string> out_lines = lines_of(read_all(out));
+    std::vector<std::string> err_lines = lines_of(read_all(err));
+    assert(out_lines.size() == 2 && err_lines.size() == 1);
+    // "YYYY-MM-DDTHH:MM:SS.uuuuuuZ LEVEL [tN] text"
+    assert(out_lines[0].size() > 28 && out_lines[0][10] == 'T' && out_lines[0][26] == 'Z');
+    assert(out_lines[0].find(" INFO  [t") == 27);
+    assert(out_lines[0].substr(out_lines[0].find("] ") + 2) == "count=42 ratio=0.5 ok=true c=x");
+    assert(err_lines[0].find(" ERROR [t") == 27);
+    assert(err_lines[0].substr(err_lines[0].find("] ") + 2) == "failed: 7");
+    std::string truncated = out_lines[1].substr(out_lines[1].find("] ") + 2);
+    assert(truncated == std::string(LOG_TEXT_CAPACITY, 'a') + "...");
+    std::fclose(out);
+    std::fclose(err);
+    std::cout << "--- Test: Logger text sink PASSED ---\n\n";
+}
+
+void testConcurrentProducers() {
+    std::cout << "--- Test: Logger concurrent producers ---\n";
+    FILE* out = std::tmpfile();
+    const int THREADS = 4, PER_THREAD = 20000;
+    uint64_t written = 0, dropped = 0;
+    {
+        // A small ring, so that producers outrun the flusher and some messages are dropped
+        Logger logger(256, out, out, LogSink::BINARY);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < THREADS; ++t) {
+            producers.emplace_back([&logger, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    LogLine line(logger, LogLevel::INFO);
+                    line << "p" << t << " m" << i;
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+        logger.stop();
+        written = logger.written();
+        dropped = logger.dropped();
+    }
+    assert(written + dropped == static_cast<uint64_t>(THREADS * PER_THREAD));
+    assert(written >= 256);
+
+    // Binary records: header fields then 'length' bytes of text, in commit order per producer
+    std::string data = read_all(out);
+    const size_t header = offsetof(LogRecord, text);
+    size_t pos = 0, records = 0;
+    std::vector<int> last_message(THREADS, -1);
+    while (pos + header <= data.size()) {
+        LogRecord record;
+        std::memcpy(&record, data.data() + pos, header);
+        assert(record.level == LogLevel::INFO && record.truncated == 0);
+        std::string text(data.data() + pos + header, record.length);
+        int t = -1, i = -1;
+        assert(std::sscanf(text.c_str(), "p%d m%d", &t, &i) == 2);
+        assert(t >= 0 && t < THREADS && i > last_message[t]);
+        last_message[t] = i;
+        pos += header + record.length;
+        ++records;
+    }
+    assert(pos == data.size() && records == written);
+    std::fclose(out);
+    std::cout << "--- Test: Logger concurrent producers PASSED ---\n\n";
+}
+
+void testLevels() {
+    std::cout << "--- Test: Logger levels ---\n";
+    LogLevel level;
+    assert(parse_log_level("warn", level) && level == LogLevel::WARN);
+    assert(parse_log_level("off", level) && level == LogLevel::OFF);
+    assert(!parse_log_level("verbose", level));
+    assert(std::string(log_level_name(LogLevel::DEBUG)) == "DEBUG");
+
+    // Compiled out below LOG_MIN_LEVEL: the arguments are never evaluated
+    int evaluated = 0;
+    auto count = [&evaluated]() { return ++evaluated; };
+    LOG_DEBUG("never " << count());
+    assert(evaluated == (LOG_MIN_LEVEL == 0 && Logger::instance().enabled(LogLevel::DEBUG) ? 1 : 0));
+    Logger::instance().setLevel(LogLevel::OFF);
+    LOG_ERROR("silenced " << count());
+    assert(evaluated <= 1);
+    std::cout << "--- Test: Logger levels PASSED ---\n\n";
+}
+
+int main() {
+    std::cout << "Running logger tests...\n\n";
+    testTextSink();
+    testConcurrentProducers();
+    testLevels();
+    std::cout << "All logger tests passed!\n";
+    return 0;
+}
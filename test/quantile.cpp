@@ -0,0 +1,247 @@
+#include "essential/QuantileSketch.h"
+#include "essential/OrderStatistics.h"
+#include "essential/Histogram.h"
+#include "essential/LinkedList.h"
+#include "extra/SegmentTree.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// The answer for q must have a rank within 'rank_error' of q among 'sorted'
+void assert_rank_within(const std::vector<float>& sorted, double q, float answer, double rank_error) {
+    double n = static_cast<double>(sorted.size());
+    double below = std::lower_bound(sorted.begin(), sorted.end(), answer) - sorted.begin();
+    double up_to = std::upper_bound(sorted.begin(), sorted.end(), answer) - sorted.begin();
+    assert(below / n <= q + rank_error);
+    assert(up_to / n >= q - rank_error);
+}
+
+void testSketchAccuracy() {
+    std::cout << "--- Test: KLL sketch accuracy and merge ---\n";
+    std::mt19937 rng(5);
+    std::lognormal_distribution<float> skewed(3.0f, 1.5f);
+    QuantileSketch sketch(QuantileSketch::kForRankError(0.01));
+    assert(sketch.rankError() <= 0.01);
+    QuantileSketch parts[4] = {QuantileSketch(sketch.getK()), QuantileSketch(sketch.getK()),
+                               QuantileSketch(sketch.getK()), QuantileSketch(sketch.getK())};
+    std::vector<float> values;
+    for (int i = 0; i < 200000; ++i) {
+        float v = skewed(rng);
+        values.push_back(v);
+        sketch.add(v);
+        parts[i % 4].add(v);
+    }
+    QuantileSketch merged(sketch.getK());
+    for (const QuantileSketch& part : parts) merged.merge(part);
+
+    std::vector<float> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<double> qs = {0.0, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0};
+    std::vector<float> single = sketch.quantiles(qs);
+    std::vector<float> combined = merged.quantiles(qs);
+    for (size_t i = 0; i < qs.size(); ++i) {
+        assert_rank_within(sorted, qs[i], single[i], sketch.rankError());
+        assert_rank_within(sorted, qs[i], combined[i], merged.rankError());
+    }
+    assert(single.front() == sorted.front() && single.back() == sorted.back());
+    assert(sketch.count() == values.size() && merged.count() == values.size());
+    assert(sketch.retained() < 3 * static_cast<size_t>(sketch.getK()) + 64); // Bounded, far below the 200000 values
+    std::cout << "Retained " << sketch.retained() << " of " << values.size() << " values.\n";
+
+    // Exact quantiles interpolate between ranks, so q = 0.5 is the usual median
+    std::vector<float> few = {4.0f, 1.0f, 3.0f, 2.0f};
+    std::vector<float> exact = exact_quantiles(few, {0.0, 0.5, 1.0, 0.25});
+    assert(exact[0] == 1.0f && exact[1] == 2.5f && exact[2] == 4.0f && exact[3] == 1.75f);
+    std::cout << "--- Test: KLL sketch accuracy and merge PASSED ---\n\n";
+}
+
+void testStructureQuantiles() {
+    std::cout << "--- Test: bucketed quantiles in DoublyLinkedList and SegmentTree ---\n";
+    std::mt19937 rng(9);
+    DoublyLinkedList list;
+    SegmentTree tree;
+    list.trackQuantiles(0.01);
+    tree.trackQuantiles(0.01);
+    std::vector<std::unique_ptr<Data>> owned;
+    std::vector<const Data*> live;
+    for (uint32_t i = 0; i < 30000; ++i) {
+        auto d = std::make_unique<Data>();
+        d->id = i + 1;
+        d->rate = std::exponential_distribution<float>(0.01f)(rng);
+        d->sbytes = rng() % 1000000;
+        list.append(d.get());
+        tree.insert(d.get());
+        live.push_back(d.get());
+        owned.push_back(std::move(d));
+        // Evict the oldest now and then, and remove from the middle, leaving stale buckets behind
+        if (i % 10 == 9) {
+            size_t victim = (i % 20 == 19) ? 0 : rng() % live.size();
+            assert(list.removeById(live[victim]->id) && tree.remove(live[victim]->id));
+            live.erase(live.begin() + victim);
+        }
+    }
+
+    std::vector<double> qs = {0.5, 0.9, 0.99};
+    for (int interval : {1000, 5000, 12345, 100000}) {
+        size_t n = std::min<size_t>(interval, live.size());
+        std::vector<float> sorted;
+        for (size_t i = live.size() - n; i < live.size(); ++i) sorted.push_back(live[i]->rate);
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<float> from_list = list.getQuantiles(StatisticFeature::RATE, interval, qs);
+        std::vector<float> from_tree = tree.getQuantiles(StatisticFeature::RATE, interval, qs);
+        bool exact = n <= QUANTILE_EXACT_LIMIT;
+        assert(list.quantilesExact(interval) == exact && tree.quantilesExact(interval) == exact);
+        for (size_t i = 0; i < qs.size(); ++i) {
+            assert_rank_within(sorted, qs[i], from_list[i], exact ? 1.0 / n : 0.01);
+            assert_rank_within(sorted, qs[i], from_tree[i], exact ? 1.0 / n : 0.01);
+        }
+        // Exact mode on request, whatever the interval
+        std::vector<float> forced = list.getQuantiles(StatisticFeature::RATE, interval, {0.5}, true);
+        assert(forced[0] == tree.getQuantiles(StatisticFeature::RATE, interval, {0.5}, true)[0]);
+        assert(forced[0] == exact_quantiles(sorted, {0.5})[0]);
+    }
+
+    // Removing everything empties the buckets; new records start new ones
+    for (const Data* d : live) assert(list.removeById(d->id) && tree.remove(d->id));
+    assert(list.getQuantiles(StatisticFeature::RATE, 100000, {0.5})[0] == 0.0f);
+    list.append(owned[0].get());
+    tree.insert(owned[0].get());
+    assert(list.getMedian(StatisticFeature::RATE, 10) == owned[0]->rate);
+    assert(tree.getMedian(StatisticFeature::RATE, 10) == owned[0]->rate);
+    std::cout << "--- Test: bucketed quantiles PASSED ---\n\n";
+}
+
+void testOrderStatistics() {
+    std::cout << "--- Test: order-statistic list and exact whole-window quantiles ---\n";
+    std::mt19937 rng(21);
+    OrderStatisticList list;
+    std::vector<std::pair<float, uint64_t>> entries;
+    for (uint64_t seq = 0; seq < 20000; ++seq) {
+        // Few distinct values, so that equal values are told apart by seq
+        float value = static_cast<float>(rng() % 500);
+        list.insert(value, seq);
+        entries.emplace_back(value, seq);
+        if (seq % 3 == 2) {
+            size_t victim = rng() % entries.size();
+            assert(list.erase(entries[victim].first, entries[victim].second));
+            entries.erase(entries.begin() + victim);
+        }
+    }
+    assert(!list.erase(1000.0f, 0)); // Never inserted
+    assert(list.size() == entries.size());
+    std::vector<float> sorted;
+    for (const auto& entry : entries) sorted.push_back(entry.first);
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t k = 0; k < sorted.size(); k += 97) assert(list.kth(k) == sorted[k]);
+    assert(list.kth(sorted.size() - 1) == sorted.back());
+    for (double q : {0.0, 0.1, 0.5, 0.75, 0.999, 1.0}) {
+        std::vector<float> scratch = sorted; // exact_quantiles reorders its input
+        assert(list.quantile(q) == exact_quantiles(scratch, {q})[0]);
+    }
+
+    OrderStatisticList moved(std::move(list));
+    assert(moved.size() == sorted.size() && moved.kth(0) == sorted.front());
+    moved.clear();
+    assert(moved.empty() && moved.quantile(0.5) == 0.0f);
+
+    // With order statistics, the median over the whole structure is exact at any size
+    DoublyLinkedList dll;
+    SegmentTree tree;
+    dll.trackQuantiles(0.01);
+    tree.trackQuantiles(0.01);
+    std::vector<std::unique_ptr<Data>> owned;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        auto d = std::make_unique<Data>();
+        d->id = i + 1;
+        d->dur = std::exponential_distribution<float>(1.0f)(rng);
+        dll.append(d.get());
+        tree.insert(d.get());
+        owned.push_back(std::move(d));
+    }
+    dll.trackOrderStatistics();
+    tree.trackOrderStatistics();
+    for (uint32_t id = 1; id <= 10000; id += 7) assert(dll.removeById(id) && tree.remove(id));
+    std::vector<float> durations;
+    for (const auto& d : owned)
+        if ((d->id - 1) % 7 != 0) durations.push_back(d->dur);
+    int whole = static_cast<int>(durations.size());
+    assert(dll.quantilesExact(whole) && tree.quantilesExact(whole + 5));
+    std::vector<float> expected = exact_quantiles(durations, {0.5, 0.99});
+    assert(dll.getMedian(StatisticFeature::DUR, whole) == expected[0]);
+    assert(tree.getMedian(StatisticFeature::DUR, whole + 5) == expected[0]);
+    assert(dll.getQuantiles(StatisticFeature::DUR, whole, {0.5, 0.99}) == expected);
+    assert(!dll.quantilesExact(whole - 1)); // Shorter intervals still come from the sketches
+    std::cout << "--- Test: order-statistic list PASSED ---\n\n";
+}
+
+void testHistograms() {
+    std::cout << "--- Test: log-scale histograms maintained over the window ---\n";
+    // Every value lands in a bucket that contains it, within 1/8 of its value
+    std::mt19937 rng(33);
+    std::lognormal_distribution<float> skewed(2.0f, 4.0f);
+    for (int i = 0; i < 100000; ++i) {
+        float v = skewed(rng);
+        size_t b = LogHistogram::bucketOf(v);
+        assert(LogHistogram::bucketLow(b) <= v && v < LogHistogram::bucketHigh(b));
+        if (b > 0 && b + 1 < LogHistogram::BUCKET_COUNT)
+            assert(LogHistogram::bucketHigh(b) - LogHistogram::bucketLow(b) <= LogHistogram::bucketLow(b) / 8);
+    }
+    assert(LogHistogram::bucketOf(0.0f) == 0 && LogHistogram::bucketOf(-3.0f) == 0);
+    assert(LogHistogram::bucketOf(1e30f) == LogHistogram::BUCKET_COUNT - 1);
+
+    DoublyLinkedList list;
+    SegmentTree tree;
+    list.trackHistograms();
+    std::vector<std::unique_ptr<Data>> owned;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        auto d = std::make_unique<Data>();
+        d->id = i + 1;
+        d->sbytes = static_cast<uint32_t>(skewed(rng));
+        list.append(d.get());
+        tree.insert(d.get());
+        owned.push_back(std::move(d));
+    }
+    tree.trackHistograms(); // Built from the records already in the tree
+    for (uint32_t id = 1; id <= 2000; ++id) assert(list.removeById(id) && tree.remove(id));
+
+    // The maintained histograms match the ones counted from the remaining values
+    std::vector<float> values;
+    for (size_t i = 2000; i < owned.size(); ++i) values.push_back(static_cast<float>(owned[i]->sbytes));
+    std::vector<HistogramBin> expected = log_histogram(values.data(), values.size(), 20);
+    assert(list.histogramMaintained(3000, HistogramScale::LOG) && tree.histogramMaintained(3000, HistogramScale::LOG));
+    for (const auto& bins : {list.getHistogram(StatisticFeature::SBYTES, 3000, HistogramScale::LOG, 20),
+                             tree.getHistogram(StatisticFeature::SBYTES, 3000, HistogramScale::LOG, 20)}) {
+        assert(bins.size() == expected.size() && bins.size() <= 20);
+        uint64_t total = 0;
+        for (size_t b = 0; b < bins.size(); ++b) {
+            assert(bins[b].count == expected[b].count && bins[b].low == expected[b].low);
+            total += bins[b].count;
+        }
+        assert(total == 3000);
+    }
+
+    // Linear bins and shorter intervals are counted from the values
+    assert(!list.histogramMaintained(100, HistogramScale::LOG) && !list.histogramMaintained(3000, HistogramScale::LINEAR));
+    std::vector<HistogramBin> linear = tree.getHistogram(StatisticFeature::SBYTES, 100, HistogramScale::LINEAR, 10);
+    assert(linear.size() == 10);
+    uint64_t total = 0;
+    for (const HistogramBin& bin : linear) total += bin.count;
+    assert(total == 100 && linear.front().low <= linear.back().high);
+    std::vector<float> same(7, 4.0f);
+    std::vector<HistogramBin> single = linear_histogram(same.data(), same.size(), 5);
+    assert(single.size() == 1 && single[0].count == 7 && single[0].low == 4.0);
+    std::cout << "--- Test: log-scale histograms PASSED ---\n\n";
+}
+
+int main() {
+    std::cout << "Running quantile sketch tests...\n\n";
+    testSketchAccuracy();
+    testStructureQuantiles();
+    testOrderStatistics();
+    testHistograms();
+    std::cout << "All quantile sketch tests passed!\n";
+    return 0;
+}
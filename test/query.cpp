@@ -0,0 +1,682 @@
+#include "query/QueryCursor.h"
+#include "query/SortedIndex.h"
+#include "query/Bitmap.h"
+#include "query/CategoricalIndex.h"
+#include "query/RecordStore.h"
+#include "query/QueryPlanner.h"
+#include "query/RangePredicate.h"
+#include "query/ResultCache.h"
+#include "query/Subscription.h"
+#include "query/CompiledFilter.h"
+#include "query/AnomalyScorer.h"
+#include "query/ColumnStore.h"
+#include "stats_summary.h"
+#include "data.h"
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <set>
+#include <random>
+#include <map>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
+#include <limits>
+
+// Helper to build a record with only the fields the query tests care about
+Data make_query_record(uint32_t id, float dur, float rate, uint32_t sbytes, uint32_t dbytes,
+                       bool label, Protocolo proto) {
+    return Data(
+        id, dur, rate, 1500.0f, 800.0f, 0.15f, 0.08f, 5.0f, 3.0f, 0.05f, 0.02f, 0.03f,
+        15, 12, sbytes, dbytes, 64, 128, 0, 0, 65535, 100000, 200000, 32768, 500, 400, 1, 1200,
+        5, 10, 3, 4, 8, 0, 1, 20, 6, false, false, label, proto, State::FIN,
+        label ? Attack_cat::DOS : Attack_cat::NORMAL, Servico::HTTP
+    );
+}
+
+std::vector<std::unique_ptr<Data>> create_query_records(size_t n) {
+    std::vector<std::unique_ptr<Data>> records;
+    for (size_t i = 0; i < n; ++i) {
+        // Scrambled values so that sorting actually reorders the records
+        uint32_t scrambled = static_cast<uint32_t>((i * 7919) % n);
+        records.push_back(std::make_unique<Data>(make_query_record(
+            static_cast<uint32_t>(1000 + i), 0.1f * scrambled, 2.0f * (n - i), scrambled * 100, static_cast<uint32_t>(i),
+            i % 3 == 0, i % 2 == 0 ? Protocolo::TCP : Protocolo::UDP)));
+    }
+    return records;
+}
+
+void testPartialOrderAndCursors() {
+    std::cout << "--- Test: PartialOrder and CursorManager ---\n";
+    auto records = create_query_records(100);
+    std::vector<const Data*> rows;
+    for (const auto& r : records) rows.push_back(r.get());
+
+    auto by_sbytes_desc = [](const Data* a, const Data* b) { return a->sbytes > b->sbytes; };
+    PartialOrder order(rows, by_sbytes_desc);
+    assert(order.total() == 100);
+
+    std::vector<const Data*> page;
+    assert(order.next(10, page) == 10);
+    assert(order.remaining() == 90);
+    for (size_t i = 1; i < page.size(); ++i) assert(page[i - 1]->sbytes >= page[i]->sbytes);
+
+    CursorManager cursors(2);
+    uint32_t id = cursors.open(std::move(order), page.size());
+    size_t first_row = 0, remaining = 0;
+    uint32_t last_sbytes = page.back()->sbytes;
+    page.clear();
+    assert(cursors.fetch(id, 50, page, first_row, remaining));
+    assert(first_row == 11 && page.size() == 50 && remaining == 40);
+    assert(page.front()->sbytes <= last_sbytes);
+    for (size_t i = 1; i < page.size(); ++i) assert(page[i - 1]->sbytes >= page[i]->sbytes);
+
+    // Exhausting the cursor closes it
+    page.clear();
+    assert(cursors.fetch(id, 100, page, first_row, remaining));
+    assert(page.size() == 40 && remaining == 0);
+    assert(!cursors.fetch(id, 1, page, first_row, remaining));
+
+    // The LRU cursor is dropped once the limit is reached
+    uint32_t a = cursors.open(PartialOrder(rows, by_sbytes_desc), 0);
+    uint32_t b = cursors.open(PartialOrder(rows, by_sbytes_desc), 0);
+    uint32_t c = cursors.open(PartialOrder(rows, by_sbytes_desc), 0);
+    assert(cursors.size() == 2);
+    assert(!cursors.close(a) && cursors.close(b) && cursors.close(c));
+
+    // Presorted rows are handed out in their given order
+    PartialOrder presorted = PartialOrder::presorted(rows);
+    page.clear();
+    assert(presorted.next(3, page) == 3 && page[2] == rows[2] && presorted.remaining() == 97);
+
+    cursors.open(PartialOrder(rows, by_sbytes_desc), 0);
+    cursors.invalidateAll();
+    assert(cursors.size() == 0);
+    std::cout << "--- Test: PartialOrder and CursorManager PASSED ---\n\n";
+}
+
+void testSortedIndexes() {
+    std::cout << "--- Test: SortedIndexes ---\n";
+    auto records = create_query_records(200);
+    SortedIndexes indexes;
+    for (size_t i = 0; i < records.size(); ++i) indexes.insert(records[i].get(), static_cast<uint32_t>(i));
+    assert(indexes.size() == 200);
+
+    // Index walks must match a full sort with the resolved comparator
+    for (SortField field : {SortField::ID, SortField::DUR, SortField::RATE, SortField::SBYTES, SortField::DBYTES}) {
+        for (bool ascending : {true, false}) {
+            std::vector<const Data*> walked;
+            indexes.walk(field, ascending, [&](const Data* d) { walked.push_back(d); return true; });
+            assert(walked.size() == 200);
+            auto less = make_sort_comparator(field, ascending);
+            for (size_t i = 1; i < walked.size(); ++i) assert(!less(walked[i], walked[i - 1]));
+        }
+    }
+
+    // Top-N walk stops early
+    std::vector<const Data*> top;
+    indexes.walk(SortField::SBYTES, false, [&](const Data* d) { top.push_back(d); return top.size() < 5; });
+    assert(top.size() == 5 && top.front()->sbytes == 199 * 100);
+
+    // Evicting the oldest half keeps the indexes consistent
+    for (size_t i = 0; i < 100; ++i) indexes.remove(records[i].get());
+    assert(indexes.size() == 100);
+    indexes.walk(SortField::DUR, true, [&](const Data* d) { assert(d->id >= 1100); return true; });
+
+    // Non-indexed fields sort through the same typed comparators
+    auto by_ttl = make_field_comparator(*find_numeric_field("sttl"), false);
+    Data low, high;
+    low.sttl = 3;
+    high.sttl = 200;
+    assert(by_ttl(&high, &low) && !by_ttl(&low, &high));
+
+    assert(parse_sort_field("sbytes") == SortField::SBYTES);
+    assert(parse_sort_field("unknown") == SortField::ID);
+    std::cout << "--- Test: SortedIndexes PASSED ---\n\n";
+}
+
+std::vector<uint32_t> to_vector(const Bitmap& bitmap) {
+    std::vector<uint32_t> values;
+    bitmap.forEach([&](uint32_t v) { values.push_back(v); });
+    return values;
+}
+
+void testBitmap() {
+    std::cout << "--- Test: Bitmap ---\n";
+    std::mt19937 rng(42);
+    // Mix of a dense container (key 0), a sparse one (key 1) and one only present in 'a' (key 3)
+    std::set<uint32_t> set_a, set_b;
+    Bitmap a, b;
+    for (int i = 0; i < 20000; ++i) { uint32_t v = rng() % 65536; set_a.insert(v); a.add(v); }
+    for (int i = 0; i < 30000; ++i) { uint32_t v = rng() % 65536; set_b.insert(v); b.add(v); }
+    for (int i = 0; i < 500; ++i) { uint32_t v = 65536 + rng() % 65536; set_a.insert(v); a.add(v); }
+    for (int i = 0; i < 700; ++i) { uint32_t v = 65536 + rng() % 65536; set_b.insert(v); b.add(v); }
+    for (int i = 0; i < 100; ++i) { uint32_t v = 3 * 65536 + i; set_a.insert(v); a.add(v); }
+    assert(a.cardinality() == set_a.size() && b.cardinality() == set_b.size());
+
+    std::vector<uint32_t> expected;
+    std::set_intersection(set_a.begin(), set_a.end(), set_b.begin(), set_b.end(), std::back_inserter(expected));
+    assert(to_vector(a.intersect(b)) == expected);
+    expected.clear();
+    std::set_union(set_a.begin(), set_a.end(), set_b.begin(), set_b.end(), std::back_inserter(expected));
+    assert(to_vector(a.unite(b)) == expected);
+    expected.clear();
+    std::set_difference(set_a.begin(), set_a.end(), set_b.begin(), set_b.end(), std::back_inserter(expected));
+    assert(to_vector(a.subtract(b)) == expected);
+
+    // Removing values and evicting a prefix
+    uint32_t some = *set_a.begin();
+    assert(a.contains(some) && a.remove(some) && !a.contains(some));
+    set_a.erase(some);
+    a.removeBelow(40000);
+    set_a.erase(set_a.begin(), set_a.lower_bound(40000));
+    assert(to_vector(a) == std::vector<uint32_t>(set_a.begin(), set_a.end()));
+
+    Bitmap r = Bitmap::range(65000, 70000);
+    assert(r.cardinality() == 5000 && r.contains(65000) && r.contains(69999) && !r.contains(70000));
+    std::cout << "--- Test: Bitmap PASSED ---\n\n";
+}
+
+void testCategoricalIndexes() {
+    std::cout << "--- Test: CategoricalIndexes and RecordStore ---\n";
+    auto records = create_query_records(300);
+    RecordStore store;
+    CategoricalIndexes indexes;
+    for (const auto& r : records) {
+        uint32_t slot = store.append(*r);
+        indexes.insert(store.at(slot), slot);
+    }
+    assert(store.size() == 300 && store.firstSlot() == 0 && store.endSlot() == 300);
+
+    std::map<std::string, std::string> params = {{"label", "true"}, {"proto!", "0"}, {"sort_by", "dur"}};
+    std::vector<CategoricalPredicate> predicates;
+    std::string error;
+    assert(parse_categorical_predicates(params, predicates, error));
+    assert(predicates.size() == 2);
+
+    auto matches_of = [&](const std::vector<CategoricalPredicate>& preds) {
+        Bitmap bitmap = indexes.evaluate(preds, store.firstSlot(), store.endSlot());
+        std::vector<uint32_t> slots = to_vector(bitmap);
+        for (uint32_t slot : slots) assert(store.at(slot) != nullptr);
+        return slots;
+    };
+
+    // label=true is every third record, proto!=TCP keeps the odd ones
+    std::vector<uint32_t> slots = matches_of(predicates);
+    for (uint32_t slot : slots) assert(slot % 3 == 0 && slot % 2 == 1);
+    assert(slots.size() == 50);
+
+    // Evicting the oldest records keeps only live slots in the bitmaps
+    store.evictOldest(100);
+    indexes.evictBelow(store.firstSlot());
+    slots = matches_of(predicates);
+    assert(slots.size() == 33 && slots.front() >= 100);
+    assert(store.at(50) == nullptr && store.at(150)->id == 1150);
+
+    // Only negated predicates start from the live slot range
+    predicates.clear();
+    params = {{"proto!", "0,1"}};
+    assert(parse_categorical_predicates(params, predicates, error));
+    assert(matches_of(predicates).empty());
+
+    predicates.clear();
+    params = {{"service", "abc"}};
+    assert(!parse_categorical_predicates(params, predicates, error));
+    std::cout << "--- Test: CategoricalIndexes and RecordStore PASSED ---\n\n";
+}
+
+void testQueryPlanner() {
+    std::cout << "--- Test: QueryPlanner ---\n";
+    RecordStore store;
+    CategoricalIndexes categorical;
+    SortedIndexes sorted;
+    for (uint32_t i = 0; i < 3000; ++i) {
+        // label=false for 90% of the records, ICMP for 1%
+        Data d = make_query_record(5000 + i, 0.01f * ((i * 37) % 3000), 1.0f, (i * 7919) % 3000, i,
+                                   i % 10 == 0, i % 100 == 0 ? Protocolo::ICMP : Protocolo::TCP);
+        uint32_t slot = store.append(d);
+        categorical.insert(store.at(slot), slot);
+        sorted.insert(store.at(slot), slot);
+    }
+    QueryPlanner planner(store, categorical, sorted);
+
+    auto run = [&](std::map<std::string, std::string> params, AccessPath expected_path) {
+        QueryRequest request;
+        std::string error;
+        assert(parse_query_request(params, request, error));
+        QueryPlan plan = planner.plan(request);
+        assert(plan.path == expected_path);
+        QueryExecution execution;
+        PartialOrder order = planner.execute(plan, execution);
+
+        // Brute force reference
+        std::vector<const Data*> expected;
+        for (size_t i = 0; i < store.size(); ++i) {
+            bool ok = true;
+            for (const auto& p : request.predicates) ok = ok && predicate_matches(store[i], p);
+            for (const auto& r : request.ranges) ok = ok && range_matches(store[i], r);
+            if (ok) expected.push_back(store[i]);
+        }
+        auto less = make_sort_comparator(request.sort_field, request.ascending);
+        std::stable_sort(expected.begin(), expected.end(), less);
+        assert(execution.total_matches == expected.size());
+
+        std::vector<const Data*> page;
+        order.next(request.page_size, page);
+        assert(page.size() == std::min(request.page_size, expected.size()));
+        for (size_t i = 0; i < page.size(); ++i) assert(!less(page[i], expected[i]) && !less(expected[i], page[i]));
+        assert(!planner.explain(plan, execution).empty());
+    };
+
+    // label=false matches 90%: walking the sbytes index finds a page almost immediately
+    run({{"label", "false"}, {"sort_by", "sbytes"}, {"sort_order", "desc"}}, AccessPath::ORDERED_SCAN);
+    // proto=ICMP matches 1%: intersecting bitmaps and ordering 30 rows is cheaper
+    run({{"proto", "4"}, {"sort_by", "dur"}}, AccessPath::INDEX_INTERSECT);
+    run({{"proto", "4"}, {"label", "true"}, {"limit", "5"}}, AccessPath::INDEX_INTERSECT);
+    run({{"sort_by", "rate"}}, AccessPath::INDEX_WALK);
+    // Range filters never take the plain index walk; they are intersected with the categorical bitmaps
+    run({{"sbytes>=", "2990"}, {"sort_by", "dur"}}, AccessPath::INDEX_INTERSECT);
+    run({{"label", "true"}, {"sbytes<", "100"}, {"sttl", "64"}}, AccessPath::INDEX_INTERSECT);
+    run({{"label", "false"}, {"dur>", "1"}, {"sort_by", "sbytes"}}, AccessPath::ORDERED_SCAN);
+
+    // The driving predicate is the most selective one, whatever the order in the request
+    QueryRequest request;
+    std::string error;
+    assert(parse_query_request({{"label", "false"}, {"proto", "4"}}, request, error));
+    QueryPlan plan = planner.plan(request);
+    assert(plan.predicates.front().predicate.field == CategoricalField::PROTO);
+    assert(plan.predicates.front().estimated_rows == 30);
+
+    // Unindexed ranges are estimated from a sample; every record has sttl=64 and dur < 30
+    for (const auto& estimate : std::vector<std::pair<std::map<std::string, std::string>, double>>{
+             {{{"sttl", "64"}}, 1.0}, {{{"sttl>", "64"}}, 0.0}, {{{"sttl<", "64"}}, 0.0}, {{{"dur", "0..30"}, {"sttl>=", "64"}}, 1.0}}) {
+        QueryRequest range_request;
+        assert(parse_query_request(estimate.first, range_request, error));
+        QueryPlan range_plan = planner.plan(range_request);
+        for (const RangeEstimate& range : range_plan.ranges)
+            if (!range.indexed) assert(range.selectivity == estimate.second && range.rows_examined > 0);
+    }
+
+    assert(!parse_query_request({{"limit", "abc"}}, request, error));
+    std::cout << "--- Test: QueryPlanner PASSED ---\n\n";
+}
+
+void testRangePredicates() {
+    std::cout << "--- Test: RangePredicate ---\n";
+    std::vector<RangePredicate> ranges;
+    std::string error;
+
+    // Terms on the same field merge into one closed range; exclusive bounds move to the next value
+    assert(parse_range_predicates({{"sbytes>", "100"}, {"sbytes<=", "500"}, {"dur", "0.5..2"}, {"label", "true"}},
+                                  ranges, error));
+    assert(ranges.size() == 2);
+    for (const RangePredicate& r : ranges) {
+        if (std::string(r.field->name) == "sbytes") { assert(r.low > 100 && r.low < 101); assert(r.high == 500); }
+        else { assert(std::string(r.field->name) == "dur"); assert(r.low == 0.5 && r.high == 2.0); }
+    }
+    ranges.clear();
+    assert(!parse_range_predicates({{"sbytes>=", "abc"}}, ranges, error));
+    assert(!parse_range_predicates({{"dur!", "1"}}, ranges, error));
+
+    RecordStore store;
+    SortedIndexes sorted;
+    auto records = create_query_records(2000);
+    for (const auto& r : records) {
+        uint32_t slot = store.append(*r);
+        sorted.insert(store.at(slot), slot);
+    }
+    for (size_t i = 0; i < 300; ++i) sorted.remove(store[i]);
+    store.evictOldest(300);
+
+    // Indexed (sbytes, dur, dbytes, rate) and scanned (sttl) fields agree with brute force
+    std::vector<std::map<std::string, std::string>> cases = {
+        {{"sbytes>=", "50000"}, {"sbytes<", "120000"}},
+        {{"dur", "10..20"}},
+        {{"dbytes>", "1500"}},
+        {{"sttl", "64"}},
+        {{"rate<", "100"}},
+    };
+    for (const auto& params : cases) {
+        ranges.clear();
+        assert(parse_range_predicates(params, ranges, error));
+        assert(ranges.size() == 1);
+        size_t examined = 0;
+        Bitmap matches = evaluate_range(ranges[0], store, sorted, examined);
+        std::vector<uint32_t> expected;
+        for (uint32_t slot = store.firstSlot(); slot < store.endSlot(); ++slot)
+            if (range_matches(store.at(slot), ranges[0])) expected.push_back(slot);
+        assert(to_vector(matches) == expected);
+    }
+    ranges.clear();
+    assert(parse_range_predicates({{"sttl", "64"}, {"sbytes>", "1"}}, ranges, error));
+    assert(ranges.size() == 2);
+    for (const RangePredicate& r : ranges) assert(range_has_index(r) == (std::string(r.field->name) == "sbytes"));
+    std::cout << "--- Test: RangePredicate PASSED ---\n\n";
+}
+
+void testCompiledFilter() {
+    std::cout << "--- Test: CompiledFilter ---\n";
+    RecordStore store;
+    auto records = create_query_records(5000);
+    for (const auto& r : records) store.append(*r);
+    store.evictOldest(700); // Slots no longer start at 0
+
+    // Exclusive float bounds, fractional integer bounds, uint8 fields and negated sets
+    std::vector<std::map<std::string, std::string>> cases = {
+        {{"dur>", "12.3"}, {"dur<=", "250"}},
+        {{"sbytes>", "1000.5"}, {"dbytes<", "4000"}, {"label", "true"}},
+        {{"proto!", "0"}, {"sttl", "64"}, {"rate>=", "100"}},
+        {{"sbytes<", "-3"}},
+        {{"dur", "0..1e30"}, {"proto", "0,1"}},
+    };
+    for (const auto& params : cases) {
+        std::vector<CategoricalPredicate> predicates;
+        std::vector<RangePredicate> ranges;
+        std::string error;
+        assert(parse_categorical_predicates(params, predicates, error));
+        assert(parse_range_predicates(params, ranges, error));
+        CompiledFilter filter(predicates, ranges);
+        assert(filter.size() == predicates.size() + ranges.size());
+
+        std::vector<uint32_t> expected;
+        Bitmap candidates;
+        for (uint32_t slot = store.firstSlot(); slot < store.endSlot(); ++slot) {
+            const Data* d = store.at(slot);
+            bool ok = true;
+            for (const auto& p : predicates) ok = ok && predicate_matches(d, p);
+            for (const auto& r : ranges) ok = ok && range_matches(d, r);
+            assert(filter.matches(d) == ok);
+            if (ok && slot % 2 == 0) expected.push_back(slot);
+            if (slot % 2 == 0) candidates.add(slot);
+        }
+        size_t examined = 0;
+        std::vector<uint32_t> all = to_vector(filter.evaluate(store, examined));
+        assert(examined == store.size());
+        std::vector<uint32_t> even;
+        std::copy_if(all.begin(), all.end(), std::back_inserter(even), [](uint32_t s) { return s % 2 == 0; });
+        assert(even == expected);
+        assert(to_vector(filter.evaluate(store, candidates, examined)) == expected);
+    }
+    std::cout << "--- Test: CompiledFilter PASSED ---\n\n";
+}
+
+void testResultCache() {
+    std::cout << "--- Test: ResultCache ---\n";
+    using ms = std::chrono::milliseconds;
+    ResultCache cache(3, 1 << 20);
+    cache.setTolerance("PERFORM_STATS", ms(500));
+    auto t0 = ResultCache::Clock::now();
+    CacheEpoch e1{1, 0}, e2{2, 0}, evicted{2, 100};
+    std::string reply;
+
+    // Parameter order does not change the key
+    assert(normalize_request("Q", {{"b", "2"}, {"a", "1"}}) == normalize_request("Q", {{"a", "1"}, {"b", "2"}}));
+
+    assert(!cache.lookup("QUERY_FILTERED_SORTED", "q1", e1, reply, t0));
+    cache.store("q1", e1, "rows", t0);
+    assert(cache.lookup("QUERY_FILTERED_SORTED", "q1", e1, reply, t0) && reply == "rows");
+    // No tolerance: a new batch invalidates the entry
+    assert(!cache.lookup("QUERY_FILTERED_SORTED", "q1", e2, reply, t0));
+    assert(cache.size() == 0);
+
+    // Within the tolerance a stale entry is served, past it the entry is dropped
+    cache.store("s1", e1, "stats", t0);
+    assert(cache.lookup("PERFORM_STATS", "s1", evicted, reply, t0 + ms(400)) && reply == "stats");
+    assert(!cache.lookup("PERFORM_STATS", "s1", evicted, reply, t0 + ms(600)));
+
+    // LRU bound: the least recently used entry goes first
+    cache.store("a", e1, "A", t0);
+    cache.store("b", e1, "B", t0);
+    cache.store("c", e1, "C", t0);
+    assert(cache.lookup("Q", "a", e1, reply, t0));
+    cache.store("d", e1, "D", t0);
+    assert(cache.size() == 3);
+    assert(!cache.lookup("Q", "b", e1, reply, t0));
+    assert(cache.lookup("Q", "a", e1, reply, t0) && reply == "A");
+
+    const CacheStats& stats = cache.stats();
+    assert(stats.hits == 3 && stats.stale_hits == 1 && stats.misses == 4 && stats.evictions == 1);
+    cache.invalidateAll();
+    assert(cache.size() == 0 && cache.bytes() == 0);
+    std::cout << "--- Test: ResultCache PASSED ---\n\n";
+}
+
+void testSubscriptions() {
+    std::cout << "--- Test: SubscriptionManager ---\n";
+    SubscriptionManager manager(2);
+    std::string error;
+    uint32_t filter_id = manager.subscribe(SubscriptionKind::FILTER, {{"label", "true"}, {"limit", "5"}}, error);
+    uint32_t stats_id = manager.subscribe(SubscriptionKind::STATS, {{"field", "sbytes"}, {"proto", "0"}}, error);
+    assert(filter_id != 0 && stats_id != 0);
+    assert(manager.subscribe(SubscriptionKind::FILTER, {}, error) == 0); // Over the limit
+    manager.unsubscribe(stats_id);
+    assert(manager.subscribe(SubscriptionKind::STATS, {{"field", "nope"}}, error) == 0);
+    stats_id = manager.subscribe(SubscriptionKind::STATS, {{"field", "sbytes"}, {"proto", "0"}}, error);
+    assert(stats_id != 0);
+
+    RecordStore store;
+    auto records = create_query_records(60);
+    RunningStats expected;
+    size_t expected_labels = 0;
+    for (size_t batch = 0; batch < 2; ++batch) {
+        uint32_t first = store.endSlot();
+        for (size_t i = batch * 30; i < (batch + 1) * 30; ++i) {
+            store.append(*records[i]);
+            if (records[i]->label) ++expected_labels;
+            if (records[i]->proto == Protocolo::TCP) expected.add(records[i]->sbytes);
+        }
+        std::vector<Publication> publications;
+        manager.onBatch(store, first, store.endSlot(), publications);
+        assert(publications.size() == 2);
+        for (const Publication& p : publications) {
+            if (p.topic == manager.find(filter_id)->topic) {
+                assert(p.rows.size() == 5); // 10 matches per batch, truncated by limit=5
+                for (const Data* d : p.rows) assert(d->label);
+            } else {
+                assert(p.topic == manager.find(stats_id)->topic && p.rows.empty());
+            }
+        }
+    }
+    const RunningStats& stats = manager.find(stats_id)->stats;
+    assert(stats.count == expected.count && std::abs(stats.mean - expected.mean) < 1e-6);
+    assert(stats.min == expected.min && stats.max == expected.max);
+    assert(expected_labels == 20);
+    assert(manager.find(filter_id)->published == 2);
+
+    // A SUB socket subscribed to one topic receives every topic it prefixes: sub.1 must not see sub.10
+    SubscriptionManager many(16);
+    std::vector<std::string> topics;
+    for (size_t i = 0; i < 12; ++i) {
+        uint32_t id = many.subscribe(SubscriptionKind::FILTER, {{"label", "true"}}, error);
+        assert(id != 0);
+        topics.push_back(many.find(id)->topic);
+    }
+    assert(topics[0] == "sub.1." && topics[9] == "sub.10.");
+    for (const std::string& a : topics)
+        for (const std::string& b : topics)
+            assert(a == b || b.compare(0, a.size(), a) != 0);
+    std::cout << "--- Test: SubscriptionManager PASSED ---\n\n";
+}
+
+void testAnomalyScorer() {
+    std::cout << "--- Test: AnomalyScorer ---\n";
+    std::mt19937 rng(8);
+    std::normal_distribution<float> http_bytes(2000.0f, 200.0f);
+    std::normal_distribution<float> dns_bytes(80.0f, 5.0f);
+    AnomalyScorer scorer(0.01, 6.0);
+    scorer.groupBy(CategoricalField::SERVICE);
+
+    std::vector<Data> batch(5000);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        Data& d = batch[i];
+        std::memset(static_cast<void*>(&d), 0, sizeof(d)); // Data() leaves the fields uninitialized
+        d.id = static_cast<uint32_t>(i + 1);
+        bool dns = i % 2;
+        d.service = dns ? Servico::DNS : Servico::HTTP;
+        d.sbytes = static_cast<uint32_t>(dns ? dns_bytes(rng) : http_bytes(rng));
+        d.dur = 1.0f;
+        d.spkts = 10;
+    }
+    std::vector<AnomalyAlert> alerts;
+    scorer.onBatch(batch.data(), batch.size(), alerts);
+    assert(scorer.scoredCount() == batch.size());
+    assert(alerts.size() <= 5); // Ordinary traffic, once warm, stays below the threshold
+
+    // Each service learnt its own level
+    const FeatureBaselines& http = scorer.groupBaselines(static_cast<uint8_t>(Servico::HTTP));
+    const FeatureBaselines& dns = scorer.groupBaselines(static_cast<uint8_t>(Servico::DNS));
+    size_t sbytes = static_cast<size_t>(StatisticFeature::SBYTES);
+    assert(http[sbytes].count == 2500 && dns[sbytes].count == 2500);
+    assert(std::abs(http[sbytes].mean - std::log1p(2000.0)) < 0.05 && std::abs(dns[sbytes].mean - std::log1p(80.0)) < 0.05);
+
+    // HTTP-sized transfer on DNS: ordinary globally, far off for its service
+    Data odd = batch[1];
+    odd.id = 99999;
+    odd.sbytes = 2000;
+    AnomalyAlert alert;
+    EwmaBaseline scored_against = dns[sbytes]; // Before the outlier is folded in
+    assert(scorer.score(odd, alert));
+    assert(alert.id == 99999 && alert.feature == StatisticFeature::SBYTES && alert.group == static_cast<uint8_t>(Servico::DNS));
+    assert(alert.score >= 6.0 && alert.value == 2000.0f);
+    assert(alert.expected == scored_against.mean && alert.stddev == scored_against.stdDev());
+    assert(dns[sbytes].mean != scored_against.mean); // The baseline learnt the record afterwards
+    assert(format_alert(alert).find("feature=sbytes") != std::string::npos);
+
+    // Non-finite values are left out of the score and the baselines instead of poisoning them
+    Data broken = batch[0];
+    broken.id = 99998;
+    broken.dur = std::numeric_limits<float>::quiet_NaN();
+    broken.rate = std::numeric_limits<float>::infinity();
+    size_t dur = static_cast<size_t>(StatisticFeature::DUR), rate = static_cast<size_t>(StatisticFeature::RATE);
+    uint64_t dur_count = scorer.baselines()[dur].count, sbytes_count = scorer.baselines()[sbytes].count;
+    assert(!scorer.score(broken, alert));
+    assert(scorer.baselines()[dur].count == dur_count && scorer.baselines()[sbytes].count == sbytes_count + 1);
+    for (const EwmaBaseline& baseline : scorer.baselines()) assert(std::isfinite(baseline.mean) && std::isfinite(baseline.variance));
+    assert(std::isfinite(scorer.groupBaselines(static_cast<uint8_t>(Servico::HTTP))[rate].mean));
+    assert(!scorer.score(batch[2], alert)); // Ordinary traffic still scores normally
+
+    // Nothing is raised while the baselines are cold
+    AnomalyScorer cold;
+    odd.sbytes = 4000000000u;
+    assert(!cold.score(batch[0], alert) && !cold.score(odd, alert));
+    std::cout << "--- Test: AnomalyScorer PASSED ---\n\n";
+}
+
+void testColumnStore() {
+    std::cout << "--- Test: ColumnStore ---\n";
+    RecordStore store;
+    ColumnStore columns;
+    CategoricalIndexes categorical;
+    SortedIndexes sorted;
+    auto records = create_query_records(10000);
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto& r = records[i];
+        r->sttl = static_cast<uint8_t>((i * 13) % 200); // Unindexed fields that vary
+        r->smean = static_cast<uint16_t>(i % 1000);
+        uint32_t slot = store.append(*r);
+        assert(columns.append(*r) == slot);
+        categorical.insert(store.at(slot), slot);
+        sorted.insert(store.at(slot), slot);
+    }
+    // Crosses a block boundary: the first block is freed, the second one is partly evicted
+    size_t before = columns.getMemoryUsage();
+    for (size_t i = 0; i < 4500; ++i) sorted.remove(store[i]);
+    store.evictOldest(4500);
+    assert(columns.evictOldest(4500) == 4500);
+    categorical.evictBelow(store.firstSlot());
+    assert(columns.firstSlot() == store.firstSlot() && columns.endSlot() == store.endSlot());
+    assert(columns.getMemoryUsage() < before);
+
+    // Every byte of a record comes back from the columns
+    Data rebuilt;
+    for (uint32_t slot = store.firstSlot(); slot < store.endSlot(); slot += 7) {
+        assert(columns.read(slot, rebuilt));
+        assert(std::memcmp(&rebuilt, store.at(slot), sizeof(Data)) == 0);
+    }
+    assert(!columns.read(store.firstSlot() - 1, rebuilt));
+    assert(!columns.read(store.endSlot(), rebuilt));
+
+    // Statistics over the newest records match the same statistics over the packed records
+    for (const char* name : {"dur", "sbytes", "spkts", "sttl"}) {
+        const NumericField& field = *find_numeric_field(name);
+        for (int interval : {100, 5000, 1000000}) {
+            size_t n = std::min(static_cast<size_t>(interval), store.size());
+            std::vector<const Data*> rows;
+            for (size_t i = store.size() - n; i < store.size(); ++i) rows.push_back(store[i]);
+            SummaryBuilder builder;
+            builder.addField(rows.data(), rows.size(), field);
+            StatsSummary expected = builder.finish();
+            StatsSummary summary = columns.summarizeField(field, interval);
+            assert(summary.count == expected.count);
+            assert(std::abs(summary.mean - expected.mean) <= 1e-9 * std::max(1.0, std::abs(expected.mean)));
+            assert(summary.min == expected.min && summary.max == expected.max && summary.median == expected.median);
+            Moments moments = columns.moments(field, interval);
+            assert(moments.count == n && moments.min == expected.min && moments.max == expected.max);
+            assert(std::abs(moments.mean - expected.mean) <= 1e-6 * std::max(1.0, std::abs(expected.mean)));
+            assert(std::abs(moments.variance() - expected.variance) <= 1e-6 * std::max(1.0, expected.variance));
+        }
+        // Like the list and segment tree, a window that is not positive is empty
+        assert(columns.summarizeField(field, 0).count == 0 && columns.summarizeField(field, -1).count == 0);
+        assert(columns.moments(field, -1).count == 0);
+    }
+
+    // Range filters agree with range_matches
+    std::vector<std::map<std::string, std::string>> cases = {
+        {{"dur>", "12.3"}, {"sbytes<", "300000"}},
+        {{"sttl", "64"}, {"dbytes>=", "6000"}},
+        {{"sttl", "250"}},
+    };
+    for (const auto& params : cases) {
+        std::vector<RangePredicate> ranges;
+        std::string error;
+        assert(parse_range_predicates(params, ranges, error));
+        std::vector<uint32_t> expected;
+        for (uint32_t slot = store.firstSlot(); slot < store.endSlot(); ++slot) {
+            bool ok = true;
+            for (const auto& r : ranges) ok = ok && range_matches(store.at(slot), r);
+            if (ok) expected.push_back(slot);
+        }
+        size_t examined = 0;
+        assert(to_vector(columns.select(ranges, examined)) == expected);
+        assert(examined == store.size());
+    }
+
+    // The planner scans unindexed ranges over the columns and returns the same page
+    QueryPlanner planner(store, categorical, sorted);
+    QueryPlanner columnar(store, categorical, sorted);
+    columnar.setColumnStore(&columns);
+    QueryRequest request;
+    std::string error;
+    assert(parse_query_request({{"sttl", "5..6"}, {"smean<", "500"}, {"sort_by", "dur"}}, request, error));
+    QueryPlan plan = columnar.plan(request);
+    assert(plan.path == AccessPath::INDEX_INTERSECT);
+    QueryExecution row_execution, column_execution;
+    PartialOrder row_order = planner.execute(planner.plan(request), row_execution);
+    PartialOrder column_order = columnar.execute(plan, column_execution);
+    assert(column_execution.total_matches == row_execution.total_matches);
+    assert(column_execution.total_matches > 0);
+    std::vector<const Data*> row_page, column_page;
+    row_order.next(request.page_size, row_page);
+    column_order.next(request.page_size, column_page);
+    assert(row_page == column_page);
+    std::cout << "--- Test: ColumnStore PASSED ---\n\n";
+}
+
+int main() {
+    std::cout << "Running query tests...\n\n";
+    testPartialOrderAndCursors();
+    testSortedIndexes();
+    testBitmap();
+    testCategoricalIndexes();
+    testRangePredicates();
+    testQueryPlanner();
+    testCompiledFilter();
+    testResultCache();
+    testSubscriptions();
+    testAnomalyScorer();
+    testColumnStore();
+    std::cout << "All query tests passed!\n";
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <string>
 #include <numeric> // For std::accumulate (if not used directly in test)
 #include <cmath>   // For std::sqrt
+#include <random>
 
 // Helper function to create sample Data objects (similar to avl.cpp test)
 std::vector<Data> create_sample_data_for_testing_segment_tree() {
@@ -69,6 +70,16 @@ void testSegmentTreeBasicOperations() {
     assert(found_data == nullptr);
     std::cout << "Confirmed ID 9999 not found.\n";
 
+    // Batched lookup
+    std::vector<uint32_t> ids = {1003, 9999, 1001, 1002, 1001};
+    std::vector<const Data*> found_many(ids.size());
+    tree.findMany(ids.data(), ids.size(), found_many.data());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        assert(found_many[i] == tree.find(ids[i]));
+    }
+    assert(found_many[1] == nullptr && found_many[3] != nullptr && found_many[3]->id == 1002);
+    std::cout << "findMany agrees with find.\n";
+
     // Test getTotalRate (sum of rates from all inserted data)
     // Manually calculate expected sumRate
     float expected_total_rate = 0.0f;
@@ -214,11 +225,173 @@ void testSegmentTreeStatisticalOperations() {
     std::cout << "--- Test: SegmentTree Statistical Operations PASSED ---\n\n";
 }
 
+void testSegmentTreeSummarize() {
+    std::cout << "--- Test: SegmentTree single-pass summary ---\n";
+    SegmentTree tree;
+    std::mt19937 rng(3);
+    std::vector<std::unique_ptr<Data>> owned_data;
+    for (uint32_t i = 0; i < 1500; ++i) {
+        auto d = std::make_unique<Data>();
+        d->id = i + 1;
+        d->rate = std::uniform_real_distribution<float>(0.0f, 1000.0f)(rng);
+        d->dur = std::uniform_real_distribution<float>(0.0f, 10.0f)(rng);
+        d->sbytes = rng() % 100000;
+        d->spkts = static_cast<uint16_t>(rng() % 100);
+        d->sttl = static_cast<uint8_t>(rng());
+        tree.insert(d.get());
+        owned_data.push_back(std::move(d));
+    }
+
+    auto check = [&]() {
+        for (int interval : {1, 2, 7, 100, 1000, 1500, 5000}) {
+            StatsSummaryRow row = tree.summarizeAll(interval);
+            for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+                StatisticFeature feature = static_cast<StatisticFeature>(f);
+                StatsSummary summary = tree.summarize(feature, interval);
+                float average = tree.getAverage(feature, interval);
+                assert(summary.count == std::min<size_t>(interval, owned_data.size()));
+                assert(std::abs(summary.mean - average) <= 1e-4 * std::max(1.0f, std::abs(average)));
+                float stddev = tree.getStdDev(feature, interval);
+                assert(std::abs(summary.stddev() - stddev) <= 1e-3 * std::max(1.0f, stddev));
+                assert(summary.median == tree.getMedian(feature, interval));
+                assert(summary.min == tree.getMin(feature, interval));
+                assert(summary.max == tree.getMax(feature, interval));
+                assert(row[f].count == summary.count && row[f].median == summary.median && row[f].mean == summary.mean);
+                assert(tree.summarizeField(statistic_feature_field(feature), interval).median == summary.median);
+            }
+        }
+    };
+    check();
+    // Medians over the whole tree then come from the order statistics
+    tree.trackQuantiles(0.01);
+    tree.trackOrderStatistics();
+    check();
+    assert(tree.summarize(StatisticFeature::RATE, 0).count == 0);
+
+    // Any numeric field can be summarized by name, not only the StatisticFeatures
+    const StatisticFeatureValues values = statistic_feature_values(owned_data[7].get());
+    for (size_t f = 0; f < STATISTIC_FEATURE_COUNT; ++f) {
+        StatisticFeature feature = static_cast<StatisticFeature>(f);
+        assert(find_numeric_field(statistic_feature_name(feature)) == &statistic_feature_field(feature));
+        // The compile-time reader agrees with the field table
+        assert(values[f] == static_cast<float>(read_numeric_field(owned_data[7].get(), statistic_feature_field(feature))));
+        StatisticFeature named;
+        assert(statistic_feature_of(statistic_feature_field(feature), named) && named == feature);
+    }
+    StatisticFeature none;
+    assert(!statistic_feature_of(*find_numeric_field("sttl"), none));
+    assert(statistic_feature_values(nullptr)[0] == 0.0f);
+    StatsSummary ttl = tree.summarizeField(*find_numeric_field("sttl"), 100);
+    float ttl_min = 255.0f, ttl_max = 0.0f;
+    for (size_t i = owned_data.size() - 100; i < owned_data.size(); ++i) {
+        ttl_min = std::min<float>(ttl_min, owned_data[i]->sttl);
+        ttl_max = std::max<float>(ttl_max, owned_data[i]->sttl);
+    }
+    assert(ttl.count == 100 && ttl.min == ttl_min && ttl.max == ttl_max);
+    std::cout << "--- Test: SegmentTree single-pass summary PASSED ---\n\n";
+}
+
+void testSegmentTreeRangeAggregates() {
+    std::cout << "--- Test: SegmentTree node aggregates ---\n";
+    SegmentTree tree;
+    std::mt19937 rng(11);
+    std::vector<std::unique_ptr<Data>> owned_data;
+    std::vector<const Data*> live; // In insertion order, like the tree's indices
+    for (uint32_t i = 0; i < 2000; ++i) {
+        auto d = std::make_unique<Data>();
+        d->id = i + 1;
+        d->rate = std::uniform_real_distribution<float>(0.0f, 1000.0f)(rng);
+        d->dload = std::uniform_real_distribution<float>(-5.0f, 5.0f)(rng);
+        d->dbytes = rng() % 1000000;
+        tree.insert(d.get());
+        live.push_back(d.get());
+        owned_data.push_back(std::move(d));
+    }
+    // Removals leave holes in the index range, and take away some of the extremes
+    for (int i = 0; i < 300; ++i) {
+        size_t victim = rng() % live.size();
+        assert(tree.remove(live[victim]->id));
+        live.erase(live.begin() + victim);
+    }
+
+    auto check = [](const SegmentTree::Aggregate& aggregate, const std::vector<const Data*>& expected) {
+        assert(aggregate.count == expected.size());
+        for (StatisticFeature feature : {StatisticFeature::RATE, StatisticFeature::DLOAD, StatisticFeature::DBYTES}) {
+            SummaryBuilder builder(expected.size());
+            for (const Data* d : expected) {
+                float value = feature == StatisticFeature::RATE ? d->rate
+                            : feature == StatisticFeature::DLOAD ? d->dload : static_cast<float>(d->dbytes);
+                builder.add(value);
+            }
+            StatsSummary summary = builder.finish();
+            assert(aggregate.min(feature) == summary.min && aggregate.max(feature) == summary.max);
+            assert(std::abs(aggregate.mean(feature) - summary.mean) <= 1e-9 * std::max(1.0, std::abs(summary.mean)));
+            assert(std::abs(aggregate.variance(feature) - summary.variance) <= 1e-6 * std::max(1.0, summary.variance));
+        }
+    };
+
+    for (int interval : {1, 3, 64, 1000, 1700, 5000}) {
+        size_t n = std::min<size_t>(interval, live.size());
+        check(tree.aggregateRecent(interval), std::vector<const Data*>(live.end() - n, live.end()));
+    }
+    assert(tree.aggregateRecent(0).count == 0);
+
+    for (int trial = 0; trial < 50; ++trial) {
+        size_t a = rng() % live.size(), b = rng() % live.size();
+        if (a > b) std::swap(a, b);
+        SegmentTree::Aggregate aggregate = tree.aggregateRange(tree.indexOf(live[a]->id), tree.indexOf(live[b]->id));
+        check(aggregate, std::vector<const Data*>(live.begin() + a, live.begin() + b + 1));
+    }
+    assert(tree.indexOf(999999) == -1);
+    assert(tree.aggregateRange(10, 5).count == 0);
+    std::cout << "--- Test: SegmentTree node aggregates PASSED ---\n\n";
+}
+
+void testSegmentTreeGroupedSummaries() {
+    std::cout << "--- Test: SegmentTree grouped statistics ---\n";
+    SegmentTree tree;
+    std::mt19937 rng(11);
+    std::vector<std::unique_ptr<Data>> owned_data;
+    for (uint32_t i = 0; i < 3000; ++i) {
+        auto d = std::make_unique<Data>();
+        d->id = i + 1;
+        d->attack_category = static_cast<Attack_cat>(rng() % 10);
+        d->sbytes = rng() % 1000000;
+        tree.insert(d.get());
+        owned_data.push_back(std::move(d));
+    }
+
+    const int interval = 1000;
+    GroupSummaries groups = tree.summarizeByGroup(statistic_feature_field(StatisticFeature::SBYTES),
+                                                  offsetof(Data, attack_category), interval);
+    size_t total = 0;
+    for (size_t value = 0; value < 10; ++value) {
+        GroupSummary expected;
+        for (size_t i = owned_data.size() - interval; i < owned_data.size(); ++i) {
+            if (static_cast<size_t>(owned_data[i]->attack_category) == value) expected.add(static_cast<float>(owned_data[i]->sbytes));
+        }
+        const GroupSummary& group = groups[value];
+        assert(group.count == expected.count && group.min == expected.min && group.max == expected.max);
+        assert(std::abs(group.mean() - expected.mean()) <= 1e-6 * expected.mean());
+        assert(std::abs(group.stddev() - expected.stddev()) <= 1e-3 * std::max(1.0, expected.stddev()));
+        total += group.count;
+    }
+    assert(total == static_cast<size_t>(interval) && groups[10].count == 0);
+
+    // Values near 1e9 keep their spread: the sums are shifted by the first value of each group
+    GroupSummary large;
+    for (float v : {1e9f, 1e9f + 64.0f, 1e9f + 128.0f}) large.add(v);
+    assert(std::abs(large.stddev() - std::sqrt(2.0 * 64.0 * 64.0 / 3.0)) < 1e-6);
+    std::cout << "--- Test: SegmentTree grouped statistics PASSED ---\n\n";
+}
 
 int main() {
     std::cout << "Running SegmentTree tests...\n\n";
     testSegmentTreeBasicOperations();
     testSegmentTreeStatisticalOperations();
+    testSegmentTreeSummarize();
+    testSegmentTreeRangeAggregates();
+    testSegmentTreeGroupedSummaries();
     std::cout << "All SegmentTree tests passed!\n";
     return 0;
 }
@@ -0,0 +1,259 @@
+#include "server/LatencyStats.h"
+#include "server/ResponseFormatter.h"
+#include "server/TimeRollup.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+void testLatencyHistogramBuckets() {
+    std::cout << "--- Test: LatencyHistogram buckets ---\n";
+    // Buckets are contiguous, cover every value and each value falls inside its bucket
+    for (size_t b = 0; b + 1 < LatencyHistogram::BUCKET_COUNT; ++b) {
+        assert(LatencyHistogram::bucketHigh(b) + 1 == LatencyHistogram::bucketLow(b + 1));
+    }
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t v = rng() >> (24 + rng() % 40);
+        size_t b = LatencyHistogram::bucketOf(v);
+        assert(LatencyHistogram::bucketLow(b) <= v && v <= LatencyHistogram::bucketHigh(b));
+        // Relative width stays within 1/16 of the value
+        assert(LatencyHistogram::bucketHigh(b) - LatencyHistogram::bucketLow(b) <= std::max<uint64_t>(v / 16, 1));
+    }
+    assert(LatencyHistogram::bucketOf(~uint64_t(0)) == LatencyHistogram::BUCKET_COUNT - 1);
+    std::cout << "--- Test: LatencyHistogram buckets PASSED ---\n\n";
+}
+
+void testLatencyHistogramPercentiles() {
+    std::cout << "--- Test: LatencyHistogram percentiles ---\n";
+    LatencyHistogram h;
+    assert(h.count() == 0 && h.percentile(0.5) == 0);
+    std::vector<uint64_t> values;
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 50000; ++i) values.push_back(1000 + rng() % 1000000);
+    for (uint64_t v : values) h.record(v);
+    std::sort(values.begin(), values.end());
+    assert(h.count() == values.size());
+    assert(h.max() == values.back());
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double exact = static_cast<double>(values[static_cast<size_t>(q * values.size()) - 1]);
+        double estimate = static_cast<double>(h.percentile(q));
+        assert(std::abs(estimate - exact) <= exact * 0.07);
+    }
+    h.reset();
+    assert(h.count() == 0 && h.max() == 0);
+    std::cout << "--- Test: LatencyHistogram percentiles PASSED ---\n\n";
+}
+
+void testServerStats() {
+    std::cout << "--- Test: ServerStats ---\n";
+    ServerStats stats({"QUERY_DATA_BY_ID", "PERFORM_STATS"});
+
+    // Concurrent recording from several threads loses no samples
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&stats, t]() {
+            for (int i = 0; i < 10000; ++i) stats.record("QUERY_DATA_BY_ID", 1 + t % 2, RequestPhase::TOTAL, 1000 + i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    assert(stats.find("QUERY_DATA_BY_ID", 1, RequestPhase::TOTAL)->count() == 20000);
+    assert(stats.find("QUERY_DATA_BY_ID", 2, RequestPhase::TOTAL)->count() == 20000);
+    assert(stats.find("QUERY_DATA_BY_ID", 3, RequestPhase::TOTAL)->count() == 0);
+
+    // Unknown commands and ds_ids are folded, not dropped
+    stats.record("NOPE", 42, RequestPhase::TOTAL, 5);
+    assert(stats.find("SOMETHING_ELSE", 0, RequestPhase::TOTAL)->count() == 1);
+
+    {
+        RequestTimer timer(stats, RequestTimer::Clock::now(), std::chrono::microseconds(250));
+        timer.setCommand("PERFORM_STATS");
+        timer.setDsId(5);
+        timer.enter(RequestPhase::EXECUTE);
+        timer.enter(RequestPhase::FORMAT);
+        timer.finish();
+        timer.finish(); // Only recorded once
+    }
+    for (size_t p = 0; p < REQUEST_PHASE_COUNT; ++p)
+        assert(stats.find("PERFORM_STATS", 5, static_cast<RequestPhase>(p))->count() == 1);
+    assert(stats.find("PERFORM_STATS", 5, RequestPhase::QUEUE_WAIT)->max() == 250000);
+
+    std::string report = stats.describe();
+    assert(report.find("QUERY_DATA_BY_ID [1]") != std::string::npos);
+    assert(report.find("PERFORM_STATS [5]") != std::string::npos);
+    stats.reset();
+    assert(stats.describe().find("No requests recorded yet.") != std::string::npos);
+    std::cout << "--- Test: ServerStats PASSED ---\n\n";
+}
+
+// The text rows must read exactly as the former ostringstream output
+std::string reference_summary(const Data& d) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    oss << "ID: " << d.id << ", Dur: " << d.dur << "s, SBytes: " << d.sbytes << ", DBytes: " << d.dbytes
+        << ", Rate: " << d.rate << ", Proto: " << static_cast<int>(d.proto) << ", Label: " << (d.label ? "Attack" : "Normal");
+    return oss.str();
+}
+
+void testResponseFormatter() {
+    std::cout << "--- Test: ResponseFormatter ---\n";
+    std::mt19937 rng(11);
+    std::vector<Data> records(300);
+    std::vector<const Data*> rows;
+    for (size_t i = 0; i < records.size(); ++i) {
+        Data& d = records[i];
+        d.id = static_cast<uint32_t>(rng());
+        d.dur = std::uniform_real_distribution<float>(0.0f, 60.0f)(rng);
+        d.rate = std::uniform_real_distribution<float>(0.0f, 1e6f)(rng);
+        d.sload = std::uniform_real_distribution<float>(0.0f, 1e7f)(rng);
+        d.dload = 0.125f;
+        d.sbytes = rng();
+        d.dbytes = rng() % 1000;
+        d.spkts = static_cast<uint16_t>(rng());
+        d.dpkts = 0;
+        d.proto = static_cast<decltype(d.proto)>(rng() % 3);
+        d.label = (i % 3 == 0);
+        rows.push_back(&d);
+    }
+    records[0].dur = 0.005f;  // Rounding edge: the float is just above or below the half
+    records[1].rate = 2.675f;
+
+    PooledBuffer buffer = BufferPool::instance().acquire();
+    for (const Data& d : records) {
+        buffer->clear();
+        append_record_summary(*buffer, d);
+        assert(buffer->str() == reference_summary(d));
+    }
+
+    // Text page: header as given, then "n. <summary>" lines
+    PageInfo page{1234, 1, 0, 0};
+    buffer->clear();
+    append_page_header(*buffer, OutputFormat::TEXT, page, "HEADER\n", false);
+    append_rows(*buffer, OutputFormat::TEXT, rows.data(), rows.size(), 1, false);
+    append_page_footer(*buffer, OutputFormat::TEXT, false);
+    std::string text = buffer->str();
+    assert(text.compare(0, 7, "HEADER\n") == 0);
+    assert(text.find("300. " + reference_summary(records[299]) + "\n") != std::string::npos);
+    assert(std::count(text.begin(), text.end(), '\n') == 301);
+
+    // JSON page: balanced, one object per row, cursor only when open
+    page.cursor_id = 9;
+    page.remaining = 50;
+    buffer->clear();
+    append_page_header(*buffer, OutputFormat::JSON, page, "", false);
+    append_rows(*buffer, OutputFormat::JSON, rows.data(), rows.size(), 1, false);
+    append_page_footer(*buffer, OutputFormat::JSON, false);
+    std::string json = buffer->str();
+    const std::string json_head = "{\"matches\":1234,\"first_row\":1,\"remaining\":50,";
+    assert(json.compare(0, json_head.size(), json_head) == 0);
+    assert(json.find("\"cursor\":9") != std::string::npos);
+    assert(json.back() == '}');
+    assert(std::count(json.begin(), json.end(), '{') == 301 && std::count(json.begin(), json.end(), '}') == 301);
+    assert(std::count(json.begin(), json.end(), '[') == 1 && std::count(json.begin(), json.end(), ']') == 1);
+    assert(json.find(",,") == std::string::npos && json.find(",]") == std::string::npos);
+
+    // Streamed JSON frames are standalone arrays
+    buffer->clear();
+    append_rows(*buffer, OutputFormat::JSON, rows.data() + 256, 2, 257, true);
+    std::string frame = buffer->str();
+    assert(frame.front() == '[' && frame.back() == ']');
+    assert(frame.find("{\"row\":257,\"id\":" + std::to_string(records[256].id) + ",") == 1);
+
+    // Non-finite values are written as null, which JSON parsers accept
+    Data odd = records[0];
+    odd.dur = std::numeric_limits<float>::quiet_NaN();
+    odd.rate = -std::numeric_limits<float>::infinity();
+    const Data* odd_row = &odd;
+    buffer->clear();
+    append_rows(*buffer, OutputFormat::JSON, &odd_row, 1, 1, true);
+    frame = buffer->str();
+    assert(frame.find(",\"dur\":null,\"rate\":null,\"sbytes\":") != std::string::npos);
+    assert(frame.find("nan") == std::string::npos && frame.find("inf") == std::string::npos);
+
+    // CSV: summary line, column names, one line of 11 fields per row
+    buffer->clear();
+    append_page_header(*buffer, OutputFormat::CSV, page, "", false);
+    append_rows(*buffer, OutputFormat::CSV, rows.data(), rows.size(), 1, false);
+    std::istringstream csv(buffer->str());
+    std::string line;
+    std::getline(csv, line);
+    assert(line == "# matches=1234 first_row=1 remaining=50 cursor=9");
+    std::getline(csv, line);
+    assert(line == "row,id,dur,rate,sbytes,dbytes,proto,state,service,attack_cat,label");
+    size_t lines = 0;
+    while (std::getline(csv, line)) {
+        assert(std::count(line.begin(), line.end(), ',') == 10);
+        ++lines;
+    }
+    assert(lines == rows.size());
+
+    OutputFormat format;
+    assert(parse_output_format("csv", format) && format == OutputFormat::CSV);
+    assert(!parse_output_format("xml", format));
+
+    // Buffers grow past their initial size and are recycled through the pool
+    buffer->clear();
+    for (int i = 0; i < 10000; ++i) append_record_table(*buffer, records[i % records.size()]);
+    assert(buffer->size() > 16 * 1024);
+    ResponseBuffer* raw = buffer.release();
+    size_t idle = BufferPool::instance().idle();
+    BufferPool::zmqFree(raw->data(), raw); // As ZMQ does once a zero-copy frame is sent
+    assert(BufferPool::instance().idle() == idle + 1);
+    PooledBuffer reused = BufferPool::instance().acquire();
+    assert(reused.get() == raw && reused->empty());
+    std::cout << "--- Test: ResponseFormatter PASSED ---\n\n";
+}
+
+void testTimeRollup() {
+    std::cout << "--- Test: TimeRollup ---\n";
+    TimeRollup rollup(1000, 4); // Four one-second buckets
+    std::vector<Data> batch(10);
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].sbytes = 1000000000u + static_cast<uint32_t>(i) * 128; // Exact as floats, and far from 0
+        batch[i].dur = static_cast<float>(i);
+        batch[i].label = (i % 2 == 1);
+        batch[i].attack_category = i % 2 ? Attack_cat::DOS : Attack_cat::NORMAL;
+    }
+    rollup.addBatch(batch.data(), 4, 10000);
+    rollup.addBatch(batch.data() + 4, 6, 10999); // Same second: folded into the same bucket
+    rollup.addBatch(batch.data(), 2, 12500);
+
+    std::vector<const RollupBucket*> series = rollup.series(10000, 13000);
+    assert(series.size() == 2); // 11 s saw no batch
+    const RollupBucket& first = *series[0];
+    assert(first.startMs(1000) == 10000 && first.count == 10);
+    const RollupFeature& sbytes = first.features[static_cast<size_t>(StatisticFeature::SBYTES)];
+    assert(sbytes.min == 1000000000.0f && sbytes.max == 1000001152.0f);
+    assert(std::abs(sbytes.mean(first.count) - 1000000576.0) < 1e-3);
+    assert(std::abs(sbytes.variance(first.count) - 128.0 * 128.0 * 8.25) < 1e-6);
+    assert(std::abs(first.features[static_cast<size_t>(StatisticFeature::DUR)].mean(first.count) - 4.5) < 1e-9);
+    assert(first.labels[0] == 5 && first.labels[1] == 5);
+    assert(first.attack_categories[static_cast<size_t>(Attack_cat::DOS)] == 5);
+    assert(series[1]->startMs(1000) == 12000 && series[1]->count == 2);
+
+    // Wrapping around recycles the oldest buckets; batches older than the ring are dropped
+    rollup.addBatch(batch.data(), 1, 14200); // Takes the slot of 10 s
+    assert(rollup.series(0, 20000).size() == 2 && rollup.series(0, 20000)[0]->startMs(1000) == 12000);
+    rollup.addBatch(batch.data(), 1, 9000);
+    assert(rollup.series(0, 20000).size() == 2);
+    assert(rollup.series(12000, 12999).size() == 1 && rollup.series(13000, 12000).empty());
+    std::cout << "--- Test: TimeRollup PASSED ---\n\n";
+}
+
+int main() {
+    std::cout << "Running server tests...\n\n";
+    testLatencyHistogramBuckets();
+    testLatencyHistogramPercentiles();
+    testServerStats();
+    testResponseFormatter();
+    testTimeRollup();
+    std::cout << "All server tests passed!\n";
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "extra/SkipList.h"
+#include "data.h"
+#include <iostream>
+#include <vector>
+#include <cassert>
+#include <algorithm> // For std::shuffle
+#include <random>
+
+// Records with ids 1, 3, 5, ..., so that every even id is a miss between two keys
+std::vector<Data> create_sample_data_for_skiplist(size_t n) {
+    std::vector<Data> samples(n);
+    for (size_t i = 0; i < n; ++i) {
+        samples[i].id = static_cast<uint32_t>(2 * i + 1);
+        samples[i].rate = static_cast<float>(i);
+    }
+    return samples;
+}
+
+void testSkipListFind() {
+    std::cout << "--- Test: find and remove ---" << std::endl;
+    std::vector<Data> test_data = create_sample_data_for_skiplist(200);
+    std::vector<size_t> order(test_data.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+    SkipList list;
+    assert(list.empty());
+    for (size_t i : order) list.insert(&test_data[i]);
+    assert(list.size() == test_data.size());
+
+    for (const Data& data : test_data) assert(list.find(data.id) == &data);
+    assert(list.find(0) == nullptr);
+    assert(list.find(2) == nullptr);
+    assert(list.find(401) == nullptr);
+
+    assert(list.remove(201));
+    assert(!list.remove(201));
+    assert(list.find(201) == nullptr);
+    assert(list.size() == test_data.size() - 1);
+    std::cout << "--- Test: find and remove PASSED ---" << std::endl;
+}
+
+void testSkipListFindMany() {
+    std::cout << "--- Test: findMany ---" << std::endl;
+    std::vector<Data> test_data = create_sample_data_for_skiplist(300);
+    SkipList list;
+    for (const Data& data : test_data) list.insert(&data);
+    list.remove(99);
+
+    // Hits, misses between keys, below the first and past the last key, a removed key and a duplicate,
+    // over several prefetch groups
+    std::vector<uint32_t> ids;
+    for (uint32_t id = 0; id <= 602; id += 7) ids.push_back(id);
+    ids.push_back(99);
+    ids.push_back(1);
+    ids.push_back(1);
+    ids.push_back(599);
+    ids.push_back(100000);
+
+    std::vector<const Data*> found(ids.size(), &test_data[0]);
+    list.findMany(ids.data(), ids.size(), found.data());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        assert(found[i] == list.find(ids[i]));
+    }
+    assert(found[0] == nullptr);                       // id 0
+    assert(found[1] != nullptr && found[1]->id == 7);
+    assert(found[ids.size() - 5] == nullptr);          // removed
+    assert(found[ids.size() - 2] == &test_data.back()); // last key
+
+    // Nothing to find in an empty list
+    SkipList empty;
+    empty.findMany(ids.data(), ids.size(), found.data());
+    for (const Data* d : found) assert(d == nullptr);
+    std::cout << "findMany agrees with find for " << ids.size() << " ids." << std::endl;
+    std::cout << "--- Test: findMany PASSED ---" << std::endl;
+}
+
+int main() {
+    testSkipListFind();
+    testSkipListFindMany();
+    std::cout << "\nAll SkipList tests passed." << std::endl;
+    return 0;
+}
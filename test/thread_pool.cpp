@@ -0,0 +1,82 @@
+#include "thread_pool.h"
+#include "stats_summary.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+void testThreadPoolRun() {
+    std::cout << "--- Test: ThreadPool runs every task once ---\n";
+    ThreadPool pool(3);
+    assert(pool.concurrency() == 4);
+    for (size_t tasks : {0, 1, 2, 7, 100}) {
+        std::vector<std::atomic<int>> calls(tasks);
+        pool.run(tasks, [&](size_t i) { calls[i].fetch_add(1); });
+        for (const auto& c : calls) assert(c.load() == 1);
+    }
+
+    // Tasks may run() again: the caller works on its own tasks, so nothing waits forever
+    std::atomic<int> inner{0};
+    pool.run(4, [&](size_t) { pool.run(8, [&](size_t) { inner.fetch_add(1); }); });
+    assert(inner.load() == 32);
+
+    // Without workers everything runs on the caller
+    ThreadPool serial(0);
+    size_t sum = 0;
+    serial.run(10, [&](size_t i) { sum += i; });
+    assert(sum == 45);
+    std::cout << "--- Test: ThreadPool runs every task once PASSED ---\n\n";
+}
+
+void testParallelMoments() {
+    std::cout << "--- Test: chunked moments match a serial reference ---\n";
+    std::mt19937 rng(4);
+    std::lognormal_distribution<float> skewed(8.0f, 2.0f);
+    std::vector<float> values(1000000);
+    for (float& v : values) v = skewed(rng);
+
+    // Reference in long double
+    long double sum = 0;
+    for (float v : values) sum += v;
+    long double mean = sum / values.size();
+    long double m2 = 0;
+    for (float v : values) m2 += (v - mean) * (v - mean);
+
+    assert(chunk_count(values.size()) > 1 && chunk_count(PARALLEL_MIN_CHUNK) == 1);
+    Moments moments = compute_moments(values.data(), values.size());
+    assert(moments.count == values.size());
+    assert(std::abs(moments.mean - static_cast<double>(mean)) <= 1e-9 * static_cast<double>(mean));
+    assert(std::abs(moments.m2 - static_cast<double>(m2)) <= 1e-7 * static_cast<double>(m2));
+    assert(moments.min == *std::min_element(values.begin(), values.end()));
+    assert(moments.max == *std::max_element(values.begin(), values.end()));
+
+    // Merging the moments of two halves gives the moments of the whole
+    Moments left = compute_moments(values.data(), 123457);
+    Moments right = compute_moments(values.data() + 123457, values.size() - 123457);
+    left.merge(right);
+    assert(left.count == moments.count && std::abs(left.mean - moments.mean) <= 1e-9 * moments.mean);
+    assert(std::abs(left.variance() - moments.variance()) <= 1e-7 * moments.variance());
+    assert(compute_moments(values.data(), 0).count == 0);
+
+    // The chunks are contiguous and cover every item once
+    size_t n = 5 * PARALLEL_MIN_CHUNK + 3;
+    std::vector<std::atomic<int>> covered(n);
+    parallel_chunks(n, 4, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) covered[i].fetch_add(1);
+    });
+    for (const auto& c : covered) assert(c.load() == 1);
+    std::cout << "--- Test: chunked moments PASSED ---\n\n";
+}
+
+int main() {
+    std::cout << "Running thread pool tests...\n\n";
+    setenv("STATS_THREADS", "4", 0); // Split the large computations even on a single core
+    testThreadPoolRun();
+    testParallelMoments();
+    std::cout << "All thread pool tests passed!\n";
+    return 0;
+}